@@ -39,12 +39,23 @@
 #define PALLAS_BASINHOPPING_H
 
 #include <cfloat>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "pallas/history_concept.h"
+#include "pallas/history_ring.h"
+#include "pallas/history_sink.h"
+#include "pallas/iteration_callback.h"
 #include "pallas/scoped_ptr.h"
 #include "pallas/step_function.h"
+#include "pallas/gradient_problem.h"
 #include "pallas/types.h"
+#include "pallas/internal/evaluator.h"
+#include "pallas/internal/line_search_minimizer.h"
+#include "pallas/internal/local_minimization_counter.h"
 #include "pallas/internal/metropolis.h"
+#include "pallas/internal/minima_database.h"
 #include "pallas/internal/state.h"
 
 
@@ -126,6 +137,8 @@ namespace pallas {
      */
     class Basinhopping {
     public:
+        struct HistoryOutput;
+
         /**
          * Configurable options for modifying the default behaviour of the basinhopping algorithm.
          */
@@ -137,13 +150,28 @@ namespace pallas {
              */
             Options() {
                 local_minimizer_options = GradientLocalMinimizer::Options();
+                local_minimizer_type = CERES_LOCAL_MINIMIZER;
+                least_squares_minimizer_options = LeastSquaresLocalMinimizer::Options();
                 scoped_ptr<StepFunction> default_step(new DefaultStepFunction(1.0));
                 step_function.swap(default_step);
                 max_iterations = 100;
+                max_function_evaluations = INT64_MAX;
+                max_gradient_evaluations = INT64_MAX;
                 max_stagnant_iterations = 20;
                 minimum_cost = -DBL_MAX;
                 is_silent = true;
                 history_save_frequency = 0;
+                history_sink = NULL;
+                history_ring = NULL;
+                num_parallel_hops = 1;
+                use_minima_database = false;
+                minima_probe_iterations = 5;
+                minima_probe_radius = 1e-3;
+                abort_unacceptable_minimizations = false;
+                abort_margin = DBL_MAX;
+                abort_grace_iterations = 5;
+                warm_start_local_minimizer = false;
+                seed = -1;
             }
 
             /**
@@ -163,6 +191,28 @@ namespace pallas {
              */
             GradientLocalMinimizer::Options local_minimizer_options;
 
+            /**
+             * Local minimizer used for the hops. `CERES_LOCAL_MINIMIZER` (the default) runs a new
+             * `GradientLocalMinimizer` for each hop. This path is deliberately left without reuse or warm starts:
+             * ceres builds its minimizer and workspace inside every `Solve` call and takes no starting curvature, so
+             * keeping a solver across hops would save nothing. `PALLAS_LOCAL_MINIMIZER` keeps one lightweight pallas
+             * line search minimizer per concurrent hop across the whole run, so hops neither allocate nor pay the fixed
+             * per-call overhead of ceres, which dominates for cheap cost functions, and can be warm started (see
+             * `warm_start_local_minimizer`). It supports the `LBFGS`, `BFGS` and `STEEPEST_DESCENT` line search
+             * directions of `local_minimizer_options`. If the step function has bounds (e.g.
+             * pallas::BoundedStepFunction) the pallas minimizer is used either way, projected onto the bounds, since
+             * `GradientLocalMinimizer` can not keep the hops within them.
+             */
+            LocalMinimizerType local_minimizer_type;
+
+            /**
+             * Contains any changes to the default options for the least squares local minimizer, which replaces the
+             * gradient based local minimizer for the local minimization of each hop when the problem is built from a
+             * pallas::LeastSquaresCostFunction. See the documentation for ceres::Solver::Options for relevant options,
+             * such as `linear_solver_type` and `num_threads`.
+             */
+            LeastSquaresLocalMinimizer::Options least_squares_minimizer_options;
+
             /**
              * Function that produces randomized candidate solutions.
              */
@@ -173,6 +223,20 @@ namespace pallas {
              */
             unsigned int max_iterations;
 
+            /**
+             * Maximum number of evaluations of the cost function, with or without the gradient, including those made by
+             * the local minimization of each hop. The budget is checked after every iteration, and a local
+             * minimization is not interrupted once started, so the last hops may overrun it. Once spent, the run
+             * ends with the best minimum found so far. Unlimited by default.
+             */
+            int64_t max_function_evaluations;
+
+            /**
+             * Maximum number of evaluations of the cost function with its gradient, including those made by local
+             * minimizations. Checked like `max_function_evaluations`. Unlimited by default.
+             */
+            int64_t max_gradient_evaluations;
+
             /**
              * Maximum number sequential basinhopping iterations allowed without finding a new global minimum.
              */
@@ -195,6 +259,93 @@ namespace pallas {
              * large number of iterations this can lead to a lot of data being stored in memory.
              */
             unsigned int history_save_frequency;
+
+            /**
+             * Receives the history outputs selected by `history_save_frequency` as they are produced instead of
+             * `Summary::history` when not NULL (the default). See pallas::HistorySink and
+             * pallas::JsonLinesHistorySink, which streams the outputs to a file. The sink is not owned by the solver.
+             */
+            HistorySink* history_sink;
+
+            /**
+             * Keeps only the last history outputs selected by `history_save_frequency`, in preallocated slots that
+             * are reused without allocating, when not NULL (the default). The outputs are then not appended to
+             * `Summary::history`. See pallas::HistoryRing. The ring is not owned by the solver.
+             */
+            HistoryRing<HistoryOutput>* history_ring;
+
+            /**
+             * Called at the end of every iteration, see pallas::IterationCallback. The callbacks are not owned by
+             * the solver.
+             */
+            std::vector<IterationCallback*> callbacks;
+
+            /**
+             * Number of hops proposed from the current state in each round. If greater than 1 the hops are stepped
+             * on the calling thread, locally minimized concurrently on `num_parallel_hops` threads and then passed
+             * through the Metropolis test one at a time in the order they were proposed. Once a hop is accepted the
+             * remaining hops of the round are discarded, since they started from a state that is no longer current;
+             * their minima still update the global minimum. Each hop that goes through the Metropolis test counts as
+             * one iteration. The cost function must be safe to evaluate concurrently when this is greater than 1.
+             */
+            unsigned int num_parallel_hops;
+
+            /**
+             * Whether to keep a database of the local minima found so far. If `true`, each hop is first locally
+             * minimized for at most `minima_probe_iterations` iterations. If the probed point is within
+             * `minima_probe_radius` of a known minimum, the hop is assumed to fall into the basin of that minimum
+             * and the known minimum is reused instead of finishing the local minimization.
+             */
+            bool use_minima_database;
+
+            /**
+             * Number of local minimizer iterations run on a hop before probing the minima database.
+             */
+            int minima_probe_iterations;
+
+            /**
+             * Distance (in the max-norm) from a known minimum within which a probed hop is assumed to lie in
+             * the basin of that minimum. New minima within this distance of a known minimum are not stored.
+             */
+            double minima_probe_radius;
+
+            /**
+             * Whether to abort the local minimization of hops that are unlikely to be accepted. The random number of
+             * the Metropolis test is drawn before the hop is minimized, which fixes the highest cost the hop may reach
+             * and still be accepted. A local minimization whose cost is still above that cost after
+             * `abort_grace_iterations` iterations is aborted and the hop is rejected. Since the local minimizer only
+             * decreases the cost this is a heuristic: an aborted hop could have descended far enough to be accepted.
+             */
+            bool abort_unacceptable_minimizations;
+
+            /**
+             * A local minimization of a hop whose cost is more than `abort_margin` above the global minimum after
+             * `abort_grace_iterations` iterations is aborted and the hop is rejected. The default (`DBL_MAX`)
+             * never aborts.
+             */
+            double abort_margin;
+
+            /**
+             * Number of local minimizer iterations a hop is always given before it may be aborted.
+             */
+            int abort_grace_iterations;
+
+            /**
+             * Whether to start the local minimization of each hop from the curvature (L-BFGS pairs or BFGS inverse
+             * Hessian) left by the local minimization of the last accepted hop instead of from steepest descent. Hops
+             * land near the current minimum, where this curvature is often still a good approximation, which cuts the
+             * number of local minimizer iterations per hop. Only the pallas local minimizer can be warm started, so
+             * this has no effect with `CERES_LOCAL_MINIMIZER` (see `local_minimizer_type`).
+             */
+            bool warm_start_local_minimizer;
+
+            /**
+             * Seed for the random number generators. Runs with the same seed and options produce bitwise identical
+             * results. The step function and the acceptance test each draw from their own non-overlapping stream
+             * derived from the seed (see `StepFunction::Seed`). If negative (the default) a seed is drawn from
+             * `std::random_device` and reported in the summary.
+             */
+            int seed;
         };
 
         /**
@@ -225,17 +376,45 @@ namespace pallas {
 
             unsigned int num_parameters;/**<Number of parameters in the problem.*/
 
+            int seed;/**<Seed used for the random number generators. Pass it in the options to repeat the run.*/
+
             unsigned int num_iterations;/**<Number of basinhopping iterations*/
 
+            unsigned int num_local_minimizer_iterations;/**<Total number of local minimizer iterations run on the hops.*/
+
+            unsigned int num_parallel_hops;/**<Number of hops proposed and minimized concurrently in each round.*/
+
+            unsigned int num_discarded_hops;/**<Number of hops discarded because an earlier hop of the same round was accepted.*/
+
+            unsigned int num_minima_database_hits;/**<Number of hops that reused a known minimum instead of finishing the local minimization.*/
+
+            unsigned int num_minima_database_misses;/**<Number of hops that were locally minimized to completion while the minima database was used.*/
+
+            unsigned int num_known_minima;/**<Number of distinct minima stored in the minima database.*/
+
+            unsigned int num_aborted_local_minimizations;/**<Number of hop local minimizations that were aborted.*/
+
+            int64_t num_cost_evaluations;/**<Number of cost-only evaluations performed outside local minimization.*/
+
+            int64_t num_gradient_evaluations;/**<Number of cost and gradient evaluations performed outside local minimization.*/
+
+            int64_t num_local_cost_evaluations;/**<Number of cost-only evaluations performed by local minimizations.*/
+
+            int64_t num_local_gradient_evaluations;/**<Number of cost and gradient evaluations performed by local minimizations.*/
+
             double total_time_in_seconds;/**<Total time elapsed in global minimization*/
 
             double local_minimization_time_in_seconds;/**<Time elapsed in local minimization*/
 
+            double aborted_local_minimization_time_in_seconds;/**<Time spent in local minimizations that were aborted.*/
+
+            double saved_local_minimization_time_in_seconds;/**<Estimated local minimization time saved by aborting. The mean time of a completed hop minimization times the number of aborted ones, less the time spent in the aborted ones.*/
+
             double step_time_in_seconds;/**<Time spent calling the step function*/
 
             double cost_evaluation_time_in_seconds;/**<Time spent evaluating cost function (outside local minimization)*/
 
-            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option.*/
+            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option. Empty if a `history_sink` or `history_ring` was set.*/
         };
 
         /**
@@ -262,6 +441,24 @@ namespace pallas {
                       current_solution(current_solution),
                       best_cost(best_cost),
                       best_solution(best_solution) {}
+
+            /**
+             * @brief Overwrites the history output in place.
+             * @details Takes the same arguments as the constructor. No memory is allocated when the vectors have the
+             * sizes of those already stored, which lets pallas::HistoryRing reuse its slots.
+             */
+            void assign(unsigned int iteration_number,
+                        unsigned int stagnant_iterations,
+                        const Eigen::Ref<const Vector>& current_solution,
+                        double best_cost,
+                        const Eigen::Ref<const Vector>& best_solution) {
+                this->iteration_number = iteration_number;
+                this->stagnant_iterations = stagnant_iterations;
+                this->current_solution = current_solution;
+                this->best_cost = best_cost;
+                this->best_solution = best_solution;
+            }
+
             unsigned int iteration_number;/**<The number of global optimization iterations that have elapsed.*/
             unsigned int stagnant_iterations;/**<The number of iterations that have elapsed without finding a new global minimum.*/
             Vector current_solution;/**<Candidate solution for the current iteration.*/
@@ -291,6 +488,15 @@ namespace pallas {
                    Basinhopping::Summary*global_summary);
 
     private:
+        /**
+         * @brief Result of the local minimization of a hop.
+         */
+        enum HopOutcome {
+            HOP_MINIMIZED,/**<The hop was locally minimized to completion.*/
+            HOP_KNOWN_MINIMUM,/**<The hop reused a known minimum from the minima database.*/
+            HOP_ABORTED/**<The local minimization was aborted and the hop is rejected.*/
+        };
+
         /**
          * @brief Checks to see if any termination conditions were met.
          *
@@ -302,19 +508,108 @@ namespace pallas {
         bool check_for_termination_(const Basinhopping::Options &options,
                                     std::string* message,
                                     TerminationType* termination_type);
+
+        /**
+         * @brief Whether the evaluations made so far, including those of local minimizations, spend the
+         * `max_function_evaluations` or `max_gradient_evaluations` budget.
+         */
+        bool is_evaluation_budget_spent_(const Basinhopping::Options& options) const;
+
+        /**
+         * @brief Returns a view of the current iteration for the callbacks.
+         */
+        IterationSummary iteration_summary_() const;
+
+        /**
+         * @brief Draws the acceptance thresholds of the next `num_hops` hops and sets the cost above which their
+         * local minimizations are aborted.
+         */
+        void prepare_hops_(const Basinhopping::Options& options, unsigned int num_hops);
+
+        /**
+         * @brief Locally minimizes `hop`, the `i`th hop of the current round, reusing a known minimum if the hop
+         * heads into a known basin and aborting the minimization if its cost stays above its maximum cost.
+         * @details Only reads the minima database and only uses the `i`th reusable local minimizer, so it may be
+         * called concurrently for different hops.
+         *
+         * @return Returns how the hop was minimized. If a known minimum was reused the cost of `hop` is already set.
+         * `hop_counter` is set to the iterations and evaluations of the local minimizations of the hop.
+         */
+        HopOutcome minimize_hop_(const Basinhopping::Options& options,
+                                 const GradientProblem& problem,
+                                 unsigned int i,
+                                 internal::State* hop,
+                                 GradientLocalMinimizer::Summary* local_summary,
+                                 internal::LocalMinimizationCounter* hop_counter) const;
+
+        /**
+         * @brief Runs the `i`th reusable local minimizer, or a new `GradientLocalMinimizer` if they are not used.
+         * Problems built from residuals are minimized with a new `LeastSquaresLocalMinimizer` instead. Either way
+         * the minimization stays within the bounds of the step function.
+         */
+        void run_local_minimizer_(const GradientLocalMinimizer::Options& local_minimizer_options,
+                                  const LeastSquaresLocalMinimizer::Options& least_squares_options,
+                                  const GradientProblem& problem,
+                                  unsigned int i,
+                                  double* parameters,
+                                  GradientLocalMinimizer::Summary* local_summary) const;
+
+        /**
+         * @brief Updates the minima database and the hop counters with the `i`th hop of the current round.
+         */
+        void record_hop_(unsigned int i, const internal::State& hop);
+
+        /**
+         * @brief Returns whether to accept the `i`th hop of the current round.
+         */
+        bool accept_hop_(const Basinhopping::Options& options, unsigned int i, const internal::State& hop);
+
+        /**
+         * @brief Proposes `num_parallel_hops` hops from the current state and minimizes them concurrently.
+         * @details The steps are drawn in order on the calling thread so the hops do not depend on how the
+         * local minimizations are scheduled. Each thread minimizes its hops with its own shared copy of the problem.
+         *
+         * @return Returns `false` if the cost of a minimized hop could not be evaluated, `true` otherwise.
+         */
+        bool hop_in_parallel_(const Basinhopping::Options& options,
+                              Basinhopping::Summary* global_summary);
+
         /**
          * @brief Updates the global summary before exiting the basinhopping algorithm.
          */
         void prepare_final_summary_(Basinhopping::Summary* global_summary,
                                     const GradientLocalMinimizer::Summary& local_summary);
 
+        scoped_ptr<internal::Evaluator> evaluator_;/**<Evaluates the problem outside of local minimization and counts the evaluations.*/
         internal::Metropolis metropolis_;/**<Determines whether to accept a higher cost candidate solution*/
         internal::State current_state_;/**<The current state of the optimization*/
         internal::State candidate_state_;/**<A randomized candidate solution that is then minimized using a local minimization algorithm and compared to the current state.*/
         internal::State global_minimum_state_;/**The best solution found during any stage of the optimization. It is this value that is returned when minimization concludes.*/
 
+        std::vector<internal::State> hops_;/**<Locally minimized hops of the current round when hopping in parallel.*/
+        std::vector<GradientLocalMinimizer::Summary> hop_summaries_;/**<Summary of the local minimization of each hop of the current round.*/
+        std::vector<std::unique_ptr<GradientProblem> > shared_problems_;/**<Problem used by each thread for the concurrent local minimizations.*/
+        std::vector<HopOutcome> hop_outcomes_;/**<How each hop of the current round was minimized.*/
+        std::vector<double> acceptance_thresholds_;/**<Highest cost each hop of the current round may have and be accepted (if drawn in advance).*/
+        std::vector<double> hop_max_costs_;/**<Cost above which the local minimization of each hop of the current round is aborted.*/
+        std::vector<double> hop_times_;/**<Time spent in the local minimization of each hop of the current round.*/
+        std::vector<internal::LocalMinimizationCounter> hop_counters_;/**<Local minimizer iterations and evaluations of each hop of the current round.*/
+        const double* lower_bounds_;/**<Lower bounds of the step function the local minimizations stay within, `NULL` if unbounded.*/
+        const double* upper_bounds_;/**<Upper bounds of the step function the local minimizations stay within, `NULL` if unbounded.*/
+        std::vector<std::unique_ptr<internal::LineSearchMinimizer> > local_minimizers_;/**<Reusable local minimizer of each hop of a round, empty unless `PALLAS_LOCAL_MINIMIZER` is used or the hops are bounded.*/
+        internal::LineSearchMinimizer::History accepted_history_;/**<Curvature left by the local minimization of the last accepted hop.*/
+        scoped_ptr<internal::MinimaDatabase> minima_database_;/**<Local minima found so far, `NULL` unless `use_minima_database` is set.*/
+
         unsigned int num_stagnant_iterations_;/**<The number of iterations that have elapsed without finding a new global minimum.*/
         unsigned int num_iterations_;/**<The number of local optimization iterations the global optimizer has performed.*/
+        internal::LocalMinimizationCounter local_minimization_counter_;/**<Local minimizer iterations and evaluations of the run.*/
+        unsigned int num_discarded_hops_;/**<The number of hops discarded after an earlier hop of the same round was accepted.*/
+        unsigned int num_minima_database_hits_;/**<The number of hops that reused a known minimum.*/
+        unsigned int num_minima_database_misses_;/**<The number of hops minimized to completion while the minima database was used.*/
+        unsigned int num_aborted_local_minimizations_;/**<The number of aborted hop local minimizations.*/
+        unsigned int num_completed_local_minimizations_;/**<The number of hop local minimizations run to completion.*/
+        double aborted_time_in_seconds_;/**<Time spent in aborted hop local minimizations.*/
+        double completed_time_in_seconds_;/**<Time spent in hop local minimizations run to completion.*/
 
     };
 
@@ -342,6 +637,14 @@ namespace pallas {
      */
     void dump(const Basinhopping::HistoryOutput &h, HistoryWriter& writer);
 
+    /**
+     * @brief Encodes the system state contained in the history output as one record of the binary history format.
+     *
+     * @param h Basinhopping::HistoryOutput. State of the system for a specific iteration.
+     * @param writer BinaryHistoryWriter. Object responsible for encoding the history output.
+     */
+    void dump(const Basinhopping::HistoryOutput &h, BinaryHistoryWriter& writer);
+
 } // namespace pallas
 
 #endif //PALLAS_BASINHOPPING_H
@@ -0,0 +1,247 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_BINARY_HISTORY_H
+#define PALLAS_BINARY_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pallas/types.h"
+
+namespace pallas {
+
+    /**
+     * @brief Encodes history outputs in the binary history format.
+     * @details A binary history file starts with a header that holds the solver type, the number of parameters
+     * (D), the number of candidates stored per record (NP, the population size of differential evolution, the
+     * number of replicas of parallel tempering and 1 for the other solvers) and a description of the columns of a
+     * record. It is followed by one fixed-width record per saved iteration. Each column of a record is a fixed
+     * number of little-endian 8 byte values, either unsigned integers or doubles, and the candidates of a record
+     * are stored one after the other, D values each, as in the columns of a pallas::Matrix. Record `k` therefore
+     * starts at `header_size + k * record_size` and can be read without decoding the records before it, see
+     * pallas::BinaryHistoryReader.
+     *
+     * The layout:
+     * @code
+     * header:  char magic[8] = "PALLASHB", uint32 version, uint32 solver_type, uint32 num_parameters,
+     *          uint32 num_candidates, uint32 num_columns, uint32 reserved, uint64 record_size,
+     *          num_columns * {char name[32], uint32 column_type, uint32 reserved, uint64 num_values}
+     * records: num_records * {column values in header order}
+     * @endcode
+     *
+     * The columns are added with the same names as the JSON output through the `dump` overload of each solver.
+     * The first record sets the header, which is written in front of it; every later record must have the same
+     * columns.
+     */
+    class BinaryHistoryWriter {
+    public:
+        /**
+         * @brief Type of the values of a column.
+         */
+        enum ColumnType {
+            UINT64_COLUMN = 0,
+            DOUBLE_COLUMN = 1,
+        };
+
+        BinaryHistoryWriter();
+
+        /**
+         * @brief Starts a new record.
+         *
+         * @param solver_type SolverType. Solver that produced the record.
+         * @param num_parameters unsigned int. Number of parameters of the problem.
+         * @param num_candidates unsigned int. Number of candidates stored in the record.
+         */
+        void StartRecord(SolverType solver_type, unsigned int num_parameters, unsigned int num_candidates);
+
+        /**
+         * @brief Adds a column holding one unsigned integer to the current record.
+         */
+        void Uint(const char* name, uint64_t value);
+
+        /**
+         * @brief Adds a column holding one double to the current record.
+         */
+        void Double(const char* name, double value);
+
+        /**
+         * @brief Adds a column holding `num_values` doubles to the current record.
+         */
+        void Doubles(const char* name, const double* values, std::size_t num_values);
+
+        /**
+         * @brief Completes the current record.
+         * @details The first record fixes the header, which is encoded in front of it.
+         *
+         * @return Returns `false`, and drops the record, if its columns differ from those of the header.
+         */
+        bool EndRecord();
+
+        /**
+         * @brief Encoded bytes of the records completed since the last call to `Clear`.
+         */
+        const char* GetData() const { return buffer_.data(); };
+
+        /**
+         * @brief Number of encoded bytes returned by `GetData`.
+         */
+        std::size_t GetSize() const { return buffer_.size(); };
+
+        /**
+         * @brief Discards the encoded bytes. The header is kept, so it is not encoded again.
+         */
+        void Clear() { buffer_.clear(); };
+
+    private:
+        struct Column {
+            std::string name;
+            ColumnType type;
+            uint64_t num_values;
+        };
+
+        /**
+         * @brief Checks the next column of the record against the header, or adds it to the header of the first record.
+         * @details Names are cut to the 31 characters stored in the header.
+         */
+        void add_column_(const char* name, ColumnType type, uint64_t num_values);
+
+        void append_uint32_(uint32_t value, std::string* bytes);
+        void append_uint64_(uint64_t value, std::string* bytes);
+
+        std::vector<Column> columns_;/**<Columns of the header, in record order.*/
+        std::string buffer_;/**<Encoded bytes of the completed records.*/
+        std::string record_;/**<Encoded values of the current record.*/
+        SolverType solver_type_;
+        unsigned int num_parameters_;
+        unsigned int num_candidates_;
+        unsigned int num_record_columns_;/**<Number of columns added to the current record.*/
+        bool has_header_;/**<Whether the first record has fixed the header.*/
+        bool is_record_valid_;/**<Whether the columns of the current record match the header so far.*/
+    };
+
+    /**
+     * @brief Gives random access to the records of a binary history file through a read-only memory map.
+     * @details Opening the file only decodes its header; the values of a record are read straight from the
+     * mapped file when they are requested, so generation `k` of a long differential evolution run can be looked at
+     * without reading the generations before it. A trailing partial record, left by a run that is still writing
+     * or was interrupted, is ignored. The values are returned without being copied, which requires a
+     * little-endian host.
+     *
+     * <B>Example</B>
+     * @code
+     pallas::BinaryHistoryReader reader;
+     std::string message;
+     if (!reader.Open("history.bin", &message))
+         LOG(FATAL) << message;
+     const int population = reader.FindColumn("population");
+     const double* generation = reader.Doubles(reader.NumRecords() - 1, population);
+     // parameter j of candidate i is generation[i * reader.NumParameters() + j]
+     * @endcode
+     */
+    class BinaryHistoryReader {
+    public:
+        BinaryHistoryReader();
+
+        /**
+         * @brief Unmaps the file.
+         */
+        ~BinaryHistoryReader();
+
+        /**
+         * @brief Maps the file and decodes its header.
+         *
+         * @param filename std::string. Path of the binary history file.
+         * @param message std::string*. If the file cannot be opened, a message describing the failure is stored in the variable.
+         * @return Returns `true` if the file was mapped and its header is valid, `false` otherwise.
+         */
+        bool Open(const std::string& filename, std::string* message);
+
+        /**
+         * @brief Unmaps the file. Called by `Open` and the destructor.
+         */
+        void Close();
+
+        SolverType GetSolverType() const { return solver_type_; };/**<Solver that produced the history.*/
+
+        unsigned int NumParameters() const { return num_parameters_; };/**<Number of parameters (D).*/
+
+        unsigned int NumCandidates() const { return num_candidates_; };/**<Number of candidates per record (NP).*/
+
+        uint64_t NumRecords() const { return num_records_; };/**<Number of complete records in the file.*/
+
+        int NumColumns() const { return static_cast<int>(columns_.size()); };/**<Number of columns per record.*/
+
+        const std::string& ColumnName(int column) const { return columns_[column].name; };/**<Name of a column.*/
+
+        uint64_t ColumnNumValues(int column) const { return columns_[column].num_values; };/**<Number of values of a column.*/
+
+        /**
+         * @brief Index of the column called `name`, -1 if there is no such column.
+         */
+        int FindColumn(const std::string& name) const;
+
+        /**
+         * @brief The unsigned integer stored in `column` of record `record`.
+         */
+        uint64_t Uint(uint64_t record, int column) const;
+
+        /**
+         * @brief Pointer to the `ColumnNumValues(column)` doubles stored in `column` of record `record`.
+         * @details The pointer refers to the mapped file and stays valid until the reader is closed.
+         */
+        const double* Doubles(uint64_t record, int column) const;
+
+    private:
+        struct Column {
+            std::string name;
+            BinaryHistoryWriter::ColumnType type;
+            uint64_t num_values;
+            std::size_t offset;/**<Offset in bytes of the column from the start of a record.*/
+        };
+
+        /**
+         * @brief Address of the first value of `column` of record `record`.
+         */
+        const char* value_(uint64_t record, int column) const;
+
+        const char* data_;/**<Start of the mapped file, NULL if no file is open.*/
+        std::size_t size_;/**<Size in bytes of the mapped file.*/
+        void* mapping_;/**<Handle of the file mapping on Windows.*/
+        std::vector<Column> columns_;
+        SolverType solver_type_;
+        unsigned int num_parameters_;
+        unsigned int num_candidates_;
+        std::size_t header_size_;/**<Size in bytes of the header, including the column descriptions.*/
+        uint64_t record_size_;/**<Size in bytes of each record.*/
+        uint64_t num_records_;
+    };
+
+} // namespace pallas
+
+#endif // PALLAS_BINARY_HISTORY_H
@@ -38,7 +38,14 @@
 #ifndef PALLAS_BRUTE_H
 #define PALLAS_BRUTE_H
 
+#include <cstdint>
+#include <vector>
+
 #include "pallas/history_concept.h"
+#include "pallas/history_ring.h"
+#include "pallas/history_sink.h"
+#include "pallas/iteration_callback.h"
+#include "pallas/gradient_problem.h"
 #include "pallas/types.h"
 
 namespace pallas {
@@ -113,6 +120,8 @@ namespace pallas {
      */
     class Brute {
     public:
+        struct HistoryOutput;
+
         /**
          * Configurable options for modifying the default behaviour of the brute algorithm.
          */
@@ -124,21 +133,59 @@ namespace pallas {
              */
             Options() {
                 local_minimizer_options = GradientLocalMinimizer::Options();
+                local_minimizer_type = CERES_LOCAL_MINIMIZER;
+                least_squares_minimizer_options = LeastSquaresLocalMinimizer::Options();
                 polish_output = false;
+                max_function_evaluations = INT64_MAX;
+                max_gradient_evaluations = INT64_MAX;
                 is_silent = true;
                 history_save_frequency = 0;
+                history_sink = NULL;
+                history_ring = NULL;
+                batch_size = 1024;
+                num_threads = 1;
             };
 
             /**
              * Contains any changes to the default options for the local minimization algorithm. See the documentation for ceres::GradientProblemSolver::Options for relevant options.
              */
             GradientLocalMinimizer::Options local_minimizer_options;
+
+            /**
+             * Local minimizer used for the polishing step. `CERES_LOCAL_MINIMIZER` (the default) runs a
+             * `GradientLocalMinimizer`. `PALLAS_LOCAL_MINIMIZER` runs the lightweight line search minimizer of pallas,
+             * which avoids the fixed per-call overhead of ceres and is faster for cheap cost functions. It supports the
+             * `LBFGS`, `BFGS` and `STEEPEST_DESCENT` line search directions of `local_minimizer_options`.
+             */
+            LocalMinimizerType local_minimizer_type;
+
+            /**
+             * Contains any changes to the default options for the least squares local minimizer, which replaces the
+             * gradient based local minimizer for the local minimization of the best grid point when the problem is built
+             * from a pallas::LeastSquaresCostFunction. See the documentation for ceres::Solver::Options for relevant
+             * options, such as `linear_solver_type` and `num_threads`.
+             */
+            LeastSquaresLocalMinimizer::Options least_squares_minimizer_options;
             
             /**
              * Whether the global minimum found through brute force should be subjected to a local minimization "polishing" step before returning the result.
              */
             bool polish_output;
 
+            /**
+             * Maximum number of evaluations of the cost function, with or without the gradient. A budget smaller
+             * than the grid limits the search to the first `max_function_evaluations` grid points, in grid order,
+             * and the best of them is returned. The polishing step is skipped once the budget is spent, but is not
+             * interrupted once started. Unlimited by default.
+             */
+            int64_t max_function_evaluations;
+
+            /**
+             * Maximum number of evaluations of the cost function with its gradient. Only the polishing step evaluates
+             * the gradient, so the budget only skips it when set to zero. Unlimited by default.
+             */
+            int64_t max_gradient_evaluations;
+
             /**
              * Whether to log failure information relating the to global optimization algorithm using glog.
              */
@@ -151,6 +198,45 @@ namespace pallas {
              * large number of iterations this can lead to a lot of data being stored in memory.
              */
             unsigned int history_save_frequency;
+
+            /**
+             * Receives the history outputs selected by `history_save_frequency` as they are produced instead of
+             * `Summary::history` when not NULL (the default). See pallas::HistorySink and
+             * pallas::JsonLinesHistorySink, which streams the outputs to a file. The sink is not owned by the solver.
+             * With more than one thread the grid is searched in rounds of at most 1024 outputs per thread, and the
+             * outputs of each round are handed to the sink in grid index order once the round completes.
+             */
+            HistorySink* history_sink;
+
+            /**
+             * Keeps only the last history outputs selected by `history_save_frequency`, in preallocated slots that
+             * are reused without allocating, when not NULL (the default). The outputs are then not appended to
+             * `Summary::history`. See pallas::HistoryRing. The ring is not owned by the solver.
+             */
+            HistoryRing<HistoryOutput>* history_ring;
+
+            /**
+             * Called after the evaluation of every grid point, see pallas::IterationCallback. With several threads
+             * the points are not reported in grid order and the best solution covers the points evaluated so far.
+             * The callbacks are not owned by the solver.
+             */
+            std::vector<IterationCallback*> callbacks;
+
+            /**
+             * Number of grid points passed to `GradientProblem::EvaluateBatch` per call. Larger values let a
+             * pallas::BatchGradientCostFunction amortize more work per call at the cost of `num_parameters * batch_size`
+             * doubles of scratch memory per thread. Default is 1024.
+             */
+            unsigned int batch_size;
+
+            /**
+             * Number of threads used to search the grid. The grid is split into `num_threads` contiguous ranges of
+             * grid indices that are searched concurrently, each thread keeping track of its own minimum. The minima
+             * are then combined in index order, with ties resolved in favor of the lowest grid index, so the result
+             * does not depend on the number of threads. The cost function must be safe to evaluate concurrently
+             * when this is greater than 1.
+             */
+            int num_threads;
         };
 
         /**
@@ -177,19 +263,29 @@ namespace pallas {
 
             unsigned int num_parameters;/**<Number of parameters in the problem.*/
 
-            unsigned int num_iterations;/**<Number of iterations*/
+            int num_threads;/**<Number of threads used to search the grid.*/
+
+            uint64_t num_iterations;/**<Number of grid points evaluated*/
+
+            int64_t num_cost_evaluations;/**<Number of cost-only evaluations performed outside local minimization.*/
+
+            int64_t num_gradient_evaluations;/**<Number of cost and gradient evaluations performed outside local minimization.*/
+
+            int64_t num_local_cost_evaluations;/**<Number of cost-only evaluations performed by local minimizations.*/
+
+            int64_t num_local_gradient_evaluations;/**<Number of cost and gradient evaluations performed by local minimizations.*/
 
             double total_time_in_seconds;/**<total time elapsed in global minimizer*/
 
             double local_minimization_time_in_seconds;/**<time spent in local minimizer*/
 
-            double permutation_build_time_in_seconds;/**<time spent calculating the possible permutations of the input parameter ranges*/
+            double permutation_build_time_in_seconds;/**<time spent setting up the grid of the input parameter ranges*/
 
             double cost_evaluation_time_in_seconds;/**<time spent evaluating cost function (outside local minimization)*/
 
             bool was_polished;/**<specifies whether the output was polished*/
 
-            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option.*/
+            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option. Empty if a `history_sink` or `history_ring` was set.*/
         };
 
         /**
@@ -200,12 +296,12 @@ namespace pallas {
             /**
              * @brief Constructor
              *
-             * @param iteration_number unsigned int. The number of global optimization iterations that have elapsed.
+             * @param iteration_number uint64_t. Linear index of the grid point evaluated at this iteration.
              * @param current_solution Vector. Candidate solution vector for the current iteration.
              * @param best_cost double. Cost associated with the best solution found at any iteration thus far during optimization.
              * @param best_solution Vector. Best solution found at any iteration thus far during optimization.
              */
-            HistoryOutput(unsigned int iteration_number,
+            HistoryOutput(uint64_t iteration_number,
                           const Vector &current_solution,
                           double best_cost,
                           const Vector &best_solution)
@@ -213,7 +309,23 @@ namespace pallas {
                       current_solution(current_solution),
                       best_cost(best_cost),
                       best_solution(best_solution) {}
-            unsigned int iteration_number;/**<The number of global optimization iterations that have elapsed.*/
+
+            /**
+             * @brief Overwrites the history output in place.
+             * @details Takes the same arguments as the constructor. No memory is allocated when the vectors have the
+             * sizes of those already stored, which lets pallas::HistoryRing reuse its slots.
+             */
+            void assign(uint64_t iteration_number,
+                        const Eigen::Ref<const Vector>& current_solution,
+                        double best_cost,
+                        const Eigen::Ref<const Vector>& best_solution) {
+                this->iteration_number = iteration_number;
+                this->current_solution = current_solution;
+                this->best_cost = best_cost;
+                this->best_solution = best_solution;
+            }
+
+            uint64_t iteration_number;/**<Linear index of the grid point evaluated at this iteration.*/
             Vector current_solution;/**<Candidate solution for the current iteration.*/
             double best_cost;/**<Cost associated with the best solution found at any iteration thus far during optimization.*/
             Vector best_solution;/**<Best solution found at any iteration thus far during optimization.*/
@@ -283,14 +395,6 @@ namespace pallas {
          * @return An std::vector<Vector> containing the linearly spaced vectors bewteen the start and end points.
          */
         std::vector<Vector> expand_parameter_ranges_(const std::vector<Brute::ParameterRange> &parameter_ranges);
-
-        /**
-         * @brief Constructs all possible permutations of the input parameter ranges.
-         * 
-         * @param expanded_ranges std::vector<Vector>. Contains linearly spaced vectors of all sample points for the input parameter ranges. Used internally on the result of Brute::expand_parameter_ranges_.
-         * @return All possible permutations of the input parameter ranges. Because all permutations are precalculated this could be memory intensive if a large number of parameters and sample points are provided.
-         */
-        std::vector<Vector> build_permutations_(const std::vector<Vector> &expanded_ranges);
     };
 
     /**
@@ -318,6 +422,14 @@ namespace pallas {
      */
     void dump(const Brute::HistoryOutput &h, HistoryWriter& writer);
 
+    /**
+     * @brief Encodes the system state contained in the history output as one record of the binary history format.
+     *
+     * @param h Brute::HistoryOutput. State of the system for a specific iteration.
+     * @param writer BinaryHistoryWriter. Object responsible for encoding the history output.
+     */
+    void dump(const Brute::HistoryOutput &h, BinaryHistoryWriter& writer);
+
 } // namespace pallas
 
 #endif // PALLAS_BRUTE_H
\ No newline at end of file
@@ -37,7 +37,9 @@
 #ifndef PALLAS_COOLING_SCHEDULE_H
 #define PALLAS_COOLING_SCHEDULE_H
 
+#include "pallas/gradient_problem.h"
 #include "pallas/types.h"
+#include "pallas/internal/evaluator.h"
 #include "pallas/internal/state.h"
 #include "pallas/step_function.h"
 
@@ -127,6 +129,18 @@ namespace pallas {
                                     internal::State& state,
                                     StepFunction* step_function);
 
+        /**
+         * @brief Estimates an appropriate starting temperature, evaluating the samples through `evaluator`.
+         * @details Only the cost of the samples is computed. The evaluations are counted by `evaluator`.
+         *
+         * @param evaluator pallas::internal::Evaluator. Evaluates the problem to optimize.
+         * @param state pallas::internal::State. The details of the current state of the minimization algorithm.
+         * @param step_function pallas::StepFunction. This function produces randomized candidate solutions.
+         */
+        void calc_start_temperature(internal::Evaluator* evaluator,
+                                    internal::State& state,
+                                    StepFunction* step_function);
+
 
     protected:
         double temperature;/**<Current temperature of the cooling schedule.*/
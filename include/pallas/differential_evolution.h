@@ -41,13 +41,22 @@
 #define PALLAS_DIFFERENTIAL_EVOLUTION_H
 
 #include <cfloat>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "pallas/history_concept.h"
+#include "pallas/history_ring.h"
+#include "pallas/history_sink.h"
+#include "pallas/iteration_callback.h"
+#include "pallas/scoped_ptr.h"
+#include "pallas/gradient_problem.h"
 #include "pallas/types.h"
-#include "pallas/internal/crossover_strategy.h"
-#include "pallas/internal/mutation_strategy.h"
+#include "pallas/internal/evaluator.h"
+#include "pallas/internal/index_sampler.h"
 #include "pallas/internal/shuffler.h"
 #include "pallas/internal/state.h"
+#include "pallas/internal/trial_generator.h"
 
 namespace pallas {
 
@@ -130,6 +139,49 @@ namespace pallas {
      */
     class DifferentialEvolution {
     public:
+        struct HistoryOutput;
+
+        /**
+         * @brief Mutation and crossover settings of one island of an island model optimization.
+         * @details See `DifferentialEvolution::Options::island_strategies`.
+         */
+        struct IslandStrategy {
+            /**
+             * @brief Default constructor
+             * @details Uses the same defaults as pallas::DifferentialEvolution::Options.
+             */
+            IslandStrategy()
+                    : mutation_strategy(BEST_1),
+                      crossover_strategy(BINOMIAL),
+                      crossover_probability(0.7) {
+                dither << 0.5, 1.0;
+            };
+
+            /**
+             * @brief Constructor
+             *
+             * @param mutation_strategy MutationStrategyType. The mutation strategy of the island.
+             * @param crossover_strategy CrossoverStrategyType. The crossover strategy of the island.
+             * @param crossover_probability double. The recombination constant of the island.
+             * @param dither Vector2d. Range the mutation constant of the island is drawn from each generation.
+             */
+            IslandStrategy(MutationStrategyType mutation_strategy,
+                           CrossoverStrategyType crossover_strategy,
+                           double crossover_probability,
+                           const Vector2d& dither)
+                    : mutation_strategy(mutation_strategy),
+                      crossover_strategy(crossover_strategy),
+                      crossover_probability(crossover_probability),
+                      dither(dither) {};
+
+            MutationStrategyType mutation_strategy;/**<The mutation strategy of the island.*/
+            CrossoverStrategyType crossover_strategy;/**<The crossover strategy of the island.*/
+            double crossover_probability;/**<The recombination constant of the island.*/
+            Vector2d dither;/**<Range the mutation constant of the island is drawn from each generation.*/
+
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
         /**
          * Configurable options for modifying the default behaviour of the differential evolution algorithm.
          */
@@ -141,10 +193,17 @@ namespace pallas {
              */
             Options() {
                 local_minimizer_options = GradientLocalMinimizer::Options();
+                local_minimizer_type = CERES_LOCAL_MINIMIZER;
+                least_squares_minimizer_options = LeastSquaresLocalMinimizer::Options();
                 mutation_strategy = BEST_1;
                 crossover_strategy = BINOMIAL;
                 population_initialization = LATIN_HYPERCUBE;
+                population_update = IMMEDIATE;
+                num_threads = 1;
+                seed = -1;
                 max_iterations = 1000;
+                max_function_evaluations = INT64_MAX;
+                max_gradient_evaluations = INT64_MAX;
                 population_size = 15;
                 tolerance = 0.01;
                 minimum_cost = -DBL_MAX;
@@ -153,6 +212,12 @@ namespace pallas {
                 is_silent = true;
                 polish_output = false;
                 history_save_frequency = 0;
+                history_sink = NULL;
+                history_ring = NULL;
+                num_islands = 1;
+                migration_interval = 20;
+                num_migrants = 1;
+                migration_topology = RING_TOPOLOGY;
             };
 
             /**
@@ -161,6 +226,24 @@ namespace pallas {
              */
             GradientLocalMinimizer::Options local_minimizer_options;
 
+            /**
+             * Local minimizer used for the polishing step. `CERES_LOCAL_MINIMIZER` (the default) runs a
+             * `GradientLocalMinimizer`. `PALLAS_LOCAL_MINIMIZER` runs the lightweight line search minimizer of pallas,
+             * which avoids the fixed per-call overhead of ceres and is faster for cheap cost functions. It supports the
+             * `LBFGS`, `BFGS` and `STEEPEST_DESCENT` line search directions of `local_minimizer_options`. The polish
+             * stays within `lower_bounds` and `upper_bounds`, so the pallas minimizer, projected onto the bounds, is
+             * used either way.
+             */
+            LocalMinimizerType local_minimizer_type;
+
+            /**
+             * Contains any changes to the default options for the least squares local minimizer, which replaces the
+             * gradient based local minimizer for the polishing of the final solution when the problem is built from a
+             * pallas::LeastSquaresCostFunction. See the documentation for ceres::Solver::Options for relevant options,
+             * such as `linear_solver_type` and `num_threads`.
+             */
+            LeastSquaresLocalMinimizer::Options least_squares_minimizer_options;
+
             /**
              * The mutation strategy to use. Should be one of `BEST_1`, `RAND_1`, `RAND_TO_BEST_1`, `BEST_2`, or `RAND_2`.
              */
@@ -180,11 +263,63 @@ namespace pallas {
              */
             PopulationInitializationType population_initialization;
 
+            /**
+             * Specify when improved trial candidates replace members of the population.
+             * Should be one of: `IMMEDIATE`, `DEFERRED` or `ASYNCHRONOUS`. The default is `IMMEDIATE`.
+             * With `IMMEDIATE` updating each trial is evaluated as soon as it is built and, if it is
+             * better than its target, replaces it straight away so later trials in the same generation
+             * can use it. With `DEFERRED` updating the trials for the whole generation are built from
+             * the current population, evaluated together and only then compared against their targets.
+             * `ASYNCHRONOUS` updating is a steady-state variant of immediate updating for cost functions whose
+             * evaluation time varies between candidates: each of the `num_threads` workers keeps one trial in
+             * flight, and whenever an evaluation finishes its trial is selected against the live population and
+             * the worker builds its next trial straight away, so no worker waits for the slowest evaluation of a
+             * generation. Targets are taken in turn and a generation is counted every `population_size`
+             * selections. The order in which evaluations finish depends on timing, so asynchronous runs on more
+             * than one thread are not reproducible.
+             */
+            PopulationUpdateType population_update;
+
+            /**
+             * Number of threads used to evaluate the initial population and, with `DEFERRED` updating,
+             * the trial candidates of each generation. If more than one thread is requested with `IMMEDIATE`
+             * updating, deferred updating is used instead. All random numbers are drawn on the calling thread
+             * while the trials are built, so the result does not depend on the number of threads.
+             * With `ASYNCHRONOUS` updating this is the number of evaluations kept in flight (at most
+             * `population_size`).
+             * The cost function must be safe to evaluate concurrently when this is greater than 1.
+             */
+            int num_threads;
+
+            /**
+             * Seed for the random number generators. Runs with the same seed and options produce bitwise identical
+             * results, independent of `num_threads` (except with `ASYNCHRONOUS` updating on several threads). Each
+             * random component (population initialization, dither, shuffling and crossover) draws from its own
+             * non-overlapping stream derived from the seed.
+             * If negative (the default) a seed is drawn from `std::random_device` and reported in the summary.
+             */
+            int seed;
+
             /**
              * The maximum number of times the entire population is evolved.
              */
             unsigned int max_iterations;
 
+            /**
+             * Maximum number of evaluations of the cost function, with or without the gradient. The budget is checked
+             * after every generation, which may overrun it by up to one evaluation of the population. With
+             * `num_islands` greater than one, each island gets an equal share of it. Once spent, the run ends with the
+             * fittest individual and the polishing step is skipped; a polish that starts with budget left runs to
+             * completion. Unlimited by default.
+             */
+            int64_t max_function_evaluations;
+
+            /**
+             * Maximum number of evaluations of the cost function with its gradient, including those made by local
+             * minimizations. Checked like `max_function_evaluations`. Unlimited by default.
+             */
+            int64_t max_gradient_evaluations;
+
 
             /**
              * The total number of individuals in the population.
@@ -245,6 +380,67 @@ namespace pallas {
              * large number of iterations this can lead to a lot of data being stored in memory.
              */
             unsigned int history_save_frequency;
+
+            /**
+             * Receives the history outputs selected by `history_save_frequency` as they are produced instead of
+             * `Summary::history` when not NULL (the default). See pallas::HistorySink and
+             * pallas::JsonLinesHistorySink, which streams the outputs to a file. The sink is not owned by the solver.
+             */
+            HistorySink* history_sink;
+
+            /**
+             * Keeps only the last history outputs selected by `history_save_frequency`, in preallocated slots that
+             * are reused without allocating, when not NULL (the default). The outputs are then not appended to
+             * `Summary::history`. See pallas::HistoryRing. The ring is not owned by the solver.
+             */
+            HistoryRing<HistoryOutput>* history_ring;
+
+            /**
+             * Called at the end of every generation, see pallas::IterationCallback. With several islands the
+             * callbacks are called after every migration interval with the state of the island holding the best
+             * individual. The callbacks are not owned by the solver.
+             */
+            std::vector<IterationCallback*> callbacks;
+
+            /**
+             * Number of sub-populations (islands) evolved side by side. Default is 1, a single population. When greater
+             * than 1 each island is a population of `population_size` individuals, initialized and evolved on its own
+             * with the mutation and crossover settings of `island_strategies`. The islands are evolved concurrently on
+             * up to `num_threads` threads, with `IMMEDIATE` updating unless `DEFERRED` updating is requested
+             * (`ASYNCHRONOUS` updating falls back to `IMMEDIATE`). Every `migration_interval` generations the best
+             * `num_migrants` individuals of each island replace the worst individuals of another island chosen by
+             * `migration_topology`. An island stops evolving once it meets a termination condition, and the
+             * optimization ends when every island has stopped or the `minimum_cost` is reached. The best individual
+             * of all islands is polished and returned. Each island draws from its own random streams, so the result
+             * does not depend on `num_threads`.
+             */
+            unsigned int num_islands;
+
+            /**
+             * Mutation and crossover settings of the islands when `num_islands` is greater than 1. Island `i` uses
+             * entry `i % island_strategies.size()`, so a few strategies can be cycled over many islands. If empty
+             * (the default) every island uses `mutation_strategy`, `crossover_strategy`, `crossover_probability`
+             * and `dither`.
+             */
+            std::vector<IslandStrategy, Eigen::aligned_allocator<IslandStrategy> > island_strategies;
+
+            /**
+             * Number of generations each island is evolved between migrations. Default is 20.
+             */
+            unsigned int migration_interval;
+
+            /**
+             * Number of individuals each island sends to another island at every migration. Default is 1. At most
+             * `population_size - 1` individuals are sent.
+             */
+            unsigned int num_migrants;
+
+            /**
+             * Which island receives the migrants of each island. With `RING_TOPOLOGY` (the default) island `i`
+             * sends to island `(i + 1) % num_islands`. With `RANDOM_TOPOLOGY` a different island is drawn at random
+             * for every island at every migration.
+             */
+            MigrationTopologyType migration_topology;
         };
 
         /**
@@ -273,6 +469,18 @@ namespace pallas {
              */
             CrossoverStrategyType crossover_strategy;
 
+            PopulationUpdateType population_update;/**<When improved trial candidates replaced members of the population.*/
+
+            int num_threads;/**<Number of threads used to evaluate trial candidates.*/
+
+            unsigned int num_islands;/**<Number of islands evolved, 1 for a single population.*/
+
+            unsigned int num_migrations;/**<Number of times the islands exchanged individuals.*/
+
+            double worker_utilization;/**<Fraction of the time the workers of `ASYNCHRONOUS` updating spent evaluating trial candidates, -1 for the other population updates.*/
+
+            int seed;/**<Seed used for the random number generators. Pass it in the options to repeat the run.*/
+
             std::string message;/**<Message describing why the solver terminated.*/
 
             double final_cost;/**<Cost of the problem (value of the objective function) after the optimization.*/
@@ -281,7 +489,15 @@ namespace pallas {
 
             unsigned int num_parameters;/**<Number of parameters in the problem.*/
 
-            unsigned int num_iterations;/**<Number of times the population was evolved*/
+            unsigned int num_iterations;/**<Number of times the population was evolved (of the most evolved island with several islands).*/
+
+            int64_t num_cost_evaluations;/**<Number of cost-only evaluations performed outside local minimization.*/
+
+            int64_t num_gradient_evaluations;/**<Number of cost and gradient evaluations performed outside local minimization.*/
+
+            int64_t num_local_cost_evaluations;/**<Number of cost-only evaluations performed by local minimizations.*/
+
+            int64_t num_local_gradient_evaluations;/**<Number of cost and gradient evaluations performed by local minimizations.*/
 
             double total_time_in_seconds;/**<total time elapsed in global minimizer*/
 
@@ -291,7 +507,7 @@ namespace pallas {
 
             bool was_polished;/**<whether global minimum was polished after differential evolution completed*/
 
-            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option.*/
+            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option. Empty if a `history_sink` or `history_ring` was set.*/
         };
 
         /**
@@ -303,20 +519,36 @@ namespace pallas {
              * @brief Constructor
              *
              * @param iteration_number unsigned int. The number of global optimization iterations that have elapsed.
-             * @param population std::vector<Vector>. Candidate solutions for the current iteration.
+             * @param population pallas::Matrix. Candidate solutions for the current iteration, one per column.
              * @param best_cost double. Cost associated with the best individual found at any iteration thus far during optimization.
              * @param best_solution Vector. Best solution found at any iteration thus far during optimization.
              */
             HistoryOutput(unsigned int iteration_number,
-                          const std::vector<Vector> &population,
+                          const Matrix &population,
                           double best_cost,
                           const Vector &best_solution)
                     : iteration_number(iteration_number),
                       population(population),
                       best_cost(best_cost),
                       best_solution(best_solution) {}
+
+            /**
+             * @brief Overwrites the history output in place.
+             * @details Takes the same arguments as the constructor. No memory is allocated when the vectors have the
+             * sizes of those already stored, which lets pallas::HistoryRing reuse its slots.
+             */
+            void assign(unsigned int iteration_number,
+                        const Eigen::Ref<const Matrix>& population,
+                        double best_cost,
+                        const Eigen::Ref<const Vector>& best_solution) {
+                this->iteration_number = iteration_number;
+                this->population = population;
+                this->best_cost = best_cost;
+                this->best_solution = best_solution;
+            }
+
             unsigned int iteration_number;/**<The number of global optimization iterations that have elapsed.*/
-            std::vector<Vector> population;/**<Candidate solutions for the current iteration.*/
+            Matrix population;/**<Candidate solutions for the current iteration, one per column.*/
             double best_cost;/**<Cost associated with the best individual found at any iteration thus far during optimization.*/
             Vector best_solution;/**<Best solution found at any iteration thus far during optimization.*/
         };
@@ -324,7 +556,7 @@ namespace pallas {
         /**
          * @brief Default constructor
          */
-        DifferentialEvolution() {};
+        DifferentialEvolution() : island_index_(0) {};
 
         /**
          * @brief Minimizes the specified gradient problem.
@@ -343,20 +575,25 @@ namespace pallas {
                    DifferentialEvolution::Summary* global_summary);
     private:
         /**
-         * @brief Initializes the state of member variables based on the optimizer options.
+         * @brief Minimizes the problem with the island model, see `DifferentialEvolution::Options::num_islands`.
          */
-        void init_member_variables_(const DifferentialEvolution::Options& options);
+        void solve_islands_(const DifferentialEvolution::Options& options,
+                            const GradientProblem& problem,
+                            double* parameters,
+                            DifferentialEvolution::Summary* global_summary);
 
         /**
-         * @brief Creates the mutation strategy member function.
+         * @brief Initializes the state of member variables based on the optimizer options.
+         * @details The random streams are those of the island `island_index_`.
          */
-        void init_mutation_strategy_(MutationStrategyType type);
+        void init_member_variables_(const DifferentialEvolution::Options& options);
 
         /**
-         * @brief Creates the crossover strategy member function.
+         * @brief Creates the fused mutation and crossover kernel used to generate trial candidates.
          */
-        void init_crossover_strategy_(CrossoverStrategyType type,
-                                      double crossover_probability);
+        void init_trial_generator_(MutationStrategyType mutation_strategy,
+                                   CrossoverStrategyType crossover_strategy,
+                                   double crossover_probability);
 
         /**
          * @brief Creates the random dither member function.
@@ -374,10 +611,10 @@ namespace pallas {
          * `[0,1]`. This function returns the parameters back to their original scale based on the 
          * upper and lower ranges provided for the functions.
          * 
-         * @param trial_in pallas::Vector. The vector in local space.
-         * @param trial_out pallas::Vector. The vector to write the position in global space to.
+         * @param trial_in pallas::Vector. The vector (or matrix column) in local space.
+         * @param trial_out pallas::Vector. The vector (or matrix column) to write the position in global space to.
          */
-        void scale_parameters_(const Vector& trial_in, Vector& trial_out);
+        void scale_parameters_(const Eigen::Ref<const Vector>& trial_in, Eigen::Ref<Vector> trial_out);
 
         /**
          * @brief Scales the parameters from global to local coordinates.
@@ -385,18 +622,18 @@ namespace pallas {
          * `[0,1]`. This function converts parameters back to fall between 0 and 1 based on the 
          * upper and lower ranges provided for the functions.
          * 
-         * @param trial_in pallas::Vector. The vector in global space.
-         * @param trial_out pallas::Vector. The vector to write the position in local space to.
+         * @param trial_in pallas::Vector. The vector (or matrix column) in global space.
+         * @param trial_out pallas::Vector. The vector (or matrix column) to write the position in local space to.
          */  
-        void unscale_parameters_(const Vector& trial_in, Vector& trial_out);
+        void unscale_parameters_(const Eigen::Ref<const Vector>& trial_in, Eigen::Ref<Vector> trial_out);
 
         /**
          * @brief Ensures the trail candidate's parameters fall within the bounds.
          * @details If a parameters falls outside of the bounds a random number is chosen to replace it.
          * 
-         * @param trial pallas::Vector&. Trial candidate to enforce boundary constraints on.
+         * @param trial pallas::Vector. Trial candidate (or matrix column) to enforce boundary constraints on.
          */
-        void ensure_constraint_(Vector& trial);
+        void ensure_constraint_(Eigen::Ref<Vector> trial);
 
         /**
          * @brief Update the fractional standard deviation of the population.
@@ -409,10 +646,112 @@ namespace pallas {
         /**
          * @brief Produce a new candidate from the `ith` member of the population. 
          * 
-         * @param candidate pallas::Vector&. Member of population to mutate.
+         * @param candidate pallas::Vector. Vector (or matrix column) to write the trial candidate to.
          * @param int unsigned int. Index candidate appears in the population.
          */
-        void mutate_(Vector& candidate, unsigned int idx);
+        void mutate_(Eigen::Ref<Vector> candidate, unsigned int idx);
+
+        /**
+         * @brief Evaluates a block of candidates in global coordinates.
+         * @details The whole block is handed to `GradientProblem::EvaluateBatch`, split into
+         * contiguous chunks when more than one thread is used. Only costs are computed.
+         *
+         * @param scaled_candidates pallas::Matrix. Candidates to evaluate, in global coordinates, one per column.
+         * @param num_threads int. The number of threads to evaluate the candidates on.
+         * @param energies pallas::Vector*. Stores the cost of each candidate.
+         * @param message std::string*. If an evaluation fails, a message describing the failure is stored in the variable.
+         * @return Returns `true` if every candidate was evaluated successfully, `false` otherwise.
+         */
+        bool evaluate_candidates_(const Matrix& scaled_candidates,
+                                  int num_threads,
+                                  Vector* energies,
+                                  std::string* message);
+
+        /**
+         * @brief Evaluates the initial population and moves its fittest individual to the first slot.
+         *
+         * @return Returns `false` if an evaluation failed, `true` otherwise.
+         */
+        bool evaluate_initial_population_(int num_threads, DifferentialEvolution::Summary* global_summary);
+
+        /**
+         * @brief Builds, evaluates and selects one generation of trial candidates with `IMMEDIATE` or `DEFERRED`
+         * updating.
+         *
+         * @return Returns `false` if an evaluation failed, `true` otherwise.
+         */
+        bool evolve_population_(PopulationUpdateType population_update,
+                                int num_threads,
+                                DifferentialEvolution::Summary* global_summary);
+
+        /**
+         * @brief Copies the `migrants.cols()` fittest individuals and their costs into `migrants` and `migrant_energies`.
+         */
+        void select_migrants_(Eigen::Ref<Matrix> migrants, Eigen::Ref<Vector> migrant_energies) const;
+
+        /**
+         * @brief Replaces the worst individuals of the population with the migrants that have a lower cost.
+         * @details The fittest individual is kept in the first slot and the standard deviation of the
+         * population is updated.
+         */
+        void accept_migrants_(const Eigen::Ref<const Matrix>& migrants,
+                              const Eigen::Ref<const Vector>& migrant_energies);
+
+        /**
+         * @brief Saves the populations of all islands, in island order, and their best individual to the history.
+         */
+        void save_island_history_(const DifferentialEvolution::Options& options,
+                                  const std::vector<std::unique_ptr<DifferentialEvolution> >& islands,
+                                  Matrix* scaled_population,
+                                  DifferentialEvolution::Summary* global_summary);
+
+        /**
+         * @brief Polishes the global minimum if requested and evaluates its final cost.
+         * @details The polishing step is skipped if the run was aborted or `is_budget_spent` is set.
+         */
+        void polish_global_minimum_(const DifferentialEvolution::Options& options,
+                                    const GradientProblem& problem,
+                                    bool is_budget_spent,
+                                    GradientLocalMinimizer::Summary* local_summary,
+                                    DifferentialEvolution::Summary* global_summary);
+
+        /**
+         * @brief Replaces the `target`th member of the population with `trial` if the trial has a lower cost.
+         * @details Used with `IMMEDIATE` and `ASYNCHRONOUS` updating. A trial that beats the fittest individual
+         * also replaces the first slot.
+         */
+        void select_trial_(unsigned int target, double trial_cost, const Eigen::Ref<const Vector>& trial);
+
+        /**
+         * @brief Replaces each member of the population with its trial if the trial has a lower cost.
+         * @details Used with `DEFERRED` updating once a generation of trials has been evaluated. The
+         * fittest individual is moved to the first slot afterwards.
+         */
+        void select_trials_();
+
+        /**
+         * @brief Evolves the population with `ASYNCHRONOUS` updating until a termination condition is met.
+         * @details Runs one worker per thread; the trials are built and selected under a lock while the cost
+         * function is evaluated outside of it. Sets the worker utilization and number of threads of the summary.
+         *
+         * @return Returns `false` if an evaluation failed, `true` otherwise.
+         */
+        bool evolve_asynchronously_(const DifferentialEvolution::Options& options,
+                                    int num_threads,
+                                    internal::State* current_state,
+                                    Matrix* scaled_population,
+                                    DifferentialEvolution::Summary* global_summary);
+
+        /**
+         * @brief Updates the global minimum, the standard deviation of the population and the history at the end
+         * of a generation.
+         *
+         * @return Returns `true` if a termination condition was met, `false` otherwise.
+         */
+        bool complete_generation_(const DifferentialEvolution::Options& options,
+                                  internal::State* current_state,
+                                  Matrix* scaled_population,
+                                  DifferentialEvolution::Summary* global_summary);
 
         /**
          * @brief Checks to see if any termination conditions were met.
@@ -426,30 +765,48 @@ namespace pallas {
                                     std::string *message,
                                     TerminationType * termination_type);
 
+        /**
+         * @brief Whether the evaluations made so far spend the `max_function_evaluations` or
+         * `max_gradient_evaluations` budget.
+         */
+        bool is_evaluation_budget_spent_(const DifferentialEvolution::Options& options) const;
+
+        /**
+         * @brief Returns a view of the current iteration for the callbacks.
+         */
+        IterationSummary iteration_summary_() const;
+
         /**
          * @brief Updates the global summary before exiting the differential evolution algorithm.
          */
         void prepare_final_summary_(DifferentialEvolution::Summary *global_summary,
                                     const GradientLocalMinimizer::Summary &local_summary);
 
-        scoped_ptr<internal::MutationStrategy> mutation_strategy_;
-        scoped_ptr<internal::CrossoverStrategy> crossover_strategy_;
+        scoped_ptr<internal::Evaluator> evaluator_;/**<Evaluates the problem outside of local minimization and counts the evaluations.*/
+        scoped_ptr<internal::TrialGenerator> trial_generator_;
         Vector upper_bounds_;
         Vector lower_bounds_;
-        scoped_ptr< internal::RandomNumberGenerator< double > > random_number_;
-        scoped_ptr< internal::RandomNumberGenerator< double > > random_dither_;
+        internal::RandomNumberGenerator<double> random_number_;
+        internal::RandomNumberGenerator<double> random_dither_;
         scoped_ptr< internal::Shuffler > shuffler_;
+        scoped_ptr< internal::IndexSampler > index_sampler_;
+        int seed_;/**<Seed from which the random streams of the optimization are derived.*/
         double scale_; /**<Random mutation constant for each iteration generated by `random_dither_`*/
         double fractional_std_dev_;/**<The fractional standard deviation of the population. Controls convergence.*/
         Vector scale_arg1_;/**<Precomputed parameter to scale between global and local parameter space.*/
         Vector scale_arg2_;/**<Precomputed parameter to scale between global and local parameter space.*/
-        Vector population_energies_;/**<Cost associated with each member of the current population.*/
-        std::vector<Vector> population_;/**<All solutions currently being evolved.*/
-        Eigen::VectorXi population_idx_;/**<Randomly shuffled indices of the population used for mutation.*/
+        Matrix population_;/**<All solutions currently being evolved, one per column.*/
+        Vector population_energies_;/**<Cost associated with each column of `population_`.*/
+        Matrix trials_;/**<Trial candidates for the current generation (or in flight with `ASYNCHRONOUS` updating), one per column.*/
+        Matrix scaled_trials_;/**<Trial candidates scaled to global coordinates awaiting evaluation, one per column.*/
+        Vector trial_energies_;/**<Cost associated with each column of `trials_`.*/
+        Eigen::VectorXi population_idx_;/**<Randomly shuffled indices of the population used for Latin hypercube initialization.*/
+        Eigen::VectorXi samples_;/**<Distinct population indices, excluding the target, drawn for the current mutation.*/
         internal::State global_minimum_state_;/**The best solution found during any stage of the optimization. It is this value that is returned when minimization concludes.*/
         unsigned int num_parameters_;/**<The number of degrees of freedom each candidate solution possesses.*/
         unsigned int population_size_;/**<The number total number of individuals currently being evolved.*/
         unsigned int num_iterations_;/**<The number of differential evolution iterations the global optimizer has performed.*/
+        unsigned int island_index_;/**<Index of the island this instance evolves, selects its random substreams.*/
     };
 
     /**
@@ -476,6 +833,14 @@ namespace pallas {
      */
     void dump(const DifferentialEvolution::HistoryOutput &h, HistoryWriter& writer);
 
+    /**
+     * @brief Encodes the system state contained in the history output as one record of the binary history format.
+     *
+     * @param h DifferentialEvolution::HistoryOutput. State of the system for a specific iteration.
+     * @param writer BinaryHistoryWriter. Object responsible for encoding the history output.
+     */
+    void dump(const DifferentialEvolution::HistoryOutput &h, BinaryHistoryWriter& writer);
+
 } // namespace pallas
 
 #endif // PALLAS_DIFFERENTIAL_EVOLUTION_H
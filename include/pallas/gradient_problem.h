@@ -0,0 +1,198 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_GRADIENT_PROBLEM_H
+#define PALLAS_GRADIENT_PROBLEM_H
+
+#include "pallas/types.h"
+
+namespace pallas {
+
+    /**
+     * @brief Cost function that can evaluate many candidate solutions in a single call.
+     * @details Derive from this class instead of pallas::GradientCostFunction when the cost of several
+     * candidates can be computed more efficiently together (e.g. by amortizing setup or vectorizing
+     * across candidates). The single point `Evaluate` method must still be implemented since it is
+     * used for gradient based local minimization.
+     */
+    class BatchGradientCostFunction : public GradientCostFunction {
+    public:
+        /**
+         * @brief Destructor
+         */
+        virtual ~BatchGradientCostFunction() {}
+
+        /**
+         * @brief Evaluates the cost of `num_candidates` candidate solutions.
+         * @details Must override in derived class.
+         *
+         * @param num_candidates int. Number of candidates to evaluate.
+         * @param parameters const double*. Column-major `NumParameters() x num_candidates` block holding
+         * one candidate per column.
+         * @param costs double*. Array of length `num_candidates` that receives the cost of each candidate.
+         * @return Returns `true` if every candidate was evaluated successfully, `false` otherwise.
+         */
+        virtual bool EvaluateBatch(int num_candidates,
+                                   const double* parameters,
+                                   double* costs) const = 0;
+    };
+
+    /**
+     * @brief Gradient problem that can evaluate blocks of candidate solutions.
+     * @details Behaves exactly like `ceres::GradientProblem` and may be passed anywhere one is expected.
+     * If the cost function is a pallas::BatchGradientCostFunction, `EvaluateBatch` forwards to it;
+     * otherwise each candidate is evaluated one at a time through `Evaluate`.
+     *
+     * The problem may also be built from a residual based pallas::LeastSquaresCostFunction. The global phase
+     * of every solver then uses the scalar cost `0.5 * rho(|r|^2)` and its gradient, while local minimizations
+     * run through pallas::LeastSquaresLocalMinimizer (`ceres::Solver`) on the residuals.
+     */
+    class GradientProblem : public ceres::GradientProblem {
+    public:
+        /**
+         * @brief Constructor
+         * @details Wraps an existing `ceres::GradientProblem`, which could be passed to the solvers directly when
+         * pallas::GradientProblem was the same type. Evaluations are forwarded to `problem`, so candidates are
+         * evaluated one at a time and gradient evaluations are serialized between threads. `problem` is not owned
+         * and must outlive the pallas::GradientProblem.
+         *
+         * The cost function and local parameterization of a `ceres::GradientProblem` cannot be reached, so
+         * `problem` must not have a local parameterization. Only a parameterization that changes the number of
+         * parameters is detected; one of the same size would silently be replaced by plain addition. Build the
+         * pallas::GradientProblem from the cost function and parameterization instead in either case.
+         *
+         * @param problem ceres::GradientProblem. The problem to evaluate, without a local parameterization.
+         */
+        explicit GradientProblem(const ceres::GradientProblem& problem);
+
+        /**
+         * @brief Constructor
+         *
+         * @param function pallas::GradientCostFunction*. The cost function. Ownership is taken by the problem.
+         */
+        explicit GradientProblem(GradientCostFunction* function);
+
+        /**
+         * @brief Constructor
+         *
+         * @param function pallas::GradientCostFunction*. The cost function. Ownership is taken by the problem.
+         * @param parameterization ceres::LocalParameterization*. The local parameterization. Ownership is taken by the problem.
+         */
+        GradientProblem(GradientCostFunction* function,
+                        ceres::LocalParameterization* parameterization);
+
+        /**
+         * @brief Constructor
+         * @details The parameter blocks of `cost_function` are laid out one after the other in the parameter
+         * vector of the problem.
+         *
+         * @param cost_function pallas::LeastSquaresCostFunction*. The residuals. Ownership is taken by the problem.
+         */
+        explicit GradientProblem(LeastSquaresCostFunction* cost_function);
+
+        /**
+         * @brief Constructor
+         *
+         * @param cost_function pallas::LeastSquaresCostFunction*. The residuals. Ownership is taken by the problem.
+         * @param loss_function ceres::LossFunction*. The loss applied to the squared norm of the residuals,
+         * may be `NULL`. Ownership is taken by the problem.
+         */
+        GradientProblem(LeastSquaresCostFunction* cost_function,
+                        ceres::LossFunction* loss_function);
+
+        /**
+         * @brief Constructor
+         *
+         * @param cost_function pallas::LeastSquaresCostFunction*. The residuals, which must depend on a single
+         * parameter block. Ownership is taken by the problem.
+         * @param loss_function ceres::LossFunction*. The loss applied to the squared norm of the residuals,
+         * may be `NULL`. Ownership is taken by the problem.
+         * @param parameterization ceres::LocalParameterization*. The local parameterization. Ownership is taken by the problem.
+         */
+        GradientProblem(LeastSquaresCostFunction* cost_function,
+                        ceres::LossFunction* loss_function,
+                        ceres::LocalParameterization* parameterization);
+
+        /**
+         * @brief Evaluates the cost of `num_candidates` candidate solutions.
+         *
+         * @param num_candidates int. Number of candidates to evaluate.
+         * @param parameters const double*. Column-major `NumParameters() x num_candidates` block holding
+         * one candidate per column.
+         * @param costs double*. Array of length `num_candidates` that receives the cost of each candidate.
+         * @return Returns `true` if every candidate was evaluated successfully, `false` otherwise.
+         */
+        bool EvaluateBatch(int num_candidates,
+                           const double* parameters,
+                           double* costs) const;
+
+        /**
+         * @brief Returns the cost function of the problem.
+         */
+        const GradientCostFunction* function() const;
+
+        /**
+         * @brief Returns the batch cost function of the problem or `NULL` if the cost function
+         * only evaluates a single point at a time.
+         */
+        const BatchGradientCostFunction* batch_function() const;
+
+        /**
+         * @brief Returns the local parameterization of the problem or `NULL` if none was given.
+         */
+        const ceres::LocalParameterization* parameterization() const;
+
+        /**
+         * @brief Returns `LEAST_SQUARES` if the problem was built from residuals, `GRADIENT` otherwise.
+         */
+        CostFunctionType cost_function_type() const;
+
+        /**
+         * @brief Returns the residuals of the problem or `NULL` if it was built from a pallas::GradientCostFunction.
+         */
+        const LeastSquaresCostFunction* least_squares_function() const;
+
+        /**
+         * @brief Returns the loss function of the problem or `NULL` if none was given.
+         */
+        const ceres::LossFunction* loss_function() const;
+
+    private:
+        GradientProblem(GradientCostFunction* function,
+                        ceres::LocalParameterization* parameterization,
+                        LeastSquaresCostFunction* cost_function,
+                        ceres::LossFunction* loss_function);
+
+        const GradientCostFunction* function_;/**<Non-owning pointer to the cost function.*/
+        const BatchGradientCostFunction* batch_function_;/**<Non-owning pointer to the batch cost function (`NULL` if unavailable).*/
+        const ceres::LocalParameterization* parameterization_;/**<Non-owning pointer to the local parameterization (`NULL` if unavailable).*/
+        const LeastSquaresCostFunction* least_squares_function_;/**<Non-owning pointer to the residuals (`NULL` if unavailable).*/
+        const ceres::LossFunction* loss_function_;/**<Non-owning pointer to the loss function (`NULL` if unavailable).*/
+    };
+
+} // namespace pallas
+
+#endif //PALLAS_GRADIENT_PROBLEM_H
@@ -38,6 +38,8 @@
 
 namespace pallas {
 
+    class BinaryHistoryWriter;
+
     class HistoryConcept {
     public:
         template <typename T>
@@ -55,11 +57,15 @@ namespace pallas {
         friend void dump(const HistoryConcept &x, HistoryWriter& writer)
         { x.self_->dump_(writer); }
 
+        friend void dump(const HistoryConcept &x, BinaryHistoryWriter& writer)
+        { x.self_->dump_(writer); }
+
     private:
         struct concept_t {
             virtual ~concept_t() = default;
             virtual concept_t* copy_() const = 0;
             virtual void dump_(HistoryWriter&) const = 0;
+            virtual void dump_(BinaryHistoryWriter&) const = 0;
         };
         template <typename T>
         struct model : concept_t {
@@ -67,6 +73,8 @@ namespace pallas {
             concept_t* copy_() const { return new model(*this); }
             void dump_(HistoryWriter &writer) const
             { dump(data_, writer); }
+            void dump_(BinaryHistoryWriter &writer) const
+            { dump(data_, writer); }
 
             T data_;
         };
@@ -86,6 +94,14 @@ namespace pallas {
      * @param writer HistoryWriter. Dumps the history series to the contained stream.
      */
     void dump(const HistorySeries& history, HistoryWriter& writer);
+
+    /**
+     * @brief Encodes the optimization history series as records of the binary history format.
+     *
+     * @param history HistorySeries. Series of history data to encode.
+     * @param writer BinaryHistoryWriter. Encodes the history series, see pallas::BinaryHistoryWriter.
+     */
+    void dump(const HistorySeries& history, BinaryHistoryWriter& writer);
 } // namespace pallas
 
 #endif //PALLAS_HISTORY_CONCEPT_H
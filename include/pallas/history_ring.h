@@ -0,0 +1,155 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_HISTORY_RING_H
+#define PALLAS_HISTORY_RING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "glog/logging.h"
+#include "pallas/history_concept.h"
+
+namespace pallas {
+
+    /**
+     * @brief Keeps the last `capacity` history outputs of a solver in preallocated slots.
+     * @details When a ring is set in the `history_ring` option of a solver, the history outputs selected by
+     * `history_save_frequency` are recorded in the ring instead of `Summary::history`. The first output recorded by
+     * a call to `Solve` fills every slot, so all of the memory is allocated once at the start of the run (or not at
+     * all if the ring was used before for a problem of the same size). Later outputs overwrite the oldest slot in
+     * place through `HistoryOutput::assign`, which allocates nothing, and the ring never holds more than
+     * `capacity` outputs however long the run is. `Solve` clears the ring before recording. The ring is not owned by
+     * the solver.
+     *
+     * <B>Example</B>
+     * @code
+     pallas::HistoryRing<pallas::DifferentialEvolution::HistoryOutput> ring(100);
+     options.history_save_frequency = 1;
+     options.history_ring = &ring;
+     pallas::Solve(options, problem, parameters, &summary);
+     // ring[0] is the oldest of the last ring.Size() generations
+     * @endcode
+     *
+     * @tparam T The `HistoryOutput` type of the solver.
+     */
+    template <typename T>
+    class HistoryRing {
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param capacity unsigned int. Maximum number of outputs kept. A capacity of 0 keeps nothing.
+         */
+        explicit HistoryRing(unsigned int capacity)
+                : capacity_(capacity),
+                  next_slot_(0),
+                  size_(0),
+                  num_recorded_(0) {
+        };
+
+        /**
+         * @brief Forgets the recorded outputs. The slots are kept, so they can be reused without allocating.
+         */
+        void Clear() {
+            next_slot_ = 0;
+            size_ = 0;
+            num_recorded_ = 0;
+        };
+
+        /**
+         * @brief Records an output, overwriting the oldest one if the ring is full.
+         * @details Takes the arguments of the constructor of `T`.
+         */
+        template <typename... Args>
+        void Record(const Args&... args) {
+            if (capacity_ == 0)
+                return;
+
+            ++num_recorded_;
+            if (size_ == 0 && slots_.size() != capacity_) {
+                // the first output sizes every slot
+                slots_.assign(capacity_, T(args...));
+            } else {
+                slots_[next_slot_].assign(args...);
+            }
+            next_slot_ = next_slot_ + 1 == capacity_ ? 0 : next_slot_ + 1;
+            if (size_ < capacity_)
+                ++size_;
+        };
+
+        /**
+         * @brief The `i`th oldest output kept in the ring, `i < Size()`.
+         */
+        const T& operator[](unsigned int i) const {
+            DCHECK_LT(i, size_);
+            const unsigned int oldest_slot = size_ < capacity_ ? 0 : next_slot_;
+            const unsigned int slot = oldest_slot + i;
+            return slots_[slot < capacity_ ? slot : slot - capacity_];
+        };
+
+        unsigned int Capacity() const { return capacity_; };/**<Maximum number of outputs kept.*/
+
+        unsigned int Size() const { return size_; };/**<Number of outputs kept.*/
+
+        uint64_t NumRecorded() const { return num_recorded_; };/**<Number of outputs recorded since the last `Clear`, including the overwritten ones.*/
+
+    private:
+        std::vector<T> slots_;/**<Preallocated outputs, sized by the first output recorded.*/
+        unsigned int capacity_;/**<Maximum number of outputs kept.*/
+        unsigned int next_slot_;/**<Slot the next output is written to.*/
+        unsigned int size_;/**<Number of slots holding an output.*/
+        uint64_t num_recorded_;/**<Number of outputs recorded since the last `Clear`.*/
+    };
+
+    /**
+     * @brief Writes the outputs kept in the ring, oldest first, to the stream contained in the `HistoryWriter`.
+     * @details The output has the same form as that of a `HistorySeries`.
+     *
+     * @param ring HistoryRing. Outputs to write.
+     * @param writer HistoryWriter. Dumps the outputs to the contained stream.
+     */
+    template <typename T>
+    void dump(const HistoryRing<T>& ring, HistoryWriter& writer) {
+        writer.StartArray();
+        for (unsigned int i = 0; i < ring.Size(); ++i) dump(ring[i], writer);
+        writer.EndArray();
+    }
+
+    /**
+     * @brief Encodes the outputs kept in the ring, oldest first, as records of the binary history format.
+     *
+     * @param ring HistoryRing. Outputs to encode.
+     * @param writer BinaryHistoryWriter. Encodes the outputs, see pallas::BinaryHistoryWriter.
+     */
+    template <typename T>
+    void dump(const HistoryRing<T>& ring, BinaryHistoryWriter& writer) {
+        for (unsigned int i = 0; i < ring.Size(); ++i) dump(ring[i], writer);
+    }
+
+} // namespace pallas
+
+#endif // PALLAS_HISTORY_RING_H
@@ -0,0 +1,168 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_HISTORY_SINK_H
+#define PALLAS_HISTORY_SINK_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "rapidjson/stringbuffer.h"
+#include "pallas/binary_history.h"
+#include "pallas/history_concept.h"
+#include "pallas/internal/history_writer_thread.h"
+
+namespace pallas {
+
+    /**
+     * @brief Receives the history outputs of a solver as they are produced.
+     * @details When a sink is set in the `history_sink` option of a solver, the history outputs selected by
+     * `history_save_frequency` are handed to the sink instead of being appended to `Summary::history`, so the
+     * history of a long run does not have to be kept in memory. `Append` is called on the thread running the
+     * solver. The sink is not owned by the solver and must outlive the call to `Solve`.
+     */
+    class HistorySink {
+    public:
+        virtual ~HistorySink() {};
+
+        /**
+         * @brief Takes one history output of the solver.
+         *
+         * @param history HistoryConcept. The history output, moved into the sink.
+         */
+        virtual void Append(HistoryConcept history) = 0;
+
+        /**
+         * @brief Blocks until every history output appended so far has been written.
+         */
+        virtual void Flush() = 0;
+    };
+
+    /**
+     * @brief Streams history outputs to a JSON Lines file from a background writer thread.
+     * @details Each history output is written with its `dump` overload as one JSON object on its own line, so the
+     * file can be read line by line while the solver is still running. Appended outputs are queued and written
+     * by a dedicated thread, which keeps the encoding and disk writes off the solver thread. At most
+     * `max_queued_outputs` outputs are queued; `Append` blocks when the queue is full, so the memory used does
+     * not grow with the length of the run. The destructor writes the remaining outputs and closes the file.
+     * If the file cannot be opened an error is logged and the outputs are discarded.
+     */
+    class JsonLinesHistorySink : public HistorySink {
+    public:
+        /**
+         * @brief Constructor
+         * @details Opens (and truncates) the file and starts the writer thread.
+         *
+         * @param filename std::string. Path of the file to write.
+         * @param max_queued_outputs unsigned int. Maximum number of outputs waiting to be written. Default is 64.
+         */
+        explicit JsonLinesHistorySink(const std::string& filename, unsigned int max_queued_outputs = 64);
+
+        /**
+         * @brief Writes the queued outputs, stops the writer thread and closes the file.
+         */
+        virtual ~JsonLinesHistorySink();
+
+        virtual void Append(HistoryConcept history);
+
+        virtual void Flush();
+
+        /**
+         * @brief Whether the file was opened and every write so far succeeded.
+         */
+        bool IsGood() const;
+
+        /**
+         * @brief Number of history outputs written to the file so far.
+         */
+        uint64_t NumOutputsWritten() const;
+
+    private:
+        /**
+         * @brief Writes one output to the file. Runs on the writer thread.
+         */
+        bool write_output_(const HistoryConcept& history);
+
+        std::FILE* file_;/**<File the outputs are written to, NULL if it could not be opened.*/
+        rapidjson::StringBuffer buffer_;/**<Reused by the writer thread to encode each output.*/
+        HistoryWriter writer_;/**<Encodes the outputs into `buffer_`.*/
+        internal::HistoryWriterThread writer_thread_;/**<Writes the outputs. Declared last, so it stops first.*/
+    };
+
+    /**
+     * @brief Streams history outputs to a file in the binary history format from a background writer thread.
+     * @details Each history output is encoded with its `dump` overload as one fixed-width record, see
+     * pallas::BinaryHistoryWriter for the format and pallas::BinaryHistoryReader to read the file. Encoding
+     * doubles in binary is much faster and more compact than JSON. The outputs are queued and written as with
+     * pallas::JsonLinesHistorySink. All outputs must have the same layout (the same solver, number of parameters
+     * and number of candidates); an output that does not match the first one is dropped and `IsGood` returns
+     * `false`. If the file cannot be opened an error is logged and the outputs are discarded.
+     */
+    class BinaryHistorySink : public HistorySink {
+    public:
+        /**
+         * @brief Constructor
+         * @details Opens (and truncates) the file and starts the writer thread.
+         *
+         * @param filename std::string. Path of the file to write.
+         * @param max_queued_outputs unsigned int. Maximum number of outputs waiting to be written. Default is 64.
+         */
+        explicit BinaryHistorySink(const std::string& filename, unsigned int max_queued_outputs = 64);
+
+        /**
+         * @brief Writes the queued outputs, stops the writer thread and closes the file.
+         */
+        virtual ~BinaryHistorySink();
+
+        virtual void Append(HistoryConcept history);
+
+        virtual void Flush();
+
+        /**
+         * @brief Whether the file was opened and every output so far was written.
+         */
+        bool IsGood() const;
+
+        /**
+         * @brief Number of history outputs written to the file so far.
+         */
+        uint64_t NumOutputsWritten() const;
+
+    private:
+        /**
+         * @brief Writes one output to the file. Runs on the writer thread.
+         */
+        bool write_output_(const HistoryConcept& history);
+
+        std::FILE* file_;/**<File the outputs are written to, NULL if it could not be opened.*/
+        BinaryHistoryWriter writer_;/**<Encodes the outputs. Used by the writer thread only.*/
+        internal::HistoryWriterThread writer_thread_;/**<Writes the outputs. Declared last, so it stops first.*/
+    };
+
+} // namespace pallas
+
+#endif // PALLAS_HISTORY_SINK_H
@@ -0,0 +1,130 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_ITERATION_CALLBACK_H
+#define PALLAS_ITERATION_CALLBACK_H
+
+#include <cstdint>
+
+#include "pallas/types.h"
+
+namespace pallas {
+
+    /**
+     * @brief Read-only view of the state of a solver at the end of an iteration.
+     * @details The view refers to the storage of the solver instead of copying it, so it is only valid for the
+     * duration of the callback. Fields that do not apply to the solver keep their default values.
+     */
+    struct IterationSummary {
+        /**
+         * @brief Constructor
+         *
+         * @param solver_type SolverType. Solver that completed the iteration.
+         * @param iteration_number uint64_t. Number of the iteration. The grid index of the point for pallas::Brute.
+         * @param num_parameters int. Number of parameters of the solutions.
+         * @param current_cost double. Cost of the current solution.
+         * @param current_solution const double*. Current solution.
+         * @param best_cost double. Cost of the best solution found so far.
+         * @param best_solution const double*. Best solution found so far.
+         */
+        IterationSummary(SolverType solver_type,
+                         uint64_t iteration_number,
+                         int num_parameters,
+                         double current_cost,
+                         const double* current_solution,
+                         double best_cost,
+                         const double* best_solution)
+                : solver_type(solver_type),
+                  iteration_number(iteration_number),
+                  num_stagnant_iterations(0),
+                  current_cost(current_cost),
+                  current_solution(current_solution, num_parameters),
+                  best_cost(best_cost),
+                  best_solution(best_solution, num_parameters),
+                  temperature(0.0),
+                  population_costs(NULL),
+                  fractional_std_dev(0.0) {}
+
+        /**
+         * @brief Copy constructor
+         * @details The copy views the same storage as `summary`.
+         *
+         * @param summary IterationSummary. Summary to copy.
+         */
+        IterationSummary(const IterationSummary& summary)
+                : solver_type(summary.solver_type),
+                  iteration_number(summary.iteration_number),
+                  num_stagnant_iterations(summary.num_stagnant_iterations),
+                  current_cost(summary.current_cost),
+                  current_solution(summary.current_solution.data(), summary.current_solution.size()),
+                  best_cost(summary.best_cost),
+                  best_solution(summary.best_solution.data(), summary.best_solution.size()),
+                  temperature(summary.temperature),
+                  population_costs(summary.population_costs),
+                  fractional_std_dev(summary.fractional_std_dev) {}
+
+        // the views cannot be rebound to other storage, so a summary cannot be assigned
+        IterationSummary& operator=(const IterationSummary&) = delete;
+
+        SolverType solver_type;/**<Solver that completed the iteration.*/
+        uint64_t iteration_number;/**<Number of the iteration. The grid index of the point for pallas::Brute.*/
+        unsigned int num_stagnant_iterations;/**<Number of iterations without a new global minimum. Zero for differential evolution and brute.*/
+        double current_cost;/**<Cost of the current solution. That of the coldest replica for parallel tempering and of the fittest individual for differential evolution.*/
+        ConstVectorRef current_solution;/**<Current solution, see `current_cost`.*/
+        double best_cost;/**<Cost of the best solution found so far.*/
+        ConstVectorRef best_solution;/**<Best solution found so far.*/
+        double temperature;/**<Current temperature for simulated annealing, lowest temperature of the ladder for parallel tempering. Zero otherwise.*/
+        const Vector* population_costs;/**<Cost of each individual for differential evolution and of each replica for parallel tempering. `NULL` otherwise.*/
+        double fractional_std_dev;/**<Fractional standard deviation of the population costs for differential evolution. Zero otherwise.*/
+    };
+
+    /**
+     * @brief Called by a solver at the end of every iteration.
+     * @details Callbacks are set in the `callbacks` option of a solver, which calls them in order and stops at the
+     * first one that does not return `SOLVER_CONTINUE`:
+     * - `SOLVER_ABORT` ends the run with `USER_FAILURE` and leaves the parameters untouched.
+     * - `SOLVER_TERMINATE_SUCCESSFULLY` ends the run with `USER_SUCCESS` and returns the best solution found.
+     *
+     * The view is only built when at least one callback is set, so a solver without callbacks pays nothing for
+     * them. Callbacks are not owned by the solver and must outlive the call to `Solve`. They are called by one
+     * thread at a time, though not necessarily the thread that called `Solve`.
+     */
+    class IterationCallback {
+    public:
+        virtual ~IterationCallback() {};
+
+        /**
+         * @brief Observes the iteration that just completed.
+         *
+         * @param summary IterationSummary. State of the solver, only valid during the call.
+         * @return Returns `SOLVER_CONTINUE` to keep iterating, `SOLVER_ABORT` or `SOLVER_TERMINATE_SUCCESSFULLY` to stop.
+         */
+        virtual CallbackReturnType operator()(const IterationSummary& summary) = 0;
+    };
+
+} // namespace pallas
+
+#endif // PALLAS_ITERATION_CALLBACK_H
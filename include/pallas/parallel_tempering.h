@@ -0,0 +1,505 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_PARALLEL_TEMPERING_H
+#define PALLAS_PARALLEL_TEMPERING_H
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include "pallas/history_concept.h"
+#include "pallas/history_ring.h"
+#include "pallas/history_sink.h"
+#include "pallas/iteration_callback.h"
+#include "pallas/step_function.h"
+#include "pallas/gradient_problem.h"
+#include "pallas/types.h"
+#include "pallas/internal/evaluator.h"
+#include "pallas/internal/state.h"
+#include "pallas/internal/metropolis.h"
+#include "pallas/internal/random_number_generator.h"
+#include "pallas/scoped_ptr.h"
+
+
+namespace pallas {
+    /**
+     * @brief Minimizes a function using parallel tempering (replica exchange Monte Carlo).
+     * @details Several Metropolis chains (replicas) sample the cost function at a fixed ladder of temperatures.
+     * Hot replicas roam the parameter space while cold replicas refine the best regions found. Every
+     * `swap_interval` steps, replicas at neighbouring temperatures attempt to exchange their states, which lets
+     * good solutions found at high temperature migrate down the ladder. Like simulated annealing, no derivative
+     * information is used outside of the optional polishing step.\n
+     * <B>Example</B>
+     * @code
+     #include "glog/logging.h"
+     #include "pallas/parallel_tempering.h"
+
+     // Rosenbrock is defined as in the pallas::SimulatedAnnealing example.
+
+     int main(int argc, char** argv) {
+         google::InitGoogleLogging(argv[0]);
+
+         double parameters[2] = {-1.2, 0.0};
+
+         pallas::ParallelTempering::Options options;
+         options.num_replicas = 8;
+         options.minimum_temperature = 0.01;
+         options.maximum_temperature = 10.0;
+         options.num_threads = 4;
+         options.minimum_cost = 0.001;
+
+         pallas::ParallelTempering::Summary summary;
+         pallas::GradientProblem problem(new Rosenbrock());
+
+         pallas::Solve(options, problem, parameters, &summary);
+
+         std::cout << summary.FullReport() << std::endl;
+         return 0;
+     }
+     * @endcode
+     */
+    class ParallelTempering {
+    public:
+        struct HistoryOutput;
+
+        /**
+         * Configurable options for modifying the default behaviour of the parallel tempering algorithm.
+         */
+        struct Options {
+            Options () {
+                local_minimizer_options = GradientLocalMinimizer::Options();
+                local_minimizer_type = CERES_LOCAL_MINIMIZER;
+                least_squares_minimizer_options = LeastSquaresLocalMinimizer::Options();
+                scoped_ptr<StepFunction> default_step(new DefaultStepFunction(1.0));
+                step_function.swap(default_step);
+                num_replicas = 8;
+                minimum_temperature = 0.1;
+                maximum_temperature = 100.0;
+                swap_interval = 10;
+                max_iterations = 1000;
+                max_function_evaluations = INT64_MAX;
+                max_gradient_evaluations = INT64_MAX;
+                max_stagnant_iterations = 100;
+                minimum_cost = -DBL_MAX;
+                is_silent = true;
+                polish_output = false;
+                history_save_frequency = 0;
+                history_sink = NULL;
+                history_ring = NULL;
+                num_threads = 1;
+                seed = -1;
+            };
+
+            /**
+             * @brief Convenience function for changing the default step function.
+             * @details This function simply swaps the scoped_ptr to the user
+             * defined `StepFunction` with the scoped_ptr to the `StepFunction`
+             * held within the `pallas::ParallelTempering::Options` struct.
+             *
+             * @param user_step_function pallas::scoped_ptr<pallas::StepFunction>. This function generates randomized candidate solutions based on the current position.
+             */
+            void set_step_function(scoped_ptr<StepFunction>& user_step_function) {
+                swap(user_step_function, step_function);
+            };
+
+            /**
+             * Contains any changes to the default options for the local minimization algorithm.
+             * See the documentation for ceres::GradientProblemSolver::Options for relevant options
+             */
+            GradientLocalMinimizer::Options local_minimizer_options;
+
+            /**
+             * Local minimizer used for the polishing step. `CERES_LOCAL_MINIMIZER` (the default) runs a
+             * `GradientLocalMinimizer`. `PALLAS_LOCAL_MINIMIZER` runs the lightweight line search minimizer of pallas,
+             * which avoids the fixed per-call overhead of ceres and is faster for cheap cost functions. It supports the
+             * `LBFGS`, `BFGS` and `STEEPEST_DESCENT` line search directions of `local_minimizer_options`. If the step
+             * function has bounds (e.g. pallas::BoundedStepFunction) the polish stays within them, so the pallas
+             * minimizer, projected onto the bounds, is used either way.
+             */
+            LocalMinimizerType local_minimizer_type;
+
+            /**
+             * Contains any changes to the default options for the least squares local minimizer, which replaces the
+             * gradient based local minimizer for the polishing of the final solution when the problem is built from a
+             * pallas::LeastSquaresCostFunction. See the documentation for ceres::Solver::Options for relevant options,
+             * such as `linear_solver_type` and `num_threads`.
+             */
+            LeastSquaresLocalMinimizer::Options least_squares_minimizer_options;
+
+            /**
+             * Function that produces randomized candidate solutions. It is shared by all replicas and is only
+             * called from the calling thread.
+             */
+            scoped_ptr<StepFunction> step_function;
+
+            /**
+             * Number of replicas (Metropolis chains), one per temperature. Ignored if `temperatures` is not empty.
+             */
+            unsigned int num_replicas;
+
+            /**
+             * Temperature of the coldest replica when the ladder is generated.
+             */
+            double minimum_temperature;
+
+            /**
+             * Temperature of the hottest replica when the ladder is generated. The `num_replicas` temperatures
+             * are spaced geometrically between `minimum_temperature` and `maximum_temperature`.
+             */
+            double maximum_temperature;
+
+            /**
+             * User specified temperature ladder. If not empty it overrides `num_replicas`, `minimum_temperature`
+             * and `maximum_temperature`. Must be strictly increasing and positive.
+             */
+            std::vector<double> temperatures;
+
+            /**
+             * The number of steps each replica takes between attempts to swap neighbouring replicas.
+             */
+            unsigned int swap_interval;
+
+            /**
+             * Maximum number of parallel tempering iterations. Each iteration consists of `swap_interval` steps
+             * of every replica followed by one round of swap attempts.
+             */
+            unsigned int max_iterations;
+
+            /**
+             * Maximum number of evaluations of the cost function, with or without the gradient. The budget is checked
+             * after every iteration, which may overrun it by up to `swap_interval` steps of every replica. Once spent,
+             * the run ends with the best point seen by any replica and the polishing step is skipped; a polish that
+             * starts with budget left runs to completion. Unlimited by default.
+             */
+            int64_t max_function_evaluations;
+
+            /**
+             * Maximum number of evaluations of the cost function with its gradient, including those made by local
+             * minimizations. Checked like `max_function_evaluations`. Unlimited by default.
+             */
+            int64_t max_gradient_evaluations;
+
+            /**
+             * Maximum number sequential iterations allowed without finding a new global minimum.
+             */
+            unsigned int max_stagnant_iterations;
+
+            /**
+             * User specified minimum cost. Minimization will halt if `minimum_cost` is reached.
+             */
+            double minimum_cost;
+
+            /**
+             * Whether the global minimum found through parallel tempering should be subjected to a local minimization "polishing" step before returning the result.
+             */
+            bool polish_output;
+
+            /**
+             * Whether to log failure information relating the to global optimization algorithm using glog.
+             */
+            bool is_silent;
+
+            /**
+             * Frequency to save the state of the system. Values will be appended to a `HistorySeries` contained
+             * in the optimization summary. Default is 0. If 0 then history is not saved. Otherwise, the state of
+             * the system will be appended to the series when `i % history_save_frequency == 0`. If there are a
+             * large number of iterations this can lead to a lot of data being stored in memory.
+             */
+            unsigned int history_save_frequency;
+
+            /**
+             * Receives the history outputs selected by `history_save_frequency` as they are produced instead of
+             * `Summary::history` when not NULL (the default). See pallas::HistorySink and
+             * pallas::JsonLinesHistorySink, which streams the outputs to a file. The sink is not owned by the solver.
+             */
+            HistorySink* history_sink;
+
+            /**
+             * Keeps only the last history outputs selected by `history_save_frequency`, in preallocated slots that
+             * are reused without allocating, when not NULL (the default). The outputs are then not appended to
+             * `Summary::history`. See pallas::HistoryRing. The ring is not owned by the solver.
+             */
+            HistoryRing<HistoryOutput>* history_ring;
+
+            /**
+             * Called at the end of every iteration, see pallas::IterationCallback. The callbacks are not owned by
+             * the solver.
+             */
+            std::vector<IterationCallback*> callbacks;
+
+            /**
+             * Number of threads used to evaluate the candidates of the replicas. All random numbers are drawn on
+             * the calling thread, so the result does not depend on the number of threads. The cost function must
+             * be safe to evaluate concurrently when this is greater than 1.
+             */
+            int num_threads;
+
+            /**
+             * Seed for the random number generators. Runs with the same seed and options produce bitwise identical
+             * results, independent of `num_threads`. The step function, the acceptance test of each replica and the
+             * swap test each draw from their own non-overlapping stream derived from the seed. If negative (the
+             * default) a seed is drawn from `std::random_device` and reported in the summary.
+             */
+            int seed;
+        };
+
+        /**
+         * @brief Contains a summary of the optimization.
+         * @details This struct contains the result of the optimization and has convenience methods for printing reports of a completed optimization.
+         */
+        struct Summary {
+            /**
+             * @brief Default constructor
+             */
+            Summary();
+
+            std::string BriefReport() const;/**<A brief one line description of the state of the solver after termination.*/
+
+            std::string FullReport() const;/**<A full multi-line description of the state of the solver after termination.*/
+
+            TerminationType termination_type;/**<Reason optimization was terminated*/
+
+            std::string message;/**<Message describing why the solver terminated.*/
+
+            double initial_cost;/**<Cost of the problem (value of the objective function) before the optimization.*/
+
+            double final_cost;/**<Cost of the problem (value of the objective function) after the optimization.*/
+
+            GradientLocalMinimizer::Summary local_minimization_summary;/**<Summary from the local minimization polishing step (if performed).*/
+
+            unsigned int num_parameters;/**<Number of parameters in the problem.*/
+
+            unsigned int num_replicas;/**<Number of replicas in the temperature ladder.*/
+
+            int num_threads;/**<Number of threads used to evaluate the candidates of the replicas.*/
+
+            int seed;/**<Seed used for the random number generators. Pass it in the options to repeat the run.*/
+
+            unsigned int num_iterations;/**<Number of iterations*/
+
+            int64_t num_cost_evaluations;/**<Number of cost-only evaluations performed outside local minimization.*/
+
+            int64_t num_gradient_evaluations;/**<Number of cost and gradient evaluations performed outside local minimization.*/
+
+            int64_t num_local_cost_evaluations;/**<Number of cost-only evaluations performed by local minimizations.*/
+
+            int64_t num_local_gradient_evaluations;/**<Number of cost and gradient evaluations performed by local minimizations.*/
+
+            int64_t num_swap_attempts;/**<Number of attempted swaps between neighbouring replicas.*/
+
+            int64_t num_accepted_swaps;/**<Number of accepted swaps between neighbouring replicas.*/
+
+            double total_time_in_seconds;/**<total time elapsed in global minimizer*/
+
+            double local_minimization_time_in_seconds;/**<time spent in local minimizer (if polishing was done).*/
+
+            double step_time_in_seconds;/**<time spent calling step function*/
+
+            double cost_evaluation_time_in_seconds;/**<time spent evaluating cost function (outside local minimization)*/
+
+            bool was_polished;/**<whether global minimum was polished after parallel tempering completed*/
+
+            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option. Empty if a `history_sink` or `history_ring` was set.*/
+        };
+
+        /**
+         * @brief Stores information about the state of the system for at a given iteration number
+         */
+        struct HistoryOutput {
+
+            /**
+             * @brief Constructor
+             *
+             * @param iteration_number unsigned int. The number of global optimization iterations that have elapsed.
+             * @param stagnant_iterations unsigned int. The number of iterations that have elapsed without finding a new global minimum.
+             * @param replica_costs Vector. Current cost of each replica, ordered from the coldest to the hottest temperature.
+             * @param current_solution Vector. Current solution of the coldest replica.
+             * @param best_cost double. Cost associated with the best solution found at any iteration thus far during optimization.
+             * @param best_solution Vector. Best solution found at any iteration thus far during optimization.
+             */
+            HistoryOutput(unsigned int iteration_number,
+                          unsigned int stagnant_iterations,
+                          const Vector &replica_costs,
+                          const Vector &current_solution,
+                          double best_cost,
+                          const Vector &best_solution)
+                    : iteration_number(iteration_number),
+                      stagnant_iterations(stagnant_iterations),
+                      replica_costs(replica_costs),
+                      current_solution(current_solution),
+                      best_cost(best_cost),
+                      best_solution(best_solution) {}
+
+            /**
+             * @brief Overwrites the history output in place.
+             * @details Takes the same arguments as the constructor. No memory is allocated when the vectors have the
+             * sizes of those already stored, which lets pallas::HistoryRing reuse its slots.
+             */
+            void assign(unsigned int iteration_number,
+                        unsigned int stagnant_iterations,
+                        const Eigen::Ref<const Vector>& replica_costs,
+                        const Eigen::Ref<const Vector>& current_solution,
+                        double best_cost,
+                        const Eigen::Ref<const Vector>& best_solution) {
+                this->iteration_number = iteration_number;
+                this->stagnant_iterations = stagnant_iterations;
+                this->replica_costs = replica_costs;
+                this->current_solution = current_solution;
+                this->best_cost = best_cost;
+                this->best_solution = best_solution;
+            }
+
+            unsigned int iteration_number;/**<The number of global optimization iterations that have elapsed.*/
+            unsigned int stagnant_iterations;/**<The number of iterations that have elapsed without finding a new global minimum.*/
+            Vector replica_costs;/**<Current cost of each replica, ordered from the coldest to the hottest temperature.*/
+            Vector current_solution;/**<Current solution of the coldest replica.*/
+            double best_cost;/**<Cost associated with the best solution found at any iteration thus far during optimization.*/
+            Vector best_solution;/**<Best solution found at any iteration thus far during optimization.*/
+        };
+
+        /**
+         * @brief Default constructor
+         */
+        ParallelTempering() {};
+
+        /**
+         * @brief Minimizes the specified gradient problem.
+         * @details The specified options are used to setup a parallel tempering instance which
+         * is then used to minimize the GradientProblem. The optimal solution is stored
+         * in `parameters` and a summary of the global optimization can be found in `summary`.
+         *
+         * @param options pallas::ParallelTempering::Options. Options used to configure the optimization.
+         * @param problem pallas::GradientProblem. The problem to optimize.
+         * @param parameters double*. The starting point for further optimization.
+         * @param summary ParallelTempering::Summary*. Summary instance to store the optimization details.
+         */
+        void Solve(const ParallelTempering::Options& options,
+                   const GradientProblem& problem,
+                   double* parameters,
+                   ParallelTempering::Summary* global_summary);
+
+    private:
+        /**
+         * @brief Builds the temperature ladder and the acceptance test of each replica.
+         */
+        void init_replicas_(const ParallelTempering::Options& options, uint64_t seed);
+
+        /**
+         * @brief Attempts to swap the states of neighbouring replicas.
+         * @details Pairs `(i, i + 1)` starting at even `i` are tried on even iterations and pairs starting at
+         * odd `i` on odd iterations, so every pair is attempted every second iteration. A swap is accepted with
+         * probability `min(1, exp((beta_i - beta_j) * (cost_i - cost_j)))`.
+         */
+        void swap_replicas_();
+
+        /**
+         * @brief Checks to see if any termination conditions were met.
+         *
+         * @param options pallas::ParallelTempering::Options. Options used to configure the optimization.
+         * @param message std::string*. If a termination condition is met, a message describing the satisfied condition is stored in the variable.
+         * @param termination_type pallas::TerminationType*. This
+         * @return Returns `true` if a termination condition was meet, `false` otherwise.
+         */
+        bool check_for_termination_(const ParallelTempering::Options& options,
+                                    std::string *message,
+                                    TerminationType * termination_type);
+
+        /**
+         * @brief Whether the evaluations made so far spend the `max_function_evaluations` or
+         * `max_gradient_evaluations` budget.
+         */
+        bool is_evaluation_budget_spent_(const ParallelTempering::Options& options) const;
+
+        /**
+         * @brief Returns a view of the current iteration for the callbacks.
+         */
+        IterationSummary iteration_summary_() const;
+
+        /**
+         * @brief Saves the history output of the current iteration.
+         */
+        void save_history_(const ParallelTempering::Options& options, ParallelTempering::Summary* global_summary) const;
+
+        /**
+         * @brief Updates the global summary before exiting the parallel tempering algorithm.
+         */
+        void prepare_final_summary_(ParallelTempering::Summary *global_summary,
+                                    const GradientLocalMinimizer::Summary &local_summary);
+
+        scoped_ptr<internal::Evaluator> evaluator_;/**<Evaluates the problem outside of local minimization and counts the evaluations.*/
+        std::vector<internal::Metropolis> metropolis_;/**<Acceptance test of each replica, at the temperature of the replica.*/
+        internal::RandomNumberGenerator<double> swap_random_number_;/**<Draws the random numbers of the swap test.*/
+        Vector temperatures_;/**<Temperature of each replica in increasing order.*/
+        Matrix replicas_;/**<Current solution of each replica, one per column.*/
+        Vector replica_costs_;/**<Current cost of each replica.*/
+        Matrix candidates_;/**<Candidate solution of each replica, one per column.*/
+        Vector candidate_costs_;/**<Cost of each candidate solution.*/
+        internal::State global_minimum_state_;/**<The best solution found during any stage of the optimization. It is this value that is returned when minimization concludes.*/
+
+        unsigned int num_replicas_;/**<The number of replicas in the temperature ladder.*/
+        unsigned int num_iterations_;/**<The number of iterations the global optimizer has performed.*/
+        unsigned int num_stagnant_iterations_;/**<The number of iterations that have elapsed without finding a new global minimum.*/
+        int64_t num_swap_attempts_;/**<The number of attempted replica swaps.*/
+        int64_t num_accepted_swaps_;/**<The number of accepted replica swaps.*/
+    };
+
+    /**
+     * @brief Helper function that avoids going through the interface of the pallas::ParallelTempering class.
+     * @details The specified options are used to setup a parallel tempering instance which
+     * is then used to minimize the GradientProblem. The optimal solution is stored
+     * in `parameters` and a summary of the global optimization can be found in `summary`.
+     *
+     * @param options pallas::ParallelTempering::Options. Options used to configure the optimization.
+     * @param problem pallas::GradientProblem. The problem to optimize.
+     * @param parameters double*. The starting point for further optimization.
+     * @param summary ParallelTempering::Summary*. Summary instance to store the optimization details.
+     */
+    void Solve(const ParallelTempering::Options& options,
+               const GradientProblem& problem,
+               double* parameters,
+               ParallelTempering::Summary* summary);
+
+    /**
+     * @brief Dumps the system state contained in the history output into the stream contained by the writer.
+     *
+     * @param h ParallelTempering::HistoryOutput. State of the system for a specific iteration.
+     * @param writer HistoryWriter. Object responsible for writing the history output to a stream.
+     */
+    void dump(const ParallelTempering::HistoryOutput &h, HistoryWriter& writer);
+
+    /**
+     * @brief Encodes the system state contained in the history output as one record of the binary history format.
+     *
+     * @param h ParallelTempering::HistoryOutput. State of the system for a specific iteration.
+     * @param writer BinaryHistoryWriter. Object responsible for encoding the history output.
+     */
+    void dump(const ParallelTempering::HistoryOutput &h, BinaryHistoryWriter& writer);
+
+} // namespace pallas
+
+#endif // PALLAS_PARALLEL_TEMPERING_H
@@ -28,10 +28,16 @@
 #define PALLAS_SIMULATED_ANNEALING_H
 
 #include <cfloat>
+#include <cstdint>
+#include <vector>
 
 #include "pallas/cooling_schedule.h"
 #include "pallas/history_concept.h"
+#include "pallas/history_ring.h"
+#include "pallas/history_sink.h"
+#include "pallas/iteration_callback.h"
 #include "pallas/step_function.h"
+#include "pallas/gradient_problem.h"
 #include "pallas/types.h"
 #include "pallas/internal/state.h"
 #include "pallas/internal/metropolis.h"
@@ -141,6 +147,8 @@ namespace pallas {
      */
     class SimulatedAnnealing {
     public:
+        struct HistoryOutput;
+
         /**
          * Configurable options for modifying the default behaviour of the simulated annealing algorithm.
          */
@@ -148,15 +156,22 @@ namespace pallas {
             Options () {
                 cooling_schedule_options = CoolingSchedule::Options();
                 local_minimizer_options = GradientLocalMinimizer::Options();
+                local_minimizer_type = CERES_LOCAL_MINIMIZER;
+                least_squares_minimizer_options = LeastSquaresLocalMinimizer::Options();
                 scoped_ptr<StepFunction> default_step(new DefaultStepFunction(1.0));
                 step_function.swap(default_step);
                 max_iterations = 1000;
+                max_function_evaluations = INT64_MAX;
+                max_gradient_evaluations = INT64_MAX;
                 max_stagnant_iterations = 100;
                 dwell_iterations = 20;
                 minimum_cost = -DBL_MAX;
                 is_silent = true;
                 polish_output = false;
                 history_save_frequency = 0;
+                history_sink = NULL;
+                history_ring = NULL;
+                seed = -1;
             };
 
             /**
@@ -182,6 +197,24 @@ namespace pallas {
              */
             GradientLocalMinimizer::Options local_minimizer_options;
 
+            /**
+             * Local minimizer used for the polishing step. `CERES_LOCAL_MINIMIZER` (the default) runs a
+             * `GradientLocalMinimizer`. `PALLAS_LOCAL_MINIMIZER` runs the lightweight line search minimizer of pallas,
+             * which avoids the fixed per-call overhead of ceres and is faster for cheap cost functions. It supports the
+             * `LBFGS`, `BFGS` and `STEEPEST_DESCENT` line search directions of `local_minimizer_options`. If the step
+             * function has bounds (e.g. pallas::BoundedStepFunction) the polish stays within them, so the pallas
+             * minimizer, projected onto the bounds, is used either way.
+             */
+            LocalMinimizerType local_minimizer_type;
+
+            /**
+             * Contains any changes to the default options for the least squares local minimizer, which replaces the
+             * gradient based local minimizer for the polishing of the final solution when the problem is built from a
+             * pallas::LeastSquaresCostFunction. See the documentation for ceres::Solver::Options for relevant options,
+             * such as `linear_solver_type` and `num_threads`.
+             */
+            LeastSquaresLocalMinimizer::Options least_squares_minimizer_options;
+
             /**
              * Function that produces randomized candidate solutions.
              */
@@ -192,6 +225,20 @@ namespace pallas {
              */
             unsigned int max_iterations;
 
+            /**
+             * Maximum number of evaluations of the cost function, with or without the gradient. The budget is checked
+             * after every annealing step, so it is overrun by at most one step. Once spent, the run ends with the best
+             * point found so far and the polishing step is skipped; a polish that starts with budget left runs to
+             * completion and its evaluations are counted as local evaluations. Unlimited by default.
+             */
+            int64_t max_function_evaluations;
+
+            /**
+             * Maximum number of evaluations of the cost function with its gradient, including those made by local
+             * minimizations. Checked like `max_function_evaluations`. Unlimited by default.
+             */
+            int64_t max_gradient_evaluations;
+
             /**
              * Maximum number sequential simulated annealing iterations allowed without finding a new global minimum.
              */
@@ -224,6 +271,34 @@ namespace pallas {
              * large number of iterations this can lead to a lot of data being stored in memory.
              */
             unsigned int history_save_frequency;
+
+            /**
+             * Receives the history outputs selected by `history_save_frequency` as they are produced instead of
+             * `Summary::history` when not NULL (the default). See pallas::HistorySink and
+             * pallas::JsonLinesHistorySink, which streams the outputs to a file. The sink is not owned by the solver.
+             */
+            HistorySink* history_sink;
+
+            /**
+             * Keeps only the last history outputs selected by `history_save_frequency`, in preallocated slots that
+             * are reused without allocating, when not NULL (the default). The outputs are then not appended to
+             * `Summary::history`. See pallas::HistoryRing. The ring is not owned by the solver.
+             */
+            HistoryRing<HistoryOutput>* history_ring;
+
+            /**
+             * Called at the end of every iteration, see pallas::IterationCallback. The callbacks are not owned by
+             * the solver.
+             */
+            std::vector<IterationCallback*> callbacks;
+
+            /**
+             * Seed for the random number generators. Runs with the same seed and options produce bitwise identical
+             * results. The step function and the acceptance test each draw from their own non-overlapping stream
+             * derived from the seed (see `StepFunction::Seed`). If negative (the default) a seed is drawn from
+             * `std::random_device` and reported in the summary.
+             */
+            int seed;
         };
 
         /**
@@ -257,8 +332,18 @@ namespace pallas {
 
             unsigned int num_parameters;/**<Number of parameters in the problem.*/
 
+            int seed;/**<Seed used for the random number generators. Pass it in the options to repeat the run.*/
+
             unsigned int num_iterations;/**<Number of iterations*/
 
+            int64_t num_cost_evaluations;/**<Number of cost-only evaluations performed outside local minimization.*/
+
+            int64_t num_gradient_evaluations;/**<Number of cost and gradient evaluations performed outside local minimization.*/
+
+            int64_t num_local_cost_evaluations;/**<Number of cost-only evaluations performed by local minimizations.*/
+
+            int64_t num_local_gradient_evaluations;/**<Number of cost and gradient evaluations performed by local minimizations.*/
+
             double total_time_in_seconds;/**<total time elapsed in global minimizer*/
 
             double local_minimization_time_in_seconds;/**<time spent in local minimizer (if polishing was done).*/
@@ -269,7 +354,7 @@ namespace pallas {
 
             bool was_polished;/**<whether global minimum was polished after differential evolution completed*/
 
-            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option.*/
+            HistorySeries history;/**<History of the system saved on the interval specified by the `history_save_frequency` option. Empty if a `history_sink` or `history_ring` was set.*/
         };
 
         /**
@@ -299,6 +384,26 @@ namespace pallas {
                       current_solution(current_solution),
                       best_cost(best_cost),
                       best_solution(best_solution) {}
+
+            /**
+             * @brief Overwrites the history output in place.
+             * @details Takes the same arguments as the constructor. No memory is allocated when the vectors have the
+             * sizes of those already stored, which lets pallas::HistoryRing reuse its slots.
+             */
+            void assign(unsigned int iteration_number,
+                        unsigned int stagnant_iterations,
+                        double temperature,
+                        const Eigen::Ref<const Vector>& current_solution,
+                        double best_cost,
+                        const Eigen::Ref<const Vector>& best_solution) {
+                this->iteration_number = iteration_number;
+                this->stagnant_iterations = stagnant_iterations;
+                this->temperature = temperature;
+                this->current_solution = current_solution;
+                this->best_cost = best_cost;
+                this->best_solution = best_solution;
+            }
+
             unsigned int iteration_number;/**<The number of global optimization iterations that have elapsed.*/
             unsigned int stagnant_iterations;/**<The number of iterations that have elapsed without finding a new global minimum.*/
             double temperature;/**<Current temperature of the system.*/
@@ -341,6 +446,17 @@ namespace pallas {
                                     std::string *message,
                                     TerminationType * termination_type);
 
+        /**
+         * @brief Whether the evaluations made so far spend the `max_function_evaluations` or
+         * `max_gradient_evaluations` budget.
+         */
+        bool is_evaluation_budget_spent_(const SimulatedAnnealing::Options& options) const;
+
+        /**
+         * @brief Returns a view of the current iteration for the callbacks.
+         */
+        IterationSummary iteration_summary_() const;
+
         /**
          * @brief Updates the global summary before exiting the simulated annealing algorithm.
          */
@@ -349,6 +465,7 @@ namespace pallas {
 
         scoped_ptr<CoolingSchedule> cooling_schedule_;/**<Responsible for updating the temperature of the system. Higher temperatures make accepting a worse candidate solution more likely.*/
 
+        scoped_ptr<internal::Evaluator> evaluator_;/**<Evaluates the problem outside of local minimization and counts the evaluations.*/
         internal::Metropolis metropolis_;/**<Determines whether to accept a higher cost candidate solution*/
         internal::State current_state_;/**<The current state of the optimization*/
         internal::State candidate_state_;/**<A randomized candidate solution that is then minimized using a local minimization algorithm and compared to the current state.*/
@@ -382,6 +499,14 @@ namespace pallas {
      */
     void dump(const SimulatedAnnealing::HistoryOutput &h, HistoryWriter& writer);
 
+    /**
+     * @brief Encodes the system state contained in the history output as one record of the binary history format.
+     *
+     * @param h SimulatedAnnealing::HistoryOutput. State of the system for a specific iteration.
+     * @param writer BinaryHistoryWriter. Object responsible for encoding the history output.
+     */
+    void dump(const SimulatedAnnealing::HistoryOutput &h, BinaryHistoryWriter& writer);
+
 } // namespace pallas
 
 #endif // PALLAS_SIMULATED_ANNEALING_H
\ No newline at end of file
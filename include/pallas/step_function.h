@@ -53,6 +53,30 @@ namespace pallas {
          * @param num_parameters. unsigned int. The number of parameters to modify in `x`.
          */
         virtual void Step(double* x, unsigned int num_parameters) = 0;
+
+        /**
+         * @brief Restarts the random number generation of the step function.
+         * @details Called by the solvers before optimization with the seed given in their options so that runs
+         * with the same seed are reproducible. The default implementation does nothing; user defined step
+         * functions that draw random numbers should override it and derive their generators from `seed`.
+         *
+         * @param seed uint64_t. Seed shared by all random streams of the optimization.
+         * @param thread_id unsigned int. Index of the thread (or chain) that uses the step function.
+         */
+        virtual void Seed(uint64_t /*seed*/, unsigned int /*thread_id*/) {}
+
+        /**
+         * @brief Returns the upper bounds on the candidate's variables or `NULL` if they are unbounded.
+         * @details The solvers keep their local minimizations within the bounds of their step function, so the
+         * cost function is not evaluated outside of them. The default implementation returns `NULL`.
+         */
+        virtual const double* upper_bounds() const { return NULL; }
+
+        /**
+         * @brief Returns the lower bounds on the candidate's variables or `NULL` if they are unbounded.
+         * @details Must return `NULL` if and only if `upper_bounds` does. The default implementation returns `NULL`.
+         */
+        virtual const double* lower_bounds() const { return NULL; }
     };
 
     
@@ -80,11 +104,21 @@ namespace pallas {
          */
         void Step(double* x, unsigned int num_parameters);
 
+        /**
+         * @brief Restarts the generation of random steps on the step function stream of `seed`.
+         *
+         * @param seed uint64_t. Seed shared by all random streams of the optimization.
+         * @param thread_id unsigned int. Index of the thread (or chain) that uses the step function.
+         */
+        void Seed(uint64_t seed, unsigned int thread_id);
+
     private:
         /**
          * @brief Generates random numbers between +/- `step_size`.
          */
-        scoped_ptr<internal::RandomNumberGenerator<double>> random_number_;
+        internal::RandomNumberGenerator<double> random_number_;
+
+        Vector steps_;/**<Random steps drawn for the current call*/
     };
 
     /**
@@ -125,12 +159,31 @@ namespace pallas {
          */
         void Step(double* x, unsigned int num_parameters);
 
+        /**
+         * @brief Restarts the generation of random steps on the step function stream of `seed`.
+         *
+         * @param seed uint64_t. Seed shared by all random streams of the optimization.
+         * @param thread_id unsigned int. Index of the thread (or chain) that uses the step function.
+         */
+        void Seed(uint64_t seed, unsigned int thread_id);
+
+        /**
+         * @brief Returns the upper bounds on the candidate's variables.
+         */
+        const double* upper_bounds() const;
+
+        /**
+         * @brief Returns the lower bounds on the candidate's variables.
+         */
+        const double* lower_bounds() const;
+
     private:
         /**
          * @brief Generates random numbers between +/- `step_size`.
          */
-        scoped_ptr<internal::RandomNumberGenerator<double>> random_number_;
+        internal::RandomNumberGenerator<double> random_number_;
 
+        Vector steps_;/**<Random steps drawn for the current call*/
         Vector upper_bounds_;/**<Upper bounds on candidate solutions*/
         Vector lower_bounds_;/**<Lower bounds on candidate solutions*/
     };
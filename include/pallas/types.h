@@ -16,12 +16,12 @@ namespace pallas {
     using LeastSquaresCostFunction = ceres::CostFunction;
 
     using LeastSquaresProblem = ceres::Problem;
-    using GradientProblem = ceres::GradientProblem;
 
     using GradientLocalMinimizer = ceres::GradientProblemSolver;
     using LeastSquaresLocalMinimizer = ceres::Solver;
 
     using Vector = ceres::Vector;
+    using Matrix = Eigen::MatrixXd;
     using VectorRef = ceres::VectorRef;
     using ConstVectorRef = ceres::ConstVectorRef;
 
@@ -29,10 +29,20 @@ namespace pallas {
 
     using TerminationType = ceres::TerminationType;
 
+    using CallbackReturnType = ceres::CallbackReturnType;
+
     using Vector2d = Eigen::Vector2d;
 
     using HistoryWriter = rapidjson::Writer<rapidjson::StringBuffer>;
 
+    enum SolverType {
+        BASINHOPPING,
+        BRUTE,
+        DIFFERENTIAL_EVOLUTION,
+        PARALLEL_TEMPERING,
+        SIMULATED_ANNEALING,
+    };
+
     enum MutationStrategyType {
         BEST_1,
         RAND_1,
@@ -56,12 +66,31 @@ namespace pallas {
         RANDOM,
     };
 
+    enum PopulationUpdateType {
+        IMMEDIATE,
+        DEFERRED,
+        ASYNCHRONOUS,
+    };
+
+    enum MigrationTopologyType {
+        RING_TOPOLOGY,
+        RANDOM_TOPOLOGY,
+    };
+
     enum CoolingScheduleType {
         BOLTZMANN,
         CAUCHY,
         FAST,
     };
 
+    enum LocalMinimizerType {
+        CERES_LOCAL_MINIMIZER,
+        PALLAS_LOCAL_MINIMIZER,
+    };
+
+    const char* SolverTypeToString(SolverType type);
+    bool StringToSolverType(std::string value, SolverType* type);
+
     const char* CoolingScheduleTypeToString(CoolingScheduleType type);
     bool StringToCoolingScheduleType(std::string value, CoolingScheduleType* type);
     
@@ -74,6 +103,15 @@ namespace pallas {
     const char* PopulationInitializationTypeToString(PopulationInitializationType type);
     bool StringToPopulationInitializationType(std::string value, PopulationInitializationType* type);
 
+    const char* PopulationUpdateTypeToString(PopulationUpdateType type);
+    bool StringToPopulationUpdateType(std::string value, PopulationUpdateType* type);
+
+    const char* MigrationTopologyTypeToString(MigrationTopologyType type);
+    bool StringToMigrationTopologyType(std::string value, MigrationTopologyType* type);
+
+    const char* LocalMinimizerTypeToString(LocalMinimizerType type);
+    bool StringToLocalMinimizerType(std::string value, LocalMinimizerType* type);
+
 } // namespace pallas
 
 #endif //PALLAS_TYPES_H
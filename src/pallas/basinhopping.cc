@@ -23,9 +23,16 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "Eigen/Core"
+#include <algorithm>
+#include <cfloat>
+
 #include "glog/logging.h"
 
 #include "pallas/basinhopping.h"
+#include "pallas/binary_history.h"
+#include "pallas/internal/least_squares_minimizer.h"
+#include "pallas/internal/parallel_for.h"
+#include "pallas/internal/shared_problem.h"
 #include "pallas/internal/solver_utils.h"
 #include "pallas/internal/stringprintf.h"
 #include "pallas/internal/wall_time.h"
@@ -43,31 +50,45 @@ namespace pallas {
 
     namespace {
 
-        bool Evaluate(const GradientProblem &problem,
-                      Vector &x,
+        bool Evaluate(internal::Evaluator* evaluator,
+                      const Vector &x,
                       internal::State *state,
                       std::string *message) {
-            if (!problem.Evaluate(x.data(),
-                                  &(state->cost),
-                                  state->gradient.data())) {
-                *message = "Gradient evaluation failed.";
-                return false;
-            }
-            Vector negative_gradient = -state->gradient;
-            Vector projected_gradient_step(x.size());
-            if (!problem.Plus(x.data(),
-                              negative_gradient.data(),
-                              projected_gradient_step.data())) {
-                *message = "projected_gradient_step = Plus(x, -gradient) failed.";
+            if (!evaluator->Evaluate(x.data(), &(state->cost))) {
+                *message = "Cost evaluation failed.";
                 return false;
             }
-
-            state->gradient_squared_norm = (x - projected_gradient_step).squaredNorm();
-            state->gradient_max_norm =
-                    (x - projected_gradient_step).lpNorm<Eigen::Infinity>();
             return true;
         }
 
+        /**
+         * @brief Aborts a local minimization whose cost is above a limit once it had its grace iterations.
+         */
+        class AbortCallback : public ceres::IterationCallback {
+        public:
+            AbortCallback(int grace_iterations, double max_cost)
+                    : grace_iterations_(grace_iterations),
+                      max_cost_(max_cost),
+                      aborted_(false) {}
+
+            virtual ~AbortCallback() {}
+
+            virtual ceres::CallbackReturnType operator()(const ceres::IterationSummary& summary) {
+                if (summary.iteration >= grace_iterations_ && summary.cost > max_cost_) {
+                    aborted_ = true;
+                    return ceres::SOLVER_ABORT;
+                }
+                return ceres::SOLVER_CONTINUE;
+            }
+
+            bool aborted() const { return aborted_; }
+
+        private:
+            int grace_iterations_;
+            double max_cost_;
+            bool aborted_;
+        };
+
     }  // namespace
 
     Basinhopping::Summary::Summary()
@@ -76,9 +97,23 @@ namespace pallas {
               initial_cost(-1.0),
               final_cost(-1.0),
               num_parameters(0),
+              seed(-1),
               num_iterations(0),
+              num_local_minimizer_iterations(0),
+              num_parallel_hops(1),
+              num_discarded_hops(0),
+              num_minima_database_hits(0),
+              num_minima_database_misses(0),
+              num_known_minima(0),
+              num_aborted_local_minimizations(0),
+              num_cost_evaluations(0),
+              num_gradient_evaluations(0),
+              num_local_cost_evaluations(0),
+              num_local_gradient_evaluations(0),
               total_time_in_seconds(0.0),
               local_minimization_time_in_seconds(0.0),
+              aborted_local_minimization_time_in_seconds(0.0),
+              saved_local_minimization_time_in_seconds(0.0),
               step_time_in_seconds(0.0),
               cost_evaluation_time_in_seconds(0.0) {
 
@@ -108,6 +143,9 @@ namespace pallas {
         StringAppendF(&report, "Line search direction     %19s\n",
                       line_search_direction_string.c_str());
 
+        StringAppendF(&report, "Parallel hops       %25d\n", num_parallel_hops);
+        StringAppendF(&report, "Seed                %25d\n", seed);
+
         StringAppendF(&report, "\nCost:\n");
         StringAppendF(&report, "  Initial        %28e\n", initial_cost);
         if (termination_type != TerminationType::FAILURE &&
@@ -119,6 +157,40 @@ namespace pallas {
 
         StringAppendF(&report, "\nMinimizer iterations         %16d\n",
                       num_iterations);
+        StringAppendF(&report, "Local minimizer iterations   %16d\n",
+                      num_local_minimizer_iterations);
+
+        if (num_parallel_hops > 1) {
+            StringAppendF(&report, "Discarded hops               %16d\n",
+                          num_discarded_hops);
+        }
+
+        if (num_known_minima > 0) {
+            StringAppendF(&report, "\nMinima database:\n");
+            StringAppendF(&report, "  Hits           %28d\n",
+                          num_minima_database_hits);
+            StringAppendF(&report, "  Misses         %28d\n",
+                          num_minima_database_misses);
+            StringAppendF(&report, "  Known minima   %28d\n",
+                          num_known_minima);
+        }
+
+        if (num_aborted_local_minimizations > 0) {
+            StringAppendF(&report, "\nAborted local minimizations  %16d\n",
+                          num_aborted_local_minimizations);
+        }
+
+        StringAppendF(&report, "\nEvaluations (outside local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_gradient_evaluations));
+
+        StringAppendF(&report, "\nEvaluations (in local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_local_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_local_gradient_evaluations));
 
         StringAppendF(&report, "\nTime (in seconds):\n");
 
@@ -128,6 +200,13 @@ namespace pallas {
         StringAppendF(&report, "  Local minimization   %22.4f\n",
                       local_minimization_time_in_seconds);
 
+        if (num_aborted_local_minimizations > 0) {
+            StringAppendF(&report, "    Aborted            %22.4f\n",
+                          aborted_local_minimization_time_in_seconds);
+            StringAppendF(&report, "    Saved (estimated)  %22.4f\n",
+                          saved_local_minimization_time_in_seconds);
+        }
+
         StringAppendF(&report, "  Step function   %27.4f\n",
                       step_time_in_seconds);
 
@@ -147,7 +226,18 @@ namespace pallas {
         double start_time = WallTimeInSeconds();
         double t1;
 
+        if (options.history_ring != NULL)
+            options.history_ring->Clear();
+
+        // GradientLocalMinimizer can not enforce the bounds of a BoundedStepFunction, the pallas minimizer can
+        lower_bounds_ = problem.parameterization() == NULL ? options.step_function->lower_bounds() : NULL;
+        upper_bounds_ = problem.parameterization() == NULL ? options.step_function->upper_bounds() : NULL;
+        const bool use_pallas_local_minimizer = options.local_minimizer_type == PALLAS_LOCAL_MINIMIZER ||
+                                                lower_bounds_ != NULL;
+
         global_summary->line_search_direction_type =
+                use_pallas_local_minimizer ?
+                internal::LineSearchMinimizer::DirectionType(options.local_minimizer_options.line_search_direction_type) :
                 options.local_minimizer_options.line_search_direction_type;
 
         bool is_not_silent = !options.is_silent;
@@ -155,21 +245,57 @@ namespace pallas {
         bool accept;
         num_iterations_ = 0;
         num_stagnant_iterations_ = 0;
+        local_minimization_counter_ = internal::LocalMinimizationCounter();
+        num_discarded_hops_ = 0;
+        num_minima_database_hits_ = 0;
+        num_minima_database_misses_ = 0;
+        num_aborted_local_minimizations_ = 0;
+        num_completed_local_minimizations_ = 0;
+        aborted_time_in_seconds_ = 0.0;
+        completed_time_in_seconds_ = 0.0;
 
         const unsigned int num_parameters = static_cast<unsigned int>(problem.NumParameters());
         VectorRef x(parameters, num_parameters);
 
+        scoped_ptr<internal::MinimaDatabase> tmp_minima_database(
+                options.use_minima_database ? new internal::MinimaDatabase(num_parameters, options.minima_probe_radius) : NULL);
+        swap(minima_database_, tmp_minima_database);
+
+        const unsigned int num_parallel_hops = std::max(1u, options.num_parallel_hops);
+
         global_summary->num_parameters = num_parameters;
+        global_summary->num_parallel_hops = num_parallel_hops;
+
+        const int seed = internal::ResolveSeed(options.seed);
+        global_summary->seed = seed;
+        options.step_function->Seed(seed, 0);
+        metropolis_.seed(seed);
 
         current_state_ = internal::State(num_parameters);
         current_state_.x = x;
 
-        GradientLocalMinimizer::Summary local_summary;
+        scoped_ptr<internal::Evaluator> tmp_evaluator(new internal::Evaluator(problem));
+        swap(evaluator_, tmp_evaluator);
+
+        hop_outcomes_.resize(num_parallel_hops);
+        acceptance_thresholds_.resize(num_parallel_hops);
+        hop_max_costs_.resize(num_parallel_hops);
+        hop_times_.resize(num_parallel_hops);
+        hop_counters_.resize(num_parallel_hops);
+        hop_summaries_.resize(num_parallel_hops);
+        local_minimizers_.resize(use_pallas_local_minimizer ? num_parallel_hops : 0);
+        for (unsigned int i = 0; i < local_minimizers_.size(); ++i) {
+            if (!local_minimizers_[i])
+                local_minimizers_[i].reset(new internal::LineSearchMinimizer());
+        }
+
+        // the summary of the first hop of each round is reused for the local minimizations outside the rounds
+        GradientLocalMinimizer::Summary& local_summary = hop_summaries_[0];
 
         // evaluate problem with initial parameters
-        if (!Evaluate(problem, current_state_.x, &current_state_, &global_summary->message)) {
+        if (!Evaluate(evaluator_.get(), current_state_.x, &current_state_, &global_summary->message)) {
             global_summary->termination_type = TerminationType::FAILURE;
-            global_summary->message = "Initial cost and jacobian evaluation failed. "
+            global_summary->message = "Initial cost evaluation failed. "
                                               "More details: " + global_summary->message;
             LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
             prepare_final_summary_(global_summary, local_summary);
@@ -180,11 +306,15 @@ namespace pallas {
 
         t1 = WallTimeInSeconds();
         // minimize problem with initial parameters
-        GradientLocalMinimizer local_minimizer;
-        local_minimizer.Solve(options.local_minimizer_options,
-                              problem,
-                              current_state_.x.data(),
-                              &local_summary);
+        if (!local_minimizers_.empty())
+            local_minimizers_[0]->ClearHistory();
+        run_local_minimizer_(options.local_minimizer_options,
+                             options.least_squares_minimizer_options,
+                             problem,
+                             0,
+                             current_state_.x.data(),
+                             &local_summary);
+        local_minimization_counter_.Add(local_summary);
 
         global_summary->local_minimization_time_in_seconds += WallTimeInSeconds() - t1;
 
@@ -201,9 +331,9 @@ namespace pallas {
         }
 
         t1 = WallTimeInSeconds();
-        if (!Evaluate(problem, current_state_.x, &current_state_, &global_summary->message)) {
+        if (!Evaluate(evaluator_.get(), current_state_.x, &current_state_, &global_summary->message)) {
             global_summary->termination_type = TerminationType::FAILURE;
-            global_summary->message = "Initial cost and jacobian evaluation failed. "
+            global_summary->message = "Initial cost evaluation failed. "
                                               "More details: " + global_summary->message;
             LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
             prepare_final_summary_(global_summary, local_summary);
@@ -216,8 +346,21 @@ namespace pallas {
         candidate_state_ = current_state_;
         global_minimum_state_ = current_state_;
 
+        if (minima_database_.get() != NULL)
+            minima_database_->Insert(current_state_.x.data(), current_state_.cost);
+
+        if (!local_minimizers_.empty() && options.warm_start_local_minimizer)
+            accepted_history_ = local_minimizers_[0]->history();
+
+        if (num_parallel_hops > 1) {
+            hops_.assign(num_parallel_hops, current_state_);
+            shared_problems_.clear();
+            for (unsigned int i = 0; i < num_parallel_hops; ++i)
+                shared_problems_.push_back(std::unique_ptr<GradientProblem>(internal::CreateSharedProblem(problem)));
+        }
+
         if (options.history_save_frequency > 0)
-            global_summary->history.push_back(HistoryOutput(num_iterations_, num_stagnant_iterations_, current_state_.x, global_minimum_state_.cost, global_minimum_state_.x));
+            internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, num_stagnant_iterations_, current_state_.x, global_minimum_state_.cost, global_minimum_state_.x);
 
         // check that initial minimization didn't satisfy termination conditions
         // before entering main loop
@@ -230,56 +373,87 @@ namespace pallas {
 
         // start main loop
         while (true) {
-            t1 = WallTimeInSeconds();
-            options.step_function->Step(candidate_state_.x.data(), num_parameters);
-            global_summary->step_time_in_seconds += WallTimeInSeconds() - t1;
-
-            t1 = WallTimeInSeconds();
-            GradientLocalMinimizer::Summary local_summary;
-            local_minimizer.Solve(options.local_minimizer_options,
-                                  problem,
-                                  candidate_state_.x.data(),
-                                  &local_summary);
-            global_summary->local_minimization_time_in_seconds += WallTimeInSeconds() - t1;
-
-            t1 = WallTimeInSeconds();
-            if (!Evaluate(problem, candidate_state_.x, &candidate_state_, &global_summary->message)) {
-                global_summary->termination_type = TerminationType::FAILURE;
-                global_summary->message = "Cost and jacobian evaluation failed. "
-                                                  "More details: " + global_summary->message;
-                LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
-                prepare_final_summary_(global_summary, local_summary);
-                return;
-            }
-            global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
-
-            accept = metropolis_(candidate_state_.cost, current_state_.cost);
-
-            if (accept) {
-                current_state_ = candidate_state_;
-                new_global_min = global_minimum_state_.update(current_state_);
-            }
-
-            if (new_global_min) {
-                num_stagnant_iterations_ = 0;
+            if (num_parallel_hops > 1) {
+                if (!hop_in_parallel_(options, global_summary)) {
+                    global_summary->termination_type = TerminationType::FAILURE;
+                    global_summary->message = "Cost evaluation failed. "
+                                                      "More details: " + global_summary->message;
+                    LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+                    prepare_final_summary_(global_summary, local_summary);
+                    return;
+                }
             } else {
-                ++num_stagnant_iterations_;
+                t1 = WallTimeInSeconds();
+                options.step_function->Step(candidate_state_.x.data(), num_parameters);
+                global_summary->step_time_in_seconds += WallTimeInSeconds() - t1;
+
+                prepare_hops_(options, 1);
+
+                t1 = WallTimeInSeconds();
+                hop_outcomes_[0] = minimize_hop_(options, problem, 0, &candidate_state_, &local_summary, &hop_counters_[0]);
+                hop_times_[0] = WallTimeInSeconds() - t1;
+                global_summary->local_minimization_time_in_seconds += hop_times_[0];
+
+                if (hop_outcomes_[0] == HOP_MINIMIZED) {
+                    t1 = WallTimeInSeconds();
+                    if (!Evaluate(evaluator_.get(), candidate_state_.x, &candidate_state_, &global_summary->message)) {
+                        global_summary->termination_type = TerminationType::FAILURE;
+                        global_summary->message = "Cost evaluation failed. "
+                                                          "More details: " + global_summary->message;
+                        LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+                        prepare_final_summary_(global_summary, local_summary);
+                        return;
+                    }
+                    global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+                }
+                record_hop_(0, candidate_state_);
             }
 
-            ++num_iterations_;
-
-            if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency == 0)
-                global_summary->history.push_back(HistoryOutput(num_iterations_, num_stagnant_iterations_, current_state_.x, global_minimum_state_.cost, global_minimum_state_.x));
-
-            if (check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
-                prepare_final_summary_(global_summary, local_summary);
-                if (internal::IsSolutionUsable(global_summary))
-                    x = global_minimum_state_.x;
-
-                if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency != 0)
-                    global_summary->history.push_back(HistoryOutput(num_iterations_, num_stagnant_iterations_, current_state_.x, global_minimum_state_.cost, global_minimum_state_.x));
-                global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
-                return;
+            // hops are tested in the order they were proposed. once one is accepted the
+            // remaining hops of the round started from a stale state and are discarded.
+            bool is_stale = false;
+            for (unsigned int i = 0; i < num_parallel_hops; ++i) {
+                internal::State& candidate = num_parallel_hops > 1 ? hops_[i] : candidate_state_;
+                const GradientLocalMinimizer::Summary& candidate_summary = hop_summaries_[i];
+
+                if (is_stale) {
+                    ++num_discarded_hops_;
+                    if (hop_outcomes_[i] != HOP_ABORTED && global_minimum_state_.update(candidate))
+                        num_stagnant_iterations_ = 0;
+                    continue;
+                }
+
+                accept = accept_hop_(options, i, candidate);
+
+                if (accept) {
+                    current_state_ = candidate;
+                    new_global_min = global_minimum_state_.update(current_state_);
+                    is_stale = true;
+                    if (!local_minimizers_.empty() && options.warm_start_local_minimizer)
+                        accepted_history_ = local_minimizers_[i]->history();
+                }
+
+                if (new_global_min) {
+                    num_stagnant_iterations_ = 0;
+                } else {
+                    ++num_stagnant_iterations_;
+                }
+
+                ++num_iterations_;
+
+                if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency == 0)
+                    internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, num_stagnant_iterations_, current_state_.x, global_minimum_state_.cost, global_minimum_state_.x);
+
+                if (check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
+                    prepare_final_summary_(global_summary, candidate_summary);
+                    if (internal::IsSolutionUsable(global_summary))
+                        x = global_minimum_state_.x;
+
+                    if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency != 0)
+                        internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, num_stagnant_iterations_, current_state_.x, global_minimum_state_.cost, global_minimum_state_.x);
+                    global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
+                    return;
+                }
             }
         }
 
@@ -288,6 +462,10 @@ namespace pallas {
     bool Basinhopping::check_for_termination_(const Basinhopping::Options &options,
                                               std::string *message,
                                               TerminationType *termination_type) {
+        if (!options.callbacks.empty() &&
+            internal::InvokeCallbacks(options.callbacks, iteration_summary_(), message, termination_type))
+            return true;
+
         if (global_minimum_state_.cost < options.minimum_cost) {
             *message = "Prescribed minimum cost reached.";
             *termination_type = TerminationType::USER_SUCCESS;
@@ -296,6 +474,10 @@ namespace pallas {
             *message = "Maximum number of iterations reached.";
             *termination_type = TerminationType::NO_CONVERGENCE;
             return true;
+        } else if (is_evaluation_budget_spent_(options)) {
+            *message = "Maximum number of function or gradient evaluations reached.";
+            *termination_type = TerminationType::NO_CONVERGENCE;
+            return true;
         } else if (num_stagnant_iterations_ >= options.max_stagnant_iterations) {
             *message = "Maximum number of stagnant iterations reached.";
             *termination_type = TerminationType::CONVERGENCE;
@@ -305,10 +487,214 @@ namespace pallas {
         return false;
     };
 
+    bool Basinhopping::is_evaluation_budget_spent_(const Basinhopping::Options& options) const {
+        return internal::IsEvaluationBudgetSpent(options.max_function_evaluations,
+                                                 options.max_gradient_evaluations,
+                                                 evaluator_->num_cost_evaluations() +
+                                                 local_minimization_counter_.num_cost_evaluations,
+                                                 evaluator_->num_gradient_evaluations() +
+                                                 local_minimization_counter_.num_gradient_evaluations);
+    };
+
+    IterationSummary Basinhopping::iteration_summary_() const {
+        IterationSummary summary(BASINHOPPING,
+                                 num_iterations_,
+                                 static_cast<int>(current_state_.x.size()),
+                                 current_state_.cost,
+                                 current_state_.x.data(),
+                                 global_minimum_state_.cost,
+                                 global_minimum_state_.x.data());
+        summary.num_stagnant_iterations = num_stagnant_iterations_;
+        return summary;
+    };
+
+    bool Basinhopping::hop_in_parallel_(const Basinhopping::Options& options,
+                                        Basinhopping::Summary* global_summary) {
+        const unsigned int num_parameters = static_cast<unsigned int>(current_state_.x.size());
+        const int num_hops = static_cast<int>(hops_.size());
+        double t1;
+
+        t1 = WallTimeInSeconds();
+        for (int i = 0; i < num_hops; ++i) {
+            hops_[i].x = current_state_.x;
+            options.step_function->Step(hops_[i].x.data(), num_parameters);
+        }
+        global_summary->step_time_in_seconds += WallTimeInSeconds() - t1;
+
+        // the current state does not change before the first hop is accepted and the hops after it are
+        // discarded, so the thresholds of every hop that is tested can be drawn up front.
+        prepare_hops_(options, num_hops);
+
+        t1 = WallTimeInSeconds();
+        internal::ParallelFor(num_hops, 0, num_hops, [&](int thread_id, int64_t i) {
+            const double start_time = WallTimeInSeconds();
+            hop_outcomes_[i] = minimize_hop_(options,
+                                             *shared_problems_[thread_id],
+                                             static_cast<unsigned int>(i),
+                                             &hops_[i],
+                                             &hop_summaries_[i],
+                                             &hop_counters_[i]);
+            hop_times_[i] = WallTimeInSeconds() - start_time;
+        });
+        global_summary->local_minimization_time_in_seconds += WallTimeInSeconds() - t1;
+
+        t1 = WallTimeInSeconds();
+        for (int i = 0; i < num_hops; ++i) {
+            if (hop_outcomes_[i] == HOP_MINIMIZED &&
+                !Evaluate(evaluator_.get(), hops_[i].x, &hops_[i], &global_summary->message))
+                return false;
+        }
+        global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+
+        // the database is only written once all concurrent lookups are done
+        for (int i = 0; i < num_hops; ++i)
+            record_hop_(i, hops_[i]);
+        return true;
+    };
+
+    void Basinhopping::prepare_hops_(const Basinhopping::Options& options, unsigned int num_hops) {
+        const double max_cost = global_minimum_state_.cost + options.abort_margin;
+        for (unsigned int i = 0; i < num_hops; ++i) {
+            hop_max_costs_[i] = max_cost;
+            if (options.abort_unacceptable_minimizations) {
+                acceptance_thresholds_[i] = metropolis_.acceptance_threshold(current_state_.cost);
+                hop_max_costs_[i] = std::min(max_cost, acceptance_thresholds_[i]);
+            }
+        }
+    };
+
+    bool Basinhopping::accept_hop_(const Basinhopping::Options& options,
+                                   unsigned int i,
+                                   const internal::State& hop) {
+        if (hop_outcomes_[i] == HOP_ABORTED)
+            return false;
+        if (options.abort_unacceptable_minimizations)
+            return hop.cost <= acceptance_thresholds_[i];
+        return metropolis_(hop.cost, current_state_.cost);
+    };
+
+    Basinhopping::HopOutcome Basinhopping::minimize_hop_(const Basinhopping::Options& options,
+                                                         const GradientProblem& problem,
+                                                         unsigned int i,
+                                                         internal::State* hop,
+                                                         GradientLocalMinimizer::Summary* local_summary,
+                                                         internal::LocalMinimizationCounter* hop_counter) const {
+        GradientLocalMinimizer::Options local_minimizer_options = options.local_minimizer_options;
+        LeastSquaresLocalMinimizer::Options least_squares_options = options.least_squares_minimizer_options;
+        AbortCallback abort_callback(options.abort_grace_iterations, hop_max_costs_[i]);
+        if (hop_max_costs_[i] < DBL_MAX) {
+            local_minimizer_options.callbacks.push_back(&abort_callback);
+            least_squares_options.callbacks.push_back(&abort_callback);
+        }
+
+        if (!local_minimizers_.empty()) {
+            if (options.warm_start_local_minimizer)
+                local_minimizers_[i]->set_history(accepted_history_);
+            else
+                local_minimizers_[i]->ClearHistory();
+        }
+
+        if (minima_database_.get() == NULL) {
+            run_local_minimizer_(local_minimizer_options, least_squares_options,
+                                 problem, i, hop->x.data(), local_summary);
+            *hop_counter = internal::LocalMinimizationCounter();
+            hop_counter->Add(*local_summary);
+            return abort_callback.aborted() ? HOP_ABORTED : HOP_MINIMIZED;
+        }
+
+        GradientLocalMinimizer::Options probe_options = local_minimizer_options;
+        probe_options.max_num_iterations = std::min(probe_options.max_num_iterations,
+                                                     options.minima_probe_iterations);
+        LeastSquaresLocalMinimizer::Options least_squares_probe_options = least_squares_options;
+        least_squares_probe_options.max_num_iterations = std::min(least_squares_probe_options.max_num_iterations,
+                                                                   options.minima_probe_iterations);
+        run_local_minimizer_(probe_options, least_squares_probe_options, problem, i, hop->x.data(), local_summary);
+        *hop_counter = internal::LocalMinimizationCounter();
+        hop_counter->Add(*local_summary);
+        if (abort_callback.aborted())
+            return HOP_ABORTED;
+
+        const int known_minimum = minima_database_->Find(hop->x.data());
+        if (known_minimum >= 0) {
+            hop->x = ConstVectorRef(minima_database_->minimum(known_minimum), hop->x.size());
+            hop->cost = minima_database_->cost(known_minimum);
+            return HOP_KNOWN_MINIMUM;
+        }
+
+        // the probe stopped on its iteration limit, finish the minimization from where it left off
+        if (local_summary->termination_type == TerminationType::NO_CONVERGENCE) {
+            run_local_minimizer_(local_minimizer_options, least_squares_options,
+                                 problem, i, hop->x.data(), local_summary);
+            hop_counter->Add(*local_summary);
+            if (abort_callback.aborted())
+                return HOP_ABORTED;
+        }
+        return HOP_MINIMIZED;
+    };
+
+    void Basinhopping::run_local_minimizer_(const GradientLocalMinimizer::Options& local_minimizer_options,
+                                            const LeastSquaresLocalMinimizer::Options& least_squares_options,
+                                            const GradientProblem& problem,
+                                            unsigned int i,
+                                            double* parameters,
+                                            GradientLocalMinimizer::Summary* local_summary) const {
+        if (problem.cost_function_type() == LEAST_SQUARES) {
+            internal::MinimizeLeastSquares(least_squares_options, problem, lower_bounds_, upper_bounds_,
+                                           parameters, local_summary);
+        } else if (local_minimizers_.empty()) {
+            GradientLocalMinimizer local_minimizer;
+            local_minimizer.Solve(local_minimizer_options, problem, parameters, local_summary);
+        } else {
+            local_minimizers_[i]->set_bounds(lower_bounds_, upper_bounds_);
+            local_minimizers_[i]->Minimize(local_minimizer_options, problem, parameters, local_summary);
+        }
+    };
+
+    void Basinhopping::record_hop_(unsigned int i, const internal::State& hop) {
+        local_minimization_counter_.Add(hop_counters_[i]);
+
+        if (hop_outcomes_[i] == HOP_ABORTED) {
+            ++num_aborted_local_minimizations_;
+            aborted_time_in_seconds_ += hop_times_[i];
+            return;
+        }
+
+        if (hop_outcomes_[i] == HOP_MINIMIZED) {
+            ++num_completed_local_minimizations_;
+            completed_time_in_seconds_ += hop_times_[i];
+        }
+
+        if (minima_database_.get() == NULL)
+            return;
+
+        if (hop_outcomes_[i] == HOP_KNOWN_MINIMUM) {
+            ++num_minima_database_hits_;
+        } else {
+            ++num_minima_database_misses_;
+            minima_database_->Insert(hop.x.data(), hop.cost);
+        }
+    };
+
     void Basinhopping::prepare_final_summary_(Basinhopping::Summary *global_summary,
                                               const GradientLocalMinimizer::Summary &local_summary) {
         global_summary->final_cost = global_minimum_state_.cost;
         global_summary->num_iterations = num_iterations_;
+        global_summary->num_local_minimizer_iterations = local_minimization_counter_.num_iterations;
+        global_summary->num_local_cost_evaluations = local_minimization_counter_.num_cost_evaluations;
+        global_summary->num_local_gradient_evaluations = local_minimization_counter_.num_gradient_evaluations;
+        global_summary->num_discarded_hops = num_discarded_hops_;
+        global_summary->num_minima_database_hits = num_minima_database_hits_;
+        global_summary->num_minima_database_misses = num_minima_database_misses_;
+        global_summary->num_known_minima = minima_database_.get() != NULL ? minima_database_->size() : 0;
+        global_summary->num_aborted_local_minimizations = num_aborted_local_minimizations_;
+        global_summary->aborted_local_minimization_time_in_seconds = aborted_time_in_seconds_;
+        if (num_completed_local_minimizations_ > 0) {
+            const double mean_completed_time = completed_time_in_seconds_ / num_completed_local_minimizations_;
+            global_summary->saved_local_minimization_time_in_seconds =
+                    std::max(0.0, num_aborted_local_minimizations_ * mean_completed_time - aborted_time_in_seconds_);
+        }
+        global_summary->num_cost_evaluations = evaluator_->num_cost_evaluations();
+        global_summary->num_gradient_evaluations = evaluator_->num_gradient_evaluations();
         global_summary->local_minimization_summary = local_summary;
     }
 
@@ -346,4 +732,16 @@ namespace pallas {
         writer.EndArray();
         writer.EndObject();
     }
+
+    void dump(const Basinhopping::HistoryOutput &h, BinaryHistoryWriter& writer) {
+        writer.StartRecord(BASINHOPPING,
+                           static_cast<unsigned int>(h.best_solution.size()),
+                           1);
+        writer.Uint("iteration_number", h.iteration_number);
+        writer.Uint("stagnant_iterations", h.stagnant_iterations);
+        writer.Doubles("current_solution", h.current_solution.data(), h.current_solution.size());
+        writer.Double("best_cost", h.best_cost);
+        writer.Doubles("best_solution", h.best_solution.data(), h.best_solution.size());
+        writer.EndRecord();
+    }
 } // namespace pallas
@@ -0,0 +1,320 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include "pallas/binary_history.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "glog/logging.h"
+
+namespace pallas {
+    using std::string;
+
+    namespace {
+        const char kMagic[8] = {'P', 'A', 'L', 'L', 'A', 'S', 'H', 'B'};
+        const uint32_t kVersion = 1;
+        const std::size_t kHeaderSize = 40;
+        const std::size_t kColumnSize = 48;
+        const std::size_t kColumnNameSize = 32;
+        const std::size_t kValueSize = 8;
+
+        uint32_t ReadUint32(const char* bytes) {
+            const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes);
+            return static_cast<uint32_t>(b[0]) | static_cast<uint32_t>(b[1]) << 8 |
+                   static_cast<uint32_t>(b[2]) << 16 | static_cast<uint32_t>(b[3]) << 24;
+        }
+
+        uint64_t ReadUint64(const char* bytes) {
+            return static_cast<uint64_t>(ReadUint32(bytes)) | static_cast<uint64_t>(ReadUint32(bytes + 4)) << 32;
+        }
+
+        bool IsLittleEndian() {
+            const uint32_t one = 1;
+            char first_byte;
+            std::memcpy(&first_byte, &one, 1);
+            return first_byte == 1;
+        }
+    } // namespace
+
+    BinaryHistoryWriter::BinaryHistoryWriter()
+            : solver_type_(BASINHOPPING),
+              num_parameters_(0),
+              num_candidates_(0),
+              num_record_columns_(0),
+              has_header_(false),
+              is_record_valid_(false) {
+    }
+
+    void BinaryHistoryWriter::StartRecord(SolverType solver_type,
+                                          unsigned int num_parameters,
+                                          unsigned int num_candidates) {
+        record_.clear();
+        num_record_columns_ = 0;
+        if (!has_header_) {
+            solver_type_ = solver_type;
+            num_parameters_ = num_parameters;
+            num_candidates_ = num_candidates;
+            columns_.clear();
+            is_record_valid_ = true;
+        } else {
+            is_record_valid_ = solver_type == solver_type_ &&
+                               num_parameters == num_parameters_ &&
+                               num_candidates == num_candidates_;
+        }
+    }
+
+    void BinaryHistoryWriter::Uint(const char* name, uint64_t value) {
+        add_column_(name, UINT64_COLUMN, 1);
+        append_uint64_(value, &record_);
+    }
+
+    void BinaryHistoryWriter::Double(const char* name, double value) {
+        Doubles(name, &value, 1);
+    }
+
+    void BinaryHistoryWriter::Doubles(const char* name, const double* values, std::size_t num_values) {
+        add_column_(name, DOUBLE_COLUMN, num_values);
+        for (std::size_t i = 0; i < num_values; ++i) {
+            uint64_t bits;
+            std::memcpy(&bits, values + i, kValueSize);
+            append_uint64_(bits, &record_);
+        }
+    }
+
+    bool BinaryHistoryWriter::EndRecord() {
+        is_record_valid_ = is_record_valid_ && num_record_columns_ == columns_.size();
+        if (!is_record_valid_)
+            return false;
+
+        if (!has_header_) {
+            buffer_.append(kMagic, sizeof(kMagic));
+            append_uint32_(kVersion, &buffer_);
+            append_uint32_(static_cast<uint32_t>(solver_type_), &buffer_);
+            append_uint32_(num_parameters_, &buffer_);
+            append_uint32_(num_candidates_, &buffer_);
+            append_uint32_(static_cast<uint32_t>(columns_.size()), &buffer_);
+            append_uint32_(0, &buffer_);
+            append_uint64_(record_.size(), &buffer_);
+            for (size_t i = 0; i < columns_.size(); ++i) {
+                string name = columns_[i].name;
+                name.resize(kColumnNameSize, '\0');
+                buffer_.append(name);
+                append_uint32_(static_cast<uint32_t>(columns_[i].type), &buffer_);
+                append_uint32_(0, &buffer_);
+                append_uint64_(columns_[i].num_values, &buffer_);
+            }
+            has_header_ = true;
+        }
+        buffer_.append(record_);
+        return true;
+    }
+
+    void BinaryHistoryWriter::add_column_(const char* name, ColumnType type, uint64_t num_values) {
+        const std::size_t name_length = std::min(std::strlen(name), kColumnNameSize - 1);
+        if (!has_header_ && is_record_valid_) {
+            Column column;
+            column.name.assign(name, name_length);
+            column.type = type;
+            column.num_values = num_values;
+            columns_.push_back(column);
+        } else if (is_record_valid_) {
+            is_record_valid_ = num_record_columns_ < columns_.size() &&
+                               columns_[num_record_columns_].name.compare(0, string::npos, name, name_length) == 0 &&
+                               columns_[num_record_columns_].type == type &&
+                               columns_[num_record_columns_].num_values == num_values;
+        }
+        ++num_record_columns_;
+    }
+
+    void BinaryHistoryWriter::append_uint32_(uint32_t value, string* bytes) {
+        for (int i = 0; i < 4; ++i)
+            bytes->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+
+    void BinaryHistoryWriter::append_uint64_(uint64_t value, string* bytes) {
+        for (int i = 0; i < 8; ++i)
+            bytes->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+
+    BinaryHistoryReader::BinaryHistoryReader()
+            : data_(NULL),
+              size_(0),
+              mapping_(NULL),
+              solver_type_(BASINHOPPING),
+              num_parameters_(0),
+              num_candidates_(0),
+              header_size_(0),
+              record_size_(0),
+              num_records_(0) {
+    }
+
+    BinaryHistoryReader::~BinaryHistoryReader() {
+        Close();
+    }
+
+    bool BinaryHistoryReader::Open(const string& filename, string* message) {
+        Close();
+        if (!IsLittleEndian()) {
+            *message = "Binary history files can only be read on little-endian hosts.";
+            return false;
+        }
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            *message = "Unable to open binary history file " + filename + ".";
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || static_cast<uint64_t>(file_size.QuadPart) < kHeaderSize) {
+            CloseHandle(file);
+            *message = "Binary history file " + filename + " is too small to hold a header.";
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        const void* view = mapping == NULL ? NULL : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL) {
+            if (mapping != NULL)
+                CloseHandle(mapping);
+            *message = "Unable to map binary history file " + filename + ".";
+            return false;
+        }
+        mapping_ = mapping;
+        data_ = static_cast<const char*>(view);
+        size_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+        const int file = open(filename.c_str(), O_RDONLY);
+        if (file < 0) {
+            *message = "Unable to open binary history file " + filename + ".";
+            return false;
+        }
+        struct stat file_status;
+        if (fstat(file, &file_status) != 0 || static_cast<uint64_t>(file_status.st_size) < kHeaderSize) {
+            close(file);
+            *message = "Binary history file " + filename + " is too small to hold a header.";
+            return false;
+        }
+        void* view = mmap(NULL, static_cast<std::size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (view == MAP_FAILED) {
+            *message = "Unable to map binary history file " + filename + ".";
+            return false;
+        }
+        data_ = static_cast<const char*>(view);
+        size_ = static_cast<std::size_t>(file_status.st_size);
+#endif
+
+        const uint32_t num_columns = ReadUint32(data_ + 24);
+        if (std::memcmp(data_, kMagic, sizeof(kMagic)) != 0 || ReadUint32(data_ + 8) != kVersion ||
+            num_columns > (size_ - kHeaderSize) / kColumnSize) {
+            Close();
+            *message = "File " + filename + " is not a version 1 binary history file.";
+            return false;
+        }
+
+        solver_type_ = static_cast<SolverType>(ReadUint32(data_ + 12));
+        num_parameters_ = ReadUint32(data_ + 16);
+        num_candidates_ = ReadUint32(data_ + 20);
+        record_size_ = ReadUint64(data_ + 32);
+        header_size_ = kHeaderSize + num_columns * kColumnSize;
+
+        std::size_t offset = 0;
+        columns_.resize(num_columns);
+        for (uint32_t i = 0; i < num_columns; ++i) {
+            const char* description = data_ + kHeaderSize + i * kColumnSize;
+            columns_[i].name.assign(description, strnlen(description, kColumnNameSize));
+            columns_[i].type = static_cast<BinaryHistoryWriter::ColumnType>(ReadUint32(description + kColumnNameSize));
+            columns_[i].num_values = ReadUint64(description + kColumnNameSize + 8);
+            columns_[i].offset = offset;
+            offset += columns_[i].num_values * kValueSize;
+        }
+        if (record_size_ == 0 || record_size_ != offset) {
+            Close();
+            *message = "The column descriptions of binary history file " + filename + " do not match its record size.";
+            return false;
+        }
+        num_records_ = (size_ - header_size_) / record_size_;
+        return true;
+    }
+
+    void BinaryHistoryReader::Close() {
+        if (data_ != NULL) {
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+            CloseHandle(static_cast<HANDLE>(mapping_));
+#else
+            munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+        data_ = NULL;
+        size_ = 0;
+        mapping_ = NULL;
+        columns_.clear();
+        header_size_ = 0;
+        record_size_ = 0;
+        num_records_ = 0;
+    }
+
+    int BinaryHistoryReader::FindColumn(const string& name) const {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (columns_[i].name == name)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    uint64_t BinaryHistoryReader::Uint(uint64_t record, int column) const {
+        CHECK(columns_[column].type == BinaryHistoryWriter::UINT64_COLUMN) << "Column " << columns_[column].name
+                                                                           << " does not hold unsigned integers.";
+        return ReadUint64(value_(record, column));
+    }
+
+    const double* BinaryHistoryReader::Doubles(uint64_t record, int column) const {
+        CHECK(columns_[column].type == BinaryHistoryWriter::DOUBLE_COLUMN) << "Column " << columns_[column].name
+                                                                           << " does not hold doubles.";
+        return reinterpret_cast<const double*>(value_(record, column));
+    }
+
+    const char* BinaryHistoryReader::value_(uint64_t record, int column) const {
+        CHECK(record < num_records_) << "Record " << record << " is out of range, the file holds "
+                                     << num_records_ << " records.";
+        CHECK(column >= 0 && column < NumColumns()) << "Column " << column << " is out of range.";
+        return data_ + header_size_ + record * record_size_ + columns_[column].offset;
+    }
+
+} // namespace pallas
@@ -24,8 +24,16 @@
 //
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
+#include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <mutex>
 #include "pallas/brute.h"
+#include "pallas/binary_history.h"
+#include "pallas/internal/evaluator.h"
+#include "pallas/internal/grid_decoder.h"
+#include "pallas/internal/line_search_minimizer.h"
+#include "pallas/internal/parallel_for.h"
 #include "pallas/internal/state.h"
 #include "pallas/internal/solver_utils.h"
 #include "pallas/internal/stringprintf.h"
@@ -41,16 +49,22 @@ namespace pallas {
 
     namespace {
 
-        bool Evaluate(const GradientProblem &problem,
-                      Vector &x,
-                      internal::State *state,
-                      std::string *message) {
-            if(!problem.Evaluate(x.data(), &(state->cost), state->gradient.data())) {
-                *message = "Problem evaluation failed.";
-                return false;
+        /**
+         * @brief Result of searching a contiguous range of grid indices.
+         */
+        struct ChunkResult {
+            ChunkResult(unsigned int num_parameters, unsigned int recent_history_capacity)
+                    : minimum(num_parameters),
+                      recent_history(recent_history_capacity),
+                      succeeded(true) {
+                minimum.cost = DBL_MAX;
             }
-            return true;
-        }
+
+            internal::State minimum;/**<Lowest cost point of the range. The lowest index wins ties.*/
+            std::vector<Brute::HistoryOutput> history;/**<History records of the range. The best solution only covers the range itself.*/
+            HistoryRing<Brute::HistoryOutput> recent_history;/**<Last history records of the range, used in place of `history` when only a history ring is set.*/
+            bool succeeded;/**<Whether every point in the range was evaluated successfully.*/
+        };
 
     } // namespace
 
@@ -59,11 +73,16 @@ namespace pallas {
               message("pallas::Brute was not called."),
               final_cost(-1.0),
               num_parameters(0),
+              num_threads(1),
               num_iterations(0),
+              num_cost_evaluations(0),
+              num_gradient_evaluations(0),
+              num_local_cost_evaluations(0),
+              num_local_gradient_evaluations(0),
               total_time_in_seconds(0.0),
               local_minimization_time_in_seconds(0.0),
-              cost_evaluation_time_in_seconds(0.0),
               permutation_build_time_in_seconds(0.0),
+              cost_evaluation_time_in_seconds(0.0),
               was_polished(false){
 
     };
@@ -71,10 +90,10 @@ namespace pallas {
     std::string Brute::Summary::BriefReport() const {
         return StringPrintf(
                 "Pallas brute report: "
-                        "iterations: %d, "
+                        "iterations: %llu, "
                         "final cost: %e, "
                         "termination: %s\n",
-                num_iterations,
+                static_cast<unsigned long long>(num_iterations),
                 final_cost,
                 TerminationTypeToString(termination_type));
     };
@@ -85,6 +104,8 @@ namespace pallas {
 
         StringAppendF(&report, "Parameters          %25d\n", num_parameters);
 
+        StringAppendF(&report, "Threads             %25d\n", num_threads);
+
         StringAppendF(&report, "\n");
 
         if (termination_type != TerminationType::FAILURE &&
@@ -92,8 +113,20 @@ namespace pallas {
             StringAppendF(&report, "Final cost          %25e\n", final_cost);
         }
 
-        StringAppendF(&report, "\nTotal iterations         %20d\n",
-                      num_iterations);
+        StringAppendF(&report, "\nTotal iterations         %20llu\n",
+                      static_cast<unsigned long long>(num_iterations));
+
+        StringAppendF(&report, "\nEvaluations (outside local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_gradient_evaluations));
+
+        StringAppendF(&report, "\nEvaluations (in local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_local_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_local_gradient_evaluations));
 
         StringAppendF(&report, "\nTime (in seconds):\n");
 
@@ -131,49 +164,206 @@ namespace pallas {
         VectorRef x(parameters, num_parameters);
 
         t1 = WallTimeInSeconds();
-        std::vector<Vector> expanded_ranges = expand_parameter_ranges_(parameter_ranges);
-
-        std::vector<Vector> permutations = build_permutations_(expanded_ranges);
+        CHECK(parameter_ranges.size() == num_parameters) << "Number of parameter ranges " << parameter_ranges.size()
+                                                         << " does not match the number of parameters.";
+        const internal::GridDecoder grid(expand_parameter_ranges_(parameter_ranges));
         global_summary->permutation_build_time_in_seconds = WallTimeInSeconds() - t1;
 
+        // a budget smaller than the grid limits the search to its first points, in grid order, so the points that
+        // are searched do not depend on the number of threads
+        const uint64_t num_points = std::min(grid.NumPoints(),
+                                             static_cast<uint64_t>(std::max<int64_t>(1, options.max_function_evaluations)));
+        const bool is_grid_truncated = num_points < grid.NumPoints();
+
         global_summary->num_parameters = num_parameters;
-        global_summary->num_iterations = static_cast<unsigned int>(permutations.size());
+        global_summary->num_iterations = num_points;
+
+        const uint64_t batch_size = std::max(1u, options.batch_size);
+        const int num_chunks = static_cast<int>(std::min(static_cast<uint64_t>(std::max(1, options.num_threads)),
+                                                         num_points));
+        global_summary->num_threads = num_chunks;
+
+        // the history outputs of a chunk only know their running best cost once the chunks before it have been
+        // reduced. With a sink the grid is therefore searched in rounds that each keep at most
+        // `max_streamed_outputs_per_chunk` outputs per chunk before they are handed over, so the memory used does
+        // not grow with the size of the grid.
+        const uint64_t max_streamed_outputs_per_chunk = 1024;
+        const bool stream_in_rounds = num_chunks > 1 && options.history_sink != NULL && options.history_save_frequency > 0;
+        uint64_t round_size = num_points;
+        if (stream_in_rounds) {
+            const uint64_t chunk_round_size = max_streamed_outputs_per_chunk * options.history_save_frequency;
+            round_size = std::min(num_points, num_chunks * ((chunk_round_size + batch_size - 1) / batch_size) * batch_size);
+        }
+
+        internal::Evaluator evaluator(problem);
+
+        // each chunk is a contiguous range of grid indices searched by one thread. When the history only goes to a
+        // ring, a chunk never needs to keep more records than fit in it.
+        const bool keep_recent_history = num_chunks > 1 && options.history_ring != NULL && options.history_sink == NULL;
+        const unsigned int recent_history_capacity = keep_recent_history ? options.history_ring->Capacity() : 0;
+        std::vector<ChunkResult> chunks(num_chunks, ChunkResult(num_parameters, recent_history_capacity));
+        if (options.history_ring != NULL)
+            options.history_ring->Clear();
+
+        // the callbacks are called for one point at a time and see the best point evaluated so far by any chunk
+        std::mutex callback_mutex;
+        std::atomic<bool> is_stopped_by_callback(false);
+        std::string callback_message;
+        TerminationType callback_termination_type = TerminationType::USER_SUCCESS;
+        internal::State callback_minimum(num_parameters);
+        callback_minimum.cost = DBL_MAX;
 
-        internal::State current_state(num_parameters);
         internal::State global_minimum_state(num_parameters);
         global_minimum_state.cost = DBL_MAX;
 
         t1 = WallTimeInSeconds();
-        for (unsigned int i = 0; i < permutations.size(); ++i) {
-            current_state.x = permutations[i];
-            if (!Evaluate(problem, current_state.x, &current_state, &global_summary->message)) {
-                global_summary->termination_type = TerminationType::FAILURE;
-                global_summary->message = "Initial cost and jacobian evaluation failed. "
-                                                  "More details: " + global_summary->message;
-                LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
-                return;
+        for (uint64_t round_start = 0; round_start < num_points && !is_stopped_by_callback; round_start += round_size) {
+            const uint64_t round_end = std::min(num_points, round_start + round_size);
+            const uint64_t chunk_size = (round_end - round_start + num_chunks - 1) / num_chunks;
+
+            internal::ParallelFor(num_chunks, 0, num_chunks, [&](int /*thread_id*/, int64_t c) {
+                ChunkResult& chunk = chunks[c];
+                const uint64_t chunk_start = std::min(round_end, round_start + static_cast<uint64_t>(c) * chunk_size);
+                const uint64_t chunk_end = std::min(round_end, chunk_start + chunk_size);
+                if (chunk_start == chunk_end)
+                    return;
+
+                Matrix batch(num_parameters, static_cast<int>(std::min(batch_size, chunk_end - chunk_start)));
+                Vector batch_costs(batch.cols());
+                Eigen::VectorXi grid_counters(num_parameters);
+
+                for (uint64_t batch_start = chunk_start; batch_start < chunk_end; batch_start += batch_size) {
+                    if (is_stopped_by_callback)
+                        return;
+
+                    const int num_candidates = static_cast<int>(std::min(batch_size, chunk_end - batch_start));
+                    grid.DecodeRange(batch_start, num_candidates, batch.data(), grid_counters.data());
+
+                    if (!evaluator.EvaluateBatch(num_candidates, batch.data(), 1, batch_costs.data())) {
+                        chunk.succeeded = false;
+                        return;
+                    }
+
+                    for (int j = 0; j < num_candidates; ++j) {
+                        const uint64_t i = batch_start + j;
+                        if (batch_costs[j] < chunk.minimum.cost) {
+                            chunk.minimum.cost = batch_costs[j];
+                            chunk.minimum.x = batch.col(j);
+                        }
+
+                        if (options.history_save_frequency > 0 && i % options.history_save_frequency == 0) {
+                            // a single chunk needs no reduction, so its outputs can be saved straight away
+                            if (num_chunks == 1)
+                                internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history,
+                                                      i, batch.col(j), chunk.minimum.cost, chunk.minimum.x);
+                            else if (keep_recent_history)
+                                chunk.recent_history.Record(i, batch.col(j), chunk.minimum.cost, chunk.minimum.x);
+                            else
+                                chunk.history.push_back(HistoryOutput(i, batch.col(j), chunk.minimum.cost, chunk.minimum.x));
+                        }
+
+                        if (!options.callbacks.empty()) {
+                            std::lock_guard<std::mutex> lock(callback_mutex);
+                            if (is_stopped_by_callback)
+                                return;
+                            if (batch_costs[j] < callback_minimum.cost) {
+                                callback_minimum.cost = batch_costs[j];
+                                callback_minimum.x = batch.col(j);
+                            }
+                            const IterationSummary summary(BRUTE, i, num_parameters, batch_costs[j], batch.col(j).data(),
+                                                           callback_minimum.cost, callback_minimum.x.data());
+                            if (internal::InvokeCallbacks(options.callbacks, summary, &callback_message, &callback_termination_type)) {
+                                is_stopped_by_callback = true;
+                                return;
+                            }
+                        }
+                    }
+                }
+            });
+            global_summary->num_cost_evaluations = evaluator.num_cost_evaluations();
+
+            for (int c = 0; c < num_chunks; ++c) {
+                if (!chunks[c].succeeded) {
+                    global_summary->termination_type = TerminationType::FAILURE;
+                    global_summary->message = "Initial cost evaluation failed. "
+                                                      "More details: Problem evaluation failed.";
+                    LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+                    return;
+                }
             }
-            global_minimum_state.update(current_state);
 
-            if (options.history_save_frequency > 0 && i % options.history_save_frequency == 0)
-                global_summary->history.push_back(HistoryOutput(i, current_state.x, global_minimum_state.cost, global_minimum_state.x));
+            // reduce the chunk minima in index order. A chunk only replaces the current minimum if it is strictly
+            // lower, so ties are resolved in favor of the lowest grid index regardless of the number of threads.
+            for (int c = 0; c < num_chunks; ++c) {
+                ChunkResult& chunk = chunks[c];
+                for (size_t k = 0; k < chunk.history.size(); ++k) {
+                    HistoryOutput& h = chunk.history[k];
+                    if (!(h.best_cost < global_minimum_state.cost)) {
+                        h.best_cost = global_minimum_state.cost;
+                        h.best_solution = global_minimum_state.x;
+                    }
+                    if (options.history_ring != NULL)
+                        options.history_ring->Record(h.iteration_number, h.current_solution, h.best_cost, h.best_solution);
+                    if (options.history_sink != NULL)
+                        options.history_sink->Append(std::move(h));
+                    else if (options.history_ring == NULL)
+                        global_summary->history.push_back(std::move(h));
+                }
+                chunk.history.clear();
+                for (unsigned int k = 0; k < chunk.recent_history.Size(); ++k) {
+                    const HistoryOutput& h = chunk.recent_history[k];
+                    const bool is_chunk_best = h.best_cost < global_minimum_state.cost;
+                    options.history_ring->Record(h.iteration_number,
+                                                 h.current_solution,
+                                                 is_chunk_best ? h.best_cost : global_minimum_state.cost,
+                                                 is_chunk_best ? h.best_solution : global_minimum_state.x);
+                }
+                chunk.recent_history.Clear();
+
+                if (chunk.minimum.cost < global_minimum_state.cost) {
+                    global_minimum_state.cost = chunk.minimum.cost;
+                    global_minimum_state.x = chunk.minimum.x;
+                }
+            }
         }
         global_summary->cost_evaluation_time_in_seconds = WallTimeInSeconds() - t1;
 
-        if(options.polish_output) {
+        if (is_stopped_by_callback && callback_termination_type == TerminationType::USER_FAILURE) {
+            global_summary->termination_type = callback_termination_type;
+            global_summary->message = callback_message;
+            global_summary->final_cost = global_minimum_state.cost;
+            LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+            global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
+            return;
+        }
+
+        const bool is_budget_spent = internal::IsEvaluationBudgetSpent(options.max_function_evaluations,
+                                                                       options.max_gradient_evaluations,
+                                                                       evaluator.num_cost_evaluations(),
+                                                                       evaluator.num_gradient_evaluations());
+        if(options.polish_output && !is_budget_spent) {
             t1 = WallTimeInSeconds();
-            GradientLocalMinimizer local_minimizer;
-            local_minimizer.Solve(options.local_minimizer_options,
-                                  problem,
-                                  global_minimum_state.x.data(),
-                                  &global_summary->local_minimization_summary);
+            internal::MinimizeLocally(options.local_minimizer_type,
+                                      options.local_minimizer_options,
+                                      options.least_squares_minimizer_options,
+                                      problem,
+                                      NULL,
+                                      NULL,
+                                      global_minimum_state.x.data(),
+                                      &global_summary->local_minimization_summary);
             global_summary->local_minimization_time_in_seconds = WallTimeInSeconds() - t1;
+            global_summary->num_local_cost_evaluations =
+                    std::max(0, global_summary->local_minimization_summary.num_cost_evaluations);
+            global_summary->num_local_gradient_evaluations =
+                    std::max(0, global_summary->local_minimization_summary.num_gradient_evaluations);
 
             t1 = WallTimeInSeconds();
-            if (!Evaluate(problem, global_minimum_state.x, &global_minimum_state, &global_summary->message)) {
+            const bool is_evaluated = evaluator.Evaluate(global_minimum_state.x.data(), &global_minimum_state.cost);
+            global_summary->num_cost_evaluations = evaluator.num_cost_evaluations();
+            if (!is_evaluated) {
                 global_summary->termination_type = TerminationType::FAILURE;
                 global_summary->message = "Cost evaluation of global minimum state failed after polishing step "
-                                                  "More details: " + global_summary->message;
+                                                  "More details: Problem evaluation failed.";
                 LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
                 return;
             }
@@ -181,8 +371,16 @@ namespace pallas {
             global_summary->was_polished = true;
         }
 
-        global_summary->message = "Specified search of parameter space successfully completed.";
-        global_summary->termination_type = TerminationType::USER_SUCCESS;
+        if (is_stopped_by_callback) {
+            global_summary->message = callback_message;
+            global_summary->termination_type = TerminationType::USER_SUCCESS;
+        } else if (is_grid_truncated) {
+            global_summary->message = "Maximum number of function or gradient evaluations reached.";
+            global_summary->termination_type = TerminationType::NO_CONVERGENCE;
+        } else {
+            global_summary->message = "Specified search of parameter space successfully completed.";
+            global_summary->termination_type = TerminationType::USER_SUCCESS;
+        }
         global_summary->final_cost = global_minimum_state.cost;
 
         x = global_minimum_state.x;
@@ -207,61 +405,6 @@ namespace pallas {
         return expanded_ranges;
     }
 
-    std::vector<Vector> Brute::build_permutations_(
-            const std::vector<Vector> &expanded_ranges) {
-
-        const unsigned int num_parameters = static_cast<unsigned int>(expanded_ranges.size());
-
-        Eigen::VectorXi cyclic_counter(num_parameters);
-        cyclic_counter.setZero();
-
-        unsigned int num_permutations = 1;
-
-        for (unsigned int i = 0; i < expanded_ranges.size(); ++i) {
-            num_permutations *= expanded_ranges[i].size();
-        }
-
-        std::vector<Vector> output;
-        output.resize(num_permutations);
-        for (unsigned int i = 0; i < num_permutations; ++i) {
-            output[i].resize(num_parameters);
-        }
-
-        unsigned int col_idx = num_parameters - 1;
-
-        Vector current_permutation(num_parameters);
-        for (unsigned int i = 0; i < num_parameters; ++i) {
-            current_permutation[i] = expanded_ranges[i][0];
-        }
-        output[0] = current_permutation;
-
-        bool completed_cycle = false;
-        for (unsigned int i = 1; i < num_permutations; ++i) {
-            ++cyclic_counter[col_idx];
-            cyclic_counter[col_idx] %= expanded_ranges[col_idx].size();
-
-            current_permutation[col_idx] = expanded_ranges[col_idx][cyclic_counter[col_idx]];
-
-            if (cyclic_counter[col_idx] == 0)
-                completed_cycle = true;
-
-            while (completed_cycle && i < num_permutations) {
-                for (unsigned int j = col_idx - 1; j>=0; --j) {
-                    ++cyclic_counter[j];
-                    cyclic_counter[j] %= expanded_ranges[j].size();
-
-                    current_permutation[j] = expanded_ranges[j][cyclic_counter[j]];
-                    if (cyclic_counter[j] != 0) {
-                        completed_cycle = false;
-                        break;
-                    }
-                }
-            }
-            output[i] = current_permutation;
-        }
-        return output;
-    };
-
     void Solve(const Brute::Options options,
                const GradientProblem& problem,
                const std::vector<Brute::ParameterRange> &parameter_ranges,
@@ -274,7 +417,7 @@ namespace pallas {
     void dump(const Brute::HistoryOutput &h, HistoryWriter& writer) {
         writer.StartObject();
         writer.String("iteration_number");
-        writer.Uint(h.iteration_number);
+        writer.Uint64(h.iteration_number);
 
         writer.String("current_solution");
         writer.StartArray();
@@ -295,4 +438,14 @@ namespace pallas {
         writer.EndObject();
     }
 
+    void dump(const Brute::HistoryOutput &h, BinaryHistoryWriter& writer) {
+        writer.StartRecord(BRUTE,
+                           static_cast<unsigned int>(h.best_solution.size()),
+                           1);
+        writer.Uint("iteration_number", h.iteration_number);
+        writer.Doubles("current_solution", h.current_solution.data(), h.current_solution.size());
+        writer.Double("best_cost", h.best_cost);
+        writer.Doubles("best_solution", h.best_solution.data(), h.best_solution.size());
+        writer.EndRecord();
+    }
 } // namespace pallas
@@ -24,7 +24,6 @@
 //
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
-#include <cfloat>
 #include <cmath>
 #include "glog/logging.h"
 #include "pallas/cooling_schedule.h"
@@ -64,23 +63,36 @@ namespace pallas {
     void CoolingSchedule::calc_start_temperature(const GradientProblem &problem,
                                                  internal::State& best_state,
                                                  StepFunction* step_function) {
-        double cost_max = DBL_MIN;
-        double cost_min = DBL_MAX;
+        internal::Evaluator evaluator(problem);
+        calc_start_temperature(&evaluator, best_state, step_function);
+    };
+
+    void CoolingSchedule::calc_start_temperature(internal::Evaluator* evaluator,
+                                                 internal::State& best_state,
+                                                 StepFunction* step_function) {
+        const unsigned int num_samples = 100;
         const unsigned int num_parameters = static_cast<unsigned int>(best_state.x.size());
-        internal::State state = best_state; 
-
-        for(unsigned int i = 0; i < 100; ++i) {
-            step_function->Step(state.x.data(), num_parameters);
-            if(!problem.Evaluate(state.x.data(), &state.cost, state.gradient.data())) {
-                LOG(ERROR) << "Problem evaluation failed at:\n" << state.x << "\n in CoolingSchedule::calc_start_temperature.";
-            }
-
-            if (state.cost > cost_max) cost_max = state.cost;
-            if (state.cost < cost_min) {
-                cost_min = state.cost;
-                best_state.update(state);
-            }
-        } 
+
+        Matrix samples(num_parameters, num_samples);
+        Vector sample_costs(num_samples);
+        Vector x = best_state.x;
+        for(unsigned int i = 0; i < num_samples; ++i) {
+            step_function->Step(x.data(), num_parameters);
+            samples.col(i) = x;
+        }
+
+        if(!evaluator->EvaluateBatch(num_samples, samples.data(), 1, sample_costs.data())) {
+            LOG(ERROR) << "Problem evaluation failed in CoolingSchedule::calc_start_temperature.";
+        }
+
+        Vector::Index min_idx;
+        const double cost_min = sample_costs.minCoeff(&min_idx);
+        const double cost_max = sample_costs.maxCoeff();
+
+        internal::State state = best_state;
+        state.x = samples.col(min_idx);
+        state.cost = cost_min;
+        best_state.update(state);
 
         initial_temperature = (cost_max - cost_min) * 1.2;
         temperature = initial_temperature;
@@ -25,10 +25,16 @@
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
 #include "pallas/differential_evolution.h"
+#include "pallas/binary_history.h"
+#include "pallas/internal/line_search_minimizer.h"
+#include "pallas/internal/parallel_for.h"
 #include "pallas/internal/solver_utils.h"
 #include "pallas/internal/stringprintf.h"
 #include "pallas/internal/wall_time.h"
 
+#include <algorithm>
+#include <mutex>
+
 #include "glog/logging.h"
 
 
@@ -44,13 +50,11 @@ namespace pallas {
 
     namespace {
 
-        bool Evaluate(const GradientProblem &problem,
-                      Vector &x,
+        bool Evaluate(internal::Evaluator* evaluator,
+                      const Eigen::Ref<const Vector> &x,
                       double *cost,
                       string *message) {
-            if (!problem.Evaluate(x.data(),
-                                  cost,
-                                  NULL)) {
+            if (!evaluator->Evaluate(x.data(), cost)) {
                 *message = "Problem evaluation failed";
                 return false;
             }
@@ -60,10 +64,20 @@ namespace pallas {
 
     DifferentialEvolution::Summary::Summary()
             : termination_type(TerminationType::FAILURE),
+              population_update(IMMEDIATE),
+              num_threads(1),
+              num_islands(1),
+              num_migrations(0),
+              worker_utilization(-1.0),
+              seed(-1),
               message("pallas::DifferentialEvolution was not called."),
               final_cost(-1.0),
               num_parameters(0),
               num_iterations(0),
+              num_cost_evaluations(0),
+              num_gradient_evaluations(0),
+              num_local_cost_evaluations(0),
+              num_local_gradient_evaluations(0),
               total_time_in_seconds(0.0),
               local_minimization_time_in_seconds(0.0),
               cost_evaluation_time_in_seconds(0.0),
@@ -93,6 +107,24 @@ namespace pallas {
         StringAppendF(&report, "Mutation strategy     %23s\n",
                       mutation_strategy_string.c_str());
 
+        string population_update_string = PopulationUpdateTypeToString(population_update);
+
+        StringAppendF(&report, "Population update     %23s\n",
+                      population_update_string.c_str());
+
+        StringAppendF(&report, "Threads             %25d\n", num_threads);
+
+        if (num_islands > 1) {
+            StringAppendF(&report, "Islands             %25d\n", num_islands);
+            StringAppendF(&report, "Migrations          %25d\n", num_migrations);
+        }
+
+        if (worker_utilization >= 0.0) {
+            StringAppendF(&report, "Worker utilization  %25.3f\n", worker_utilization);
+        }
+
+        StringAppendF(&report, "Seed                %25d\n", seed);
+
         if (termination_type != TerminationType::FAILURE &&
             termination_type != TerminationType::USER_FAILURE) {
             StringAppendF(&report, "\nFinal cost          %25e\n", final_cost);
@@ -101,6 +133,18 @@ namespace pallas {
         StringAppendF(&report, "\nMinimizer iterations         %16d\n",
                       num_iterations);
 
+        StringAppendF(&report, "\nEvaluations (outside local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_gradient_evaluations));
+
+        StringAppendF(&report, "\nEvaluations (in local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_local_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_local_gradient_evaluations));
+
         StringAppendF(&report, "\nTime (in seconds):\n");
 
         StringAppendF(&report, "  Cost evaluation     %23.4f\n",
@@ -123,8 +167,15 @@ namespace pallas {
                                       const GradientProblem& problem,
                                       double* parameters,
                                       DifferentialEvolution::Summary* global_summary) {
+        if (options.history_ring != NULL)
+            options.history_ring->Clear();
+
+        if (options.num_islands > 1) {
+            solve_islands_(options, problem, parameters, global_summary);
+            return;
+        }
+
         double start_time = WallTimeInSeconds();
-        double t1;
         bool is_not_silent = !options.is_silent;
 
         num_parameters_ = static_cast<unsigned int>(problem.NumParameters());
@@ -132,6 +183,9 @@ namespace pallas {
 
         init_member_variables_(options);
 
+        scoped_ptr<internal::Evaluator> tmp_evaluator(new internal::Evaluator(problem));
+        swap(evaluator_, tmp_evaluator);
+
         VectorRef x(parameters, num_parameters_);
 
         GradientLocalMinimizer::Summary local_summary;
@@ -139,147 +193,572 @@ namespace pallas {
         global_summary->mutation_strategy = options.mutation_strategy;
         global_summary->crossover_strategy = options.crossover_strategy;
 
-        std::vector<Vector> scaled_population;
+        PopulationUpdateType population_update = options.population_update;
+        if (options.num_threads > 1 && population_update == IMMEDIATE) {
+            LOG_IF(WARNING, is_not_silent) << "Evaluating a generation on " << options.num_threads
+                                           << " threads requires DEFERRED updating. Using DEFERRED updating.";
+            population_update = DEFERRED;
+        }
+        const int num_threads = std::max(1, options.num_threads);
+        global_summary->population_update = population_update;
+        global_summary->num_threads = num_threads;
+        global_summary->seed = seed_;
+
+        Matrix scaled_population;
         if (options.history_save_frequency > 0) {
-            scaled_population.resize(population_size_);
-            for (unsigned int i = 0; i < population_size_; ++i) {
-                scaled_population[i].resize(num_parameters_);
-            }
+            scaled_population.resize(num_parameters_, population_size_);
         }
 
-        Vector scaled_trial(num_parameters_);
-        t1 = WallTimeInSeconds();
-        for(unsigned int i = 0; i < population_energies_.size(); ++i) {
-            scale_parameters_(population_[i], scaled_trial);
-            if (!Evaluate(problem, scaled_trial, &(population_energies_[i]), &global_summary->message)) {
+        if (!evaluate_initial_population_(num_threads, global_summary)) {
+            global_summary->termination_type = TerminationType::FAILURE;
+            global_summary->message = "Initial cost evaluation failed. "
+                                              "More details: " + global_summary->message;
+            LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+            prepare_final_summary_(global_summary, local_summary);
+            return;
+        }
+
+        if (options.history_save_frequency > 0) {
+            for (unsigned int i = 0; i < population_size_; ++i)
+                scale_parameters_(population_.col(i), scaled_population.col(i));
+            internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, scaled_population, global_minimum_state_.cost, global_minimum_state_.x);
+        }
+
+        if(check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
+            prepare_final_summary_(global_summary, local_summary);
+            if (internal::IsSolutionUsable(global_summary)||internal::IsSolutionUsable(local_summary))
+                x = global_minimum_state_.x;
+            return;
+        }
+
+        internal::State current_state(num_parameters_);
+
+        while (true) {
+            bool is_evaluated;
+            if (population_update == ASYNCHRONOUS) {
+                is_evaluated = evolve_asynchronously_(options, num_threads, &current_state,
+                                                      &scaled_population, global_summary);
+            } else {
+                is_evaluated = evolve_population_(population_update, num_threads, global_summary);
+            }
+
+            if (!is_evaluated) {
                 global_summary->termination_type = TerminationType::FAILURE;
-                global_summary->message = "Initial cost evaluation failed. "
+                global_summary->message = "Cost evaluation failed. "
                                                   "More details: " + global_summary->message;
                 LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
                 prepare_final_summary_(global_summary, local_summary);
                 return;
             }
+
+            if (population_update == ASYNCHRONOUS ||
+                complete_generation_(options, &current_state, &scaled_population, global_summary))
+                break;
         }
-        global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
 
-        pallas::Vector::Index min_idx;
+        polish_global_minimum_(options, problem, is_evaluation_budget_spent_(options), &local_summary, global_summary);
+        prepare_final_summary_(global_summary, local_summary);
+        if (internal::IsSolutionUsable(global_summary)||internal::IsSolutionUsable(local_summary))
+            x = global_minimum_state_.x;
 
-        global_minimum_state_.cost = population_energies_.minCoeff(&min_idx);
-        global_minimum_state_.x = population_[min_idx];
+        if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency != 0) {
+            for (unsigned int i = 0; i < population_size_; ++i)
+                scale_parameters_(population_.col(i), scaled_population.col(i));
+            internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, scaled_population, global_minimum_state_.cost, global_minimum_state_.x);
+        }
+        global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
+    };
+
+    void DifferentialEvolution::solve_islands_(const DifferentialEvolution::Options& options,
+                                               const GradientProblem& problem,
+                                               double* parameters,
+                                               DifferentialEvolution::Summary* global_summary) {
+        double start_time = WallTimeInSeconds();
+        bool is_not_silent = !options.is_silent;
+        const unsigned int num_islands = options.num_islands;
+        CHECK(options.migration_interval > 0) << "The islands must be evolved for at least one generation between migrations.";
+
+        num_parameters_ = static_cast<unsigned int>(problem.NumParameters());
+        global_summary->num_parameters = num_parameters_;
+        global_summary->num_islands = num_islands;
+
+        CHECK(options.upper_bounds.size() == num_parameters_) << "Upper bounds of size" << options.upper_bounds.size()
+                                                              << " does not have the length as the number of parameters.";
+        upper_bounds_ = options.upper_bounds;
 
+        CHECK(options.lower_bounds.size() == num_parameters_) << "Lower bounds of size" << options.lower_bounds.size()
+                                                              << " does not have the length as the number of parameters.";
+        lower_bounds_ = options.lower_bounds;
+
+        seed_ = internal::ResolveSeed(options.seed);
+        global_minimum_state_ = internal::State(num_parameters_);
+        num_iterations_ = 0;
+
+        scoped_ptr<internal::Evaluator> tmp_evaluator(new internal::Evaluator(problem));
+        swap(evaluator_, tmp_evaluator);
+
+        VectorRef x(parameters, num_parameters_);
+
+        GradientLocalMinimizer::Summary local_summary;
+
+        global_summary->mutation_strategy = options.mutation_strategy;
+        global_summary->crossover_strategy = options.crossover_strategy;
+
+        PopulationUpdateType population_update = options.population_update;
+        if (population_update == ASYNCHRONOUS) {
+            LOG_IF(WARNING, is_not_silent) << "Islands do not support ASYNCHRONOUS updating. Using IMMEDIATE updating.";
+            population_update = IMMEDIATE;
+        }
+        const int num_threads = std::min(std::max(1, options.num_threads), static_cast<int>(num_islands));
+        global_summary->population_update = population_update;
+        global_summary->num_threads = num_threads;
+        global_summary->seed = seed_;
+
+        // every island shares the seed but draws from its own substreams and gets an equal share of the evaluation
+        // budget. The history of the islands is kept and the callbacks are called here.
+        DifferentialEvolution::Options island_options = options;
+        island_options.seed = seed_;
+        island_options.history_save_frequency = 0;
+        island_options.callbacks.clear();
+        island_options.max_function_evaluations = options.max_function_evaluations / num_islands;
+        island_options.max_gradient_evaluations = options.max_gradient_evaluations / num_islands;
+
+        std::vector<std::unique_ptr<DifferentialEvolution> > islands(num_islands);
+        for (unsigned int i = 0; i < num_islands; ++i) {
+            if (!options.island_strategies.empty()) {
+                const IslandStrategy& strategy = options.island_strategies[i % options.island_strategies.size()];
+                island_options.mutation_strategy = strategy.mutation_strategy;
+                island_options.crossover_strategy = strategy.crossover_strategy;
+                island_options.crossover_probability = strategy.crossover_probability;
+                island_options.dither = strategy.dither;
+            }
+            islands[i].reset(new DifferentialEvolution());
+            DifferentialEvolution& island = *islands[i];
+            island.island_index_ = i;
+            island.num_parameters_ = num_parameters_;
+            island.init_member_variables_(island_options);
+
+            scoped_ptr<internal::Evaluator> tmp_island_evaluator(new internal::Evaluator(problem));
+            swap(island.evaluator_, tmp_island_evaluator);
+        }
+
+        // only the termination criteria are used from here on, and they are shared by all islands
+        std::vector<DifferentialEvolution::Summary> island_summaries(num_islands);
+        std::vector<internal::State> island_states(num_islands, internal::State(num_parameters_));
+        std::vector<char> is_evaluated(num_islands, 1);
+        std::vector<char> is_terminated(num_islands, 0);
+        Matrix unused_population;
+
+        internal::ParallelFor(num_threads, 0, num_islands, [&](int /*thread_id*/, int64_t i) {
+            DifferentialEvolution& island = *islands[i];
+            is_evaluated[i] = island.evaluate_initial_population_(1, &island_summaries[i]);
+            is_terminated[i] = !is_evaluated[i] ||
+                               island.check_for_termination_(island_options,
+                                                             &island_summaries[i].message,
+                                                             &island_summaries[i].termination_type);
+        });
+
+        const unsigned int num_migrants = std::min(options.num_migrants, options.population_size - 1);
+        Matrix migrants(num_parameters_, num_islands * num_migrants);
+        Vector migrant_energies(num_islands * num_migrants);
+        internal::RandomNumberGenerator<unsigned int> random_island(0, num_islands - 2);
+        random_island.seed(seed_, internal::MIGRATION_STREAM);
+
+        unsigned int num_migrations = 0;
+        unsigned int last_history_iteration = 0;
+        Matrix scaled_population;
         if (options.history_save_frequency > 0) {
-            for (size_t i = 0; i < population_.size(); ++i)
-                scale_parameters_(population_[i], scaled_population[i]);
-            global_summary->history.push_back(HistoryOutput(num_iterations_, scaled_population, global_minimum_state_.cost, global_minimum_state_.x));
+            scaled_population.resize(num_parameters_, num_islands * options.population_size);
+            save_island_history_(options, islands, &scaled_population, global_summary);
         }
 
-        if(check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
+        // the callbacks see the island holding the best individual, as long as no island failed
+        bool is_stopped_by_callback = false;
+        std::string callback_message;
+        TerminationType callback_termination_type = TerminationType::USER_SUCCESS;
+        auto invoke_callbacks = [&]() {
+            if (options.callbacks.empty() || std::find(is_evaluated.begin(), is_evaluated.end(), 0) != is_evaluated.end())
+                return;
+            unsigned int best_island = 0;
+            for (unsigned int i = 1; i < num_islands; ++i) {
+                if (islands[i]->global_minimum_state_.cost < islands[best_island]->global_minimum_state_.cost)
+                    best_island = i;
+            }
+            is_stopped_by_callback = internal::InvokeCallbacks(options.callbacks,
+                                                               islands[best_island]->iteration_summary_(),
+                                                               &callback_message,
+                                                               &callback_termination_type);
+        };
+        invoke_callbacks();
+
+        // the run ends on a failure, once the minimum cost is reached, when every island has terminated or when
+        // a callback stops it
+        auto is_done = [&]() {
+            if (is_stopped_by_callback)
+                return true;
+            bool is_every_island_terminated = true;
+            for (unsigned int i = 0; i < num_islands; ++i) {
+                if (!is_evaluated[i] || island_summaries[i].termination_type == TerminationType::USER_SUCCESS)
+                    return true;
+                is_every_island_terminated = is_every_island_terminated && is_terminated[i];
+            }
+            return is_every_island_terminated;
+        };
+
+        while (!is_done()) {
+            internal::ParallelFor(num_threads, 0, num_islands, [&](int /*thread_id*/, int64_t i) {
+                DifferentialEvolution& island = *islands[i];
+                for (unsigned int j = 0; j < options.migration_interval && !is_terminated[i]; ++j) {
+                    if (!island.evolve_population_(population_update, 1, &island_summaries[i])) {
+                        is_evaluated[i] = 0;
+                        is_terminated[i] = 1;
+                        break;
+                    }
+                    is_terminated[i] = island.complete_generation_(island_options,
+                                                                   &island_states[i],
+                                                                   &unused_population,
+                                                                   &island_summaries[i]);
+                }
+            });
+
+            for (unsigned int i = 0; i < num_islands; ++i)
+                num_iterations_ = std::max(num_iterations_, islands[i]->num_iterations_);
+
+            if (options.history_save_frequency > 0 &&
+                num_iterations_ / options.history_save_frequency > last_history_iteration / options.history_save_frequency) {
+                save_island_history_(options, islands, &scaled_population, global_summary);
+                last_history_iteration = num_iterations_;
+            }
+
+            invoke_callbacks();
+            if (is_done())
+                break;
+
+            // all migrants are chosen before any island receives, so no island passes on individuals it just received
+            for (unsigned int i = 0; i < num_islands; ++i)
+                islands[i]->select_migrants_(migrants.middleCols(i * num_migrants, num_migrants),
+                                             migrant_energies.segment(i * num_migrants, num_migrants));
+            for (unsigned int i = 0; i < num_islands; ++i) {
+                const unsigned int destination = options.migration_topology == RANDOM_TOPOLOGY ?
+                                                 (i + 1 + random_island()) % num_islands :
+                                                 (i + 1) % num_islands;
+                islands[destination]->accept_migrants_(migrants.middleCols(i * num_migrants, num_migrants),
+                                                       migrant_energies.segment(i * num_migrants, num_migrants));
+            }
+            ++num_migrations;
+        }
+
+        // the summary reports the termination of the island holding the best individual, unless another island
+        // failed or reached the minimum cost
+        unsigned int reporting_island = 0;
+        for (unsigned int i = 1; i < num_islands; ++i) {
+            if (islands[i]->global_minimum_state_.cost < islands[reporting_island]->global_minimum_state_.cost)
+                reporting_island = i;
+        }
+        for (unsigned int i = 0; i < num_islands; ++i) {
+            if (!is_evaluated[i] || island_summaries[i].termination_type == TerminationType::USER_SUCCESS) {
+                reporting_island = i;
+                break;
+            }
+        }
+        global_minimum_state_ = islands[reporting_island]->global_minimum_state_;
+        for (unsigned int i = 0; i < num_islands; ++i)
+            global_minimum_state_.update(islands[i]->global_minimum_state_);
+        global_summary->num_migrations = num_migrations;
+
+        // the islands time their own evaluations, which run side by side on up to `num_threads` threads
+        double island_cost_evaluation_time_in_seconds = 0.0;
+        for (unsigned int i = 0; i < num_islands; ++i)
+            island_cost_evaluation_time_in_seconds += island_summaries[i].cost_evaluation_time_in_seconds;
+        global_summary->cost_evaluation_time_in_seconds +=
+                island_cost_evaluation_time_in_seconds / num_threads;
+
+        // the evaluations of the islands are added to those of the polishing step below
+        int64_t num_island_cost_evaluations = 0;
+        int64_t num_island_gradient_evaluations = 0;
+        for (unsigned int i = 0; i < num_islands; ++i) {
+            num_island_cost_evaluations += islands[i]->evaluator_->num_cost_evaluations();
+            num_island_gradient_evaluations += islands[i]->evaluator_->num_gradient_evaluations();
+        }
+
+        if (!is_evaluated[reporting_island]) {
+            global_summary->termination_type = TerminationType::FAILURE;
+            global_summary->message = "Cost evaluation failed. "
+                                              "More details: " + island_summaries[reporting_island].message;
+            LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+            prepare_final_summary_(global_summary, local_summary);
+        } else {
+            global_summary->termination_type = is_stopped_by_callback ?
+                                               callback_termination_type :
+                                               island_summaries[reporting_island].termination_type;
+            global_summary->message = is_stopped_by_callback ? callback_message : island_summaries[reporting_island].message;
+            // the islands share the evaluation budget, so it is checked on their total
+            const bool is_budget_spent = internal::IsEvaluationBudgetSpent(options.max_function_evaluations,
+                                                                           options.max_gradient_evaluations,
+                                                                           num_island_cost_evaluations,
+                                                                           num_island_gradient_evaluations);
+            polish_global_minimum_(options, problem, is_budget_spent, &local_summary, global_summary);
             prepare_final_summary_(global_summary, local_summary);
             if (internal::IsSolutionUsable(global_summary)||internal::IsSolutionUsable(local_summary))
                 x = global_minimum_state_.x;
-            return;
         }
+        global_summary->num_cost_evaluations += num_island_cost_evaluations;
+        global_summary->num_gradient_evaluations += num_island_gradient_evaluations;
+
+        if (options.history_save_frequency > 0 && last_history_iteration != num_iterations_)
+            save_island_history_(options, islands, &scaled_population, global_summary);
+        global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
+    };
+
+    bool DifferentialEvolution::evaluate_initial_population_(int num_threads,
+                                                             DifferentialEvolution::Summary* global_summary) {
+        for (unsigned int i = 0; i < population_size_; ++i) {
+            scale_parameters_(population_.col(i), scaled_trials_.col(i));
+        }
+        const double t1 = WallTimeInSeconds();
+        if (!evaluate_candidates_(scaled_trials_, num_threads, &population_energies_, &global_summary->message))
+            return false;
+        global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+
+        pallas::Vector::Index min_idx;
+
+        global_minimum_state_.cost = population_energies_.minCoeff(&min_idx);
+        scale_parameters_(population_.col(min_idx), global_minimum_state_.x);
 
         // move fittest individual to first slot
-        std::swap(population_[min_idx], population_[0]);
+        population_.col(min_idx).swap(population_.col(0));
         std::swap(population_energies_[min_idx], population_energies_[0]);
+        return true;
+    };
 
-        internal::State current_state(num_parameters_);
+    bool DifferentialEvolution::evolve_population_(PopulationUpdateType population_update,
+                                                   int num_threads,
+                                                   DifferentialEvolution::Summary* global_summary) {
+        double t1;
+        scale_ = random_dither_();
 
-        double trial_energy;
-        Vector trial(num_parameters_);
-        while (true) {
-            scale_ = (*random_dither_)();
+        if (population_update == DEFERRED) {
+            for (unsigned int i = 0; i < population_size_; ++i) {
+                mutate_(trials_.col(i), i);
+                ensure_constraint_(trials_.col(i));
+                scale_parameters_(trials_.col(i), scaled_trials_.col(i));
+            }
 
+            t1 = WallTimeInSeconds();
+            if (!evaluate_candidates_(scaled_trials_, num_threads, &trial_energies_, &global_summary->message))
+                return false;
+            global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+
+            select_trials_();
+        } else {
             for (unsigned int i = 0; i < population_size_; ++i) {
-                trial = population_[i];
-                mutate_(trial, i);
-                ensure_constraint_(trial);
-                scale_parameters_(trial, scaled_trial);
+                mutate_(trials_.col(i), i);
+                ensure_constraint_(trials_.col(i));
+                scale_parameters_(trials_.col(i), scaled_trials_.col(i));
                 t1 = WallTimeInSeconds();
-                if (!Evaluate(problem, scaled_trial, &trial_energy, &global_summary->message)) {
-                    global_summary->termination_type = TerminationType::FAILURE;
-                    global_summary->message = "Cost evaluation failed. "
-                                                      "More details: " + global_summary->message;
-                    LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
-                    prepare_final_summary_(global_summary, local_summary);
-                    return;
-                }
+                if (!Evaluate(evaluator_.get(), scaled_trials_.col(i), &trial_energies_[i], &global_summary->message))
+                    return false;
                 global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
 
-                if (trial_energy < population_energies_[i]) {
-                    population_[i] = trial;
-                    population_energies_[i] = trial_energy;
-
-                    if (trial_energy < population_energies_[0]) {
-                        population_[0] = trial;
-                        population_energies_[0] = trial_energy;
-                    }
-                }
+                select_trial_(i, trial_energies_[i], trials_.col(i));
             }
+        }
+        return true;
+    };
 
-            scale_parameters_(population_[0], current_state.x);
-            current_state.cost = population_energies_[0];
+    void DifferentialEvolution::polish_global_minimum_(const DifferentialEvolution::Options& options,
+                                                       const GradientProblem& problem,
+                                                       bool is_budget_spent,
+                                                       GradientLocalMinimizer::Summary* local_summary,
+                                                       DifferentialEvolution::Summary* global_summary) {
+        double t1;
+        if (options.polish_output && !is_budget_spent &&
+            global_summary->termination_type != TerminationType::USER_FAILURE) {
+            t1 = WallTimeInSeconds();
+            // the bounds may be given in either order, see scale_arg2_
+            const Vector polish_lower_bounds = lower_bounds_.cwiseMin(upper_bounds_);
+            const Vector polish_upper_bounds = lower_bounds_.cwiseMax(upper_bounds_);
+            internal::MinimizeLocally(options.local_minimizer_type,
+                                      options.local_minimizer_options,
+                                      options.least_squares_minimizer_options,
+                                      problem,
+                                      polish_lower_bounds.data(),
+                                      polish_upper_bounds.data(),
+                                      global_minimum_state_.x.data(),
+                                      local_summary);
+            global_summary->was_polished = true;
+            global_summary->local_minimization_time_in_seconds = WallTimeInSeconds() - t1;
+        }
 
-            ++num_iterations_;
-            global_minimum_state_.update(current_state);
+        t1 = WallTimeInSeconds();
+        if (!Evaluate(evaluator_.get(), global_minimum_state_.x, &global_minimum_state_.cost, &global_summary->message)) {
+            global_summary->termination_type = TerminationType::FAILURE;
+            global_summary->message = "Cost evaluation of global minimum state failed after polishing step "
+                                              "More details: " + global_summary->message;
+            LOG_IF(WARNING, !options.is_silent) << "Terminating: " << global_summary->message;
+        }
+        global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+    };
 
-            update_std_dev_();
+    void DifferentialEvolution::select_migrants_(Eigen::Ref<Matrix> migrants,
+                                                 Eigen::Ref<Vector> migrant_energies) const {
+        std::vector<unsigned int> order(population_size_);
+        for (unsigned int i = 0; i < population_size_; ++i)
+            order[i] = i;
+        const int num_migrants = static_cast<int>(migrants.cols());
+        std::partial_sort(order.begin(), order.begin() + num_migrants, order.end(),
+                          [this](unsigned int a, unsigned int b) {
+                              return population_energies_[a] < population_energies_[b];
+                          });
+        for (int k = 0; k < num_migrants; ++k) {
+            migrants.col(k) = population_.col(order[k]);
+            migrant_energies[k] = population_energies_[order[k]];
+        }
+    };
 
-            if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency == 0) {
-                for (size_t i = 0; i < population_.size(); ++i)
-                    scale_parameters_(population_[i], scaled_population[i]);
-                global_summary->history.push_back(HistoryOutput(num_iterations_, scaled_population, global_minimum_state_.cost, global_minimum_state_.x));
+    void DifferentialEvolution::accept_migrants_(const Eigen::Ref<const Matrix>& migrants,
+                                                 const Eigen::Ref<const Vector>& migrant_energies) {
+        pallas::Vector::Index worst_idx;
+        for (int k = 0; k < migrants.cols(); ++k) {
+            if (migrant_energies[k] >= population_energies_.maxCoeff(&worst_idx))
+                continue;
+            population_.col(worst_idx) = migrants.col(k);
+            population_energies_[worst_idx] = migrant_energies[k];
+
+            // keep the fittest individual in the first slot
+            if (migrant_energies[k] < population_energies_[0]) {
+                population_.col(worst_idx).swap(population_.col(0));
+                std::swap(population_energies_[worst_idx], population_energies_[0]);
             }
+        }
+        update_std_dev_();
+    };
 
-            if(check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
-                if (options.polish_output) {
-                    t1 = WallTimeInSeconds();
-                    GradientLocalMinimizer local_minimizer;
-                    local_minimizer.Solve(options.local_minimizer_options,
-                                          problem,
-                                          global_minimum_state_.x.data(),
-                                          &local_summary);
-                    global_summary->was_polished = true;
-                    global_summary->local_minimization_time_in_seconds = WallTimeInSeconds() - t1;
-                }
+    void DifferentialEvolution::save_island_history_(const DifferentialEvolution::Options& options,
+                                                     const std::vector<std::unique_ptr<DifferentialEvolution> >& islands,
+                                                     Matrix* scaled_population,
+                                                     DifferentialEvolution::Summary* global_summary) {
+        const unsigned int population_size = islands[0]->population_size_;
+        unsigned int best_island = 0;
+        for (unsigned int i = 0; i < islands.size(); ++i) {
+            for (unsigned int j = 0; j < population_size; ++j)
+                islands[i]->scale_parameters_(islands[i]->population_.col(j),
+                                              scaled_population->col(i * population_size + j));
+            if (islands[i]->global_minimum_state_.cost < islands[best_island]->global_minimum_state_.cost)
+                best_island = i;
+        }
+        const internal::State& best_state = islands[best_island]->global_minimum_state_;
+        internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history,
+                              num_iterations_, *scaled_population, best_state.cost, best_state.x);
+    };
 
-                t1 = WallTimeInSeconds();
-                if (!Evaluate(problem, global_minimum_state_.x, &global_minimum_state_.cost, &global_summary->message)) {
-                    global_summary->termination_type = TerminationType::FAILURE;
-                    global_summary->message = "Cost evaluation of global minimum state failed after polishing step "
-                                                      "More details: " + global_summary->message;
-                    LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+    bool DifferentialEvolution::evolve_asynchronously_(const DifferentialEvolution::Options& options,
+                                                       int num_threads,
+                                                       internal::State* current_state,
+                                                       Matrix* scaled_population,
+                                                       DifferentialEvolution::Summary* global_summary) {
+        // each worker keeps one trial in flight, building it in its own column of trials_ and scaled_trials_
+        const int num_workers = std::min(num_threads, static_cast<int>(population_size_));
+        std::mutex mutex;
+        bool is_done = false;
+        bool is_evaluated = true;
+        unsigned int next_target = 0;
+        unsigned int num_selections = 0;
+        double busy_time_in_seconds = 0.0;
+
+        scale_ = random_dither_();
+        const double start_time = WallTimeInSeconds();
+        internal::ParallelFor(num_workers, 0, num_workers, [&](int /*thread_id*/, int64_t worker) {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!is_done) {
+                const unsigned int target = next_target;
+                next_target = (next_target + 1) % population_size_;
+                mutate_(trials_.col(worker), target);
+                ensure_constraint_(trials_.col(worker));
+                scale_parameters_(trials_.col(worker), scaled_trials_.col(worker));
+                lock.unlock();
+
+                const double evaluation_start_time = WallTimeInSeconds();
+                double trial_cost;
+                const bool is_trial_evaluated = evaluator_->Evaluate(scaled_trials_.col(worker).data(), &trial_cost);
+                const double evaluation_time = WallTimeInSeconds() - evaluation_start_time;
+
+                lock.lock();
+                busy_time_in_seconds += evaluation_time;
+                if (is_done)
+                    break;
+                if (!is_trial_evaluated) {
+                    global_summary->message = "Problem evaluation failed";
+                    is_evaluated = false;
+                    is_done = true;
+                    break;
                 }
-                global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
-                prepare_final_summary_(global_summary, local_summary);
-                if (internal::IsSolutionUsable(global_summary)||internal::IsSolutionUsable(local_summary))
-                    x = global_minimum_state_.x;
 
-                if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency != 0) {
-                    for (size_t i = 0; i < population_.size(); ++i)
-                        scale_parameters_(population_[i], scaled_population[i]);
-                    global_summary->history.push_back(HistoryOutput(num_iterations_, scaled_population, global_minimum_state_.cost, global_minimum_state_.x));
+                select_trial_(target, trial_cost, trials_.col(worker));
+
+                // a generation is complete once as many trials as members have been selected
+                if (++num_selections % population_size_ == 0) {
+                    is_done = complete_generation_(options, current_state, scaled_population, global_summary);
+                    scale_ = random_dither_();
                 }
-                global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
-                return;
             }
+        });
+
+        const double elapsed_time = WallTimeInSeconds() - start_time;
+        global_summary->num_threads = num_workers;
+        // only the evaluations count, averaged over the workers that ran them side by side. Building and
+        // selecting trials and completing generations under the lock is left out.
+        global_summary->cost_evaluation_time_in_seconds += busy_time_in_seconds / num_workers;
+        global_summary->worker_utilization = elapsed_time > 0.0 ?
+                                             busy_time_in_seconds / (num_workers * elapsed_time) :
+                                             1.0;
+        return is_evaluated;
+    };
+
+    bool DifferentialEvolution::complete_generation_(const DifferentialEvolution::Options& options,
+                                                     internal::State* current_state,
+                                                     Matrix* scaled_population,
+                                                     DifferentialEvolution::Summary* global_summary) {
+        scale_parameters_(population_.col(0), current_state->x);
+        current_state->cost = population_energies_[0];
+
+        ++num_iterations_;
+        global_minimum_state_.update(*current_state);
+
+        update_std_dev_();
+
+        if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency == 0) {
+            for (unsigned int i = 0; i < population_size_; ++i)
+                scale_parameters_(population_.col(i), scaled_population->col(i));
+            internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, *scaled_population, global_minimum_state_.cost, global_minimum_state_.x);
         }
+
+        return check_for_termination_(options, &global_summary->message, &global_summary->termination_type);
     };
 
     void DifferentialEvolution::init_member_variables_(const DifferentialEvolution::Options &options) {
         fractional_std_dev_ = DBL_MAX;
 
         population_size_ = options.population_size;
-        init_mutation_strategy_(options.mutation_strategy);
-        init_crossover_strategy_(options.crossover_strategy, options.crossover_probability);
+        seed_ = internal::ResolveSeed(options.seed);
+        init_trial_generator_(options.mutation_strategy,
+                              options.crossover_strategy,
+                              options.crossover_probability);
         init_random_dither_(options.dither);
 
-        scoped_ptr<internal::RandomNumberGenerator<double>> tmp_rng(new internal::RandomNumberGenerator<double>());
-        swap(random_number_, tmp_rng);
+        random_number_.seed(seed_, internal::POPULATION_STREAM, island_index_);
 
         scoped_ptr<internal::Shuffler> tmp_shuffler(new internal::Shuffler(population_size_));
         swap(shuffler_, tmp_shuffler);
+        shuffler_->seed(seed_, island_index_);
+
+        scoped_ptr<internal::IndexSampler> tmp_index_sampler(new internal::IndexSampler(population_size_));
+        swap(index_sampler_, tmp_index_sampler);
+        index_sampler_->seed(seed_, island_index_);
+        CHECK(population_size_ > trial_generator_->NumSamples()) << "Population size " << population_size_
+                                                                 << " is too small for the mutation strategy, which requires at least "
+                                                                 << trial_generator_->NumSamples() + 1 << " members.";
+        samples_.resize(trial_generator_->NumSamples());
 
         CHECK(options.upper_bounds.size() == num_parameters_) << "Upper bounds of size" << options.upper_bounds.size()
                                                               << " does not have the length as the number of parameters.";
@@ -289,45 +768,46 @@ namespace pallas {
                                                               << " does not have the length as the number of parameters.";
         lower_bounds_ = options.lower_bounds;
 
-        scale_ = (*random_number_)();
+        scale_ = random_number_();
 
         scale_arg1_ = upper_bounds_ + lower_bounds_;
         scale_arg1_ *= 0.5;
         scale_arg2_ = (upper_bounds_ - lower_bounds_).cwiseAbs();
 
-        population_.resize(population_size_);
-        for (unsigned int i = 0; i < population_size_; ++i) {
-            population_[i].resize(num_parameters_);
-        }
+        population_.resize(num_parameters_, population_size_);
+        trials_.resize(num_parameters_, population_size_);
+        scaled_trials_.resize(num_parameters_, population_size_);
         population_idx_.resize(population_size_);
         population_idx_.setLinSpaced(population_size_, 0, population_size_ - 1);
-        shuffler_->Shuffle(population_idx_.data(), 100);
 
         init_population_(options.population_initialization);
 
         population_energies_.resize(population_size_);
         population_energies_.setConstant(DBL_MAX);
 
+        trial_energies_.resize(population_size_);
+        trial_energies_.setConstant(DBL_MAX);
+
+        global_minimum_state_ = internal::State(num_parameters_);
+
         num_iterations_ = 0;
     }
 
-    void DifferentialEvolution::init_mutation_strategy_(MutationStrategyType type) {
-        scoped_ptr<internal::MutationStrategy> tmp_mutation_strategy(
-                internal::MutationStrategy::Create(type));
-        swap(mutation_strategy_, tmp_mutation_strategy);
-    };
-
-    void DifferentialEvolution::init_crossover_strategy_(CrossoverStrategyType type,
-                                                         double crossover_probability) {
-        scoped_ptr<internal::CrossoverStrategy> tmp_crossover_strategy(
-                internal::CrossoverStrategy::Create(type, crossover_probability, num_parameters_));
-        swap(crossover_strategy_, tmp_crossover_strategy);
+    void DifferentialEvolution::init_trial_generator_(MutationStrategyType mutation_strategy,
+                                                      CrossoverStrategyType crossover_strategy,
+                                                      double crossover_probability) {
+        scoped_ptr<internal::TrialGenerator> tmp_trial_generator(
+                internal::TrialGenerator::Create(mutation_strategy,
+                                                 crossover_strategy,
+                                                 crossover_probability,
+                                                 num_parameters_));
+        swap(trial_generator_, tmp_trial_generator);
+        trial_generator_->seed(seed_, island_index_);
     };
 
     void DifferentialEvolution::init_random_dither_(const Vector2d &dither) {
-        scoped_ptr<internal::RandomNumberGenerator<double>> tmp_rd(
-                new internal::RandomNumberGenerator<double>(dither[0], dither[1]));
-        swap(random_dither_, tmp_rd);
+        random_dither_ = internal::RandomNumberGenerator<double>(dither[0], dither[1]);
+        random_dither_.seed(seed_, internal::DITHER_STREAM, island_index_);
     };
 
     void DifferentialEvolution::init_population_(PopulationInitializationType type) {
@@ -336,27 +816,21 @@ namespace pallas {
 
         if (type == LATIN_HYPERCUBE) {
             double segsize = 1.0 / population_size_;
-            std::vector<Vector> rdrange(population_size_);
-            for (unsigned int i = 0; i < population_size_; ++i) {
-                rdrange[i].resize(num_parameters_);
-            }
+            Matrix rdrange(num_parameters_, population_size_);
             Vector arange(population_size_);
             arange.setLinSpaced(population_size_, 0.0, 1.0);
-            Vector arange_vector(num_parameters_);
 
             for (unsigned int i = 0; i < population_size_; ++i) {
                 for (unsigned int j = 0; j < num_parameters_; ++j) {
-                    v[j] = (*random_number_)();
+                    v[j] = random_number_();
                 }
-                rdrange[i] = (segsize * v);
-                arange_vector.setConstant(arange[i]);
-                rdrange[i] += arange_vector;
+                rdrange.col(i) = (segsize * v.array() + arange[i]).matrix();
                 for (unsigned int j = 0; j < num_parameters_; ++j) {
-                    if (rdrange[i][j] > 1.0) {
-                        rdrange[i][j] = 1.0;
+                    if (rdrange(j, i) > 1.0) {
+                        rdrange(j, i) = 1.0;
                     }
-                    else if (rdrange[i][j] < 0.0) {
-                        rdrange[i][j] = 0.0;
+                    else if (rdrange(j, i) < 0.0) {
+                        rdrange(j, i) = 0.0;
                     }
                 }
             }
@@ -366,16 +840,15 @@ namespace pallas {
                 shuffler_->Shuffle(population_idx_.data());
                 for (unsigned int i = 0; i < population_size_; ++i) {
                     idx = population_idx_[i];
-                    population_[i][j] = rdrange[idx][j];
+                    population_(j, i) = rdrange(j, idx);
                 }
             }
         }
         else if (type == RANDOM) {
             for (unsigned int i = 0; i < population_size_; ++i) {
-                for (unsigned int j = 0; j < v.size(); ++j) {
-                    v[j] = (*random_number_)();
+                for (unsigned int j = 0; j < num_parameters_; ++j) {
+                    population_(j, i) = random_number_();
                 }
-                population_[i] = v;
             }
         }
         else
@@ -383,22 +856,18 @@ namespace pallas {
     };
 
 
-    void DifferentialEvolution::scale_parameters_(const Vector& trial_in, Vector& trial_out) {
-        for (unsigned int i = 0; i < num_parameters_; ++i) {
-            trial_out[i] = scale_arg1_[i] + (trial_in[i] - 0.5) * scale_arg2_[i];
-        }
+    void DifferentialEvolution::scale_parameters_(const Eigen::Ref<const Vector>& trial_in, Eigen::Ref<Vector> trial_out) {
+        trial_out.array() = scale_arg1_.array() + (trial_in.array() - 0.5) * scale_arg2_.array();
     };
 
-    void DifferentialEvolution::unscale_parameters_(const Vector& trial_in, Vector& trial_out) {
-        for (unsigned int i = 0; i < num_parameters_; ++i) {
-            trial_out[i] = (trial_in[i] - scale_arg1_[i]) / scale_arg2_[i] + 0.5;
-        }
+    void DifferentialEvolution::unscale_parameters_(const Eigen::Ref<const Vector>& trial_in, Eigen::Ref<Vector> trial_out) {
+        trial_out.array() = (trial_in.array() - scale_arg1_.array()) / scale_arg2_.array() + 0.5;
     };
 
-    void DifferentialEvolution::ensure_constraint_(Vector& trial) {
+    void DifferentialEvolution::ensure_constraint_(Eigen::Ref<Vector> trial) {
         for (unsigned int i = 0; i < trial.size(); ++i) {
             if(trial[i] < 0.0 || trial[i] > 1.0) {
-                trial[i] = (*random_number_)();
+                trial[i] = random_number_();
             }
         }
     };
@@ -414,18 +883,67 @@ namespace pallas {
         fractional_std_dev_ = std::sqrt(variance) / std::abs(mean);
     }
 
-    void DifferentialEvolution::mutate_(Vector& candidate, unsigned int idx) {
-        shuffler_->Shuffle(population_idx_.data());
+    void DifferentialEvolution::mutate_(Eigen::Ref<Vector> candidate, unsigned int idx) {
+        index_sampler_->Sample(idx, trial_generator_->NumSamples(), samples_.data());
 
-        crossover_strategy_->Crossover(candidate, mutation_strategy_->get_bprime(population_,
-                                                                                 idx,
-                                                                                 population_idx_.data(),
-                                                                                 scale_));
+        trial_generator_->Generate(population_,
+                                   idx,
+                                   samples_.data(),
+                                   scale_,
+                                   candidate.data());
+    };
+
+    bool DifferentialEvolution::evaluate_candidates_(const Matrix& scaled_candidates,
+                                                     int num_threads,
+                                                     Vector* energies,
+                                                     string* message) {
+        if (!evaluator_->EvaluateBatch(static_cast<int>(scaled_candidates.cols()),
+                                       scaled_candidates.data(),
+                                       num_threads,
+                                       energies->data())) {
+            *message = "Problem evaluation failed";
+            return false;
+        }
+        return true;
+    };
+
+    void DifferentialEvolution::select_trial_(unsigned int target,
+                                              double trial_cost,
+                                              const Eigen::Ref<const Vector>& trial) {
+        if (trial_cost < population_energies_[target]) {
+            population_.col(target) = trial;
+            population_energies_[target] = trial_cost;
+
+            if (trial_cost < population_energies_[0]) {
+                population_.col(0) = trial;
+                population_energies_[0] = trial_cost;
+            }
+        }
+    };
+
+    void DifferentialEvolution::select_trials_() {
+        for (unsigned int i = 0; i < population_size_; ++i) {
+            if (trial_energies_[i] < population_energies_[i]) {
+                population_.col(i) = trials_.col(i);
+                population_energies_[i] = trial_energies_[i];
+            }
+        }
+
+        // move fittest individual to first slot
+        pallas::Vector::Index min_idx;
+        population_energies_.minCoeff(&min_idx);
+        if (min_idx != 0) {
+            population_.col(min_idx).swap(population_.col(0));
+            std::swap(population_energies_[min_idx], population_energies_[0]);
+        }
     };
 
     bool DifferentialEvolution::check_for_termination_(const DifferentialEvolution::Options& options,
                                 string *message,
                                 TerminationType * termination_type) {
+        if (!options.callbacks.empty() &&
+            internal::InvokeCallbacks(options.callbacks, iteration_summary_(), message, termination_type))
+            return true;
 
         if (global_minimum_state_.cost < options.minimum_cost) {
             *message = "Prescribed minimum cost reached.";
@@ -435,6 +953,10 @@ namespace pallas {
             *message = "Maximum number of iterations reached.";
             *termination_type = TerminationType::NO_CONVERGENCE;
             return true;
+        } else if (is_evaluation_budget_spent_(options)) {
+            *message = "Maximum number of function or gradient evaluations reached.";
+            *termination_type = TerminationType::NO_CONVERGENCE;
+            return true;
         } else if (fractional_std_dev_ < options.tolerance) {
             *message = "Fractional standard deviation of population less than specified tolerance.";
             *termination_type = TerminationType::CONVERGENCE;
@@ -443,10 +965,36 @@ namespace pallas {
         return false;
     };
 
+    bool DifferentialEvolution::is_evaluation_budget_spent_(const DifferentialEvolution::Options& options) const {
+        return internal::IsEvaluationBudgetSpent(options.max_function_evaluations,
+                                                 options.max_gradient_evaluations,
+                                                 evaluator_->num_cost_evaluations(),
+                                                 evaluator_->num_gradient_evaluations());
+    };
+
+    IterationSummary DifferentialEvolution::iteration_summary_() const {
+        // the fittest individual is the best solution, which is already kept in global coordinates
+        IterationSummary summary(DIFFERENTIAL_EVOLUTION,
+                                 num_iterations_,
+                                 static_cast<int>(num_parameters_),
+                                 population_energies_[0],
+                                 global_minimum_state_.x.data(),
+                                 global_minimum_state_.cost,
+                                 global_minimum_state_.x.data());
+        summary.population_costs = &population_energies_;
+        summary.fractional_std_dev = fractional_std_dev_;
+        return summary;
+    };
+
     void DifferentialEvolution::prepare_final_summary_(DifferentialEvolution::Summary *global_summary,
                                 const GradientLocalMinimizer::Summary &local_summary) {
         global_summary->final_cost = global_minimum_state_.cost;
         global_summary->num_iterations = num_iterations_;
+        global_summary->num_cost_evaluations = evaluator_->num_cost_evaluations();
+        global_summary->num_gradient_evaluations = evaluator_->num_gradient_evaluations();
+        // a local minimization that did not run reports negative counts
+        global_summary->num_local_cost_evaluations = std::max(0, local_summary.num_cost_evaluations);
+        global_summary->num_local_gradient_evaluations = std::max(0, local_summary.num_gradient_evaluations);
         global_summary->local_minimization_summary = local_summary;
     };
 
@@ -465,10 +1013,10 @@ namespace pallas {
 
         writer.String("population");
         writer.StartArray();
-        for (auto& individual : h.population) {
+        for (auto j = 0; j < h.population.cols(); ++j) {
             writer.StartArray();
-            for (auto i = 0; i < individual.size(); ++i)  {
-                writer.Double(individual[i]);
+            for (auto i = 0; i < h.population.rows(); ++i)  {
+                writer.Double(h.population(i, j));
             }
             writer.EndArray();
         }
@@ -485,4 +1033,15 @@ namespace pallas {
         writer.EndArray();
         writer.EndObject();
     }
+
+    void dump(const DifferentialEvolution::HistoryOutput &h, BinaryHistoryWriter& writer) {
+        writer.StartRecord(DIFFERENTIAL_EVOLUTION,
+                           static_cast<unsigned int>(h.best_solution.size()),
+                           static_cast<unsigned int>(h.population.cols()));
+        writer.Uint("iteration_number", h.iteration_number);
+        writer.Doubles("population", h.population.data(), h.population.size());
+        writer.Double("best_cost", h.best_cost);
+        writer.Doubles("best_solution", h.best_solution.data(), h.best_solution.size());
+        writer.EndRecord();
+    }
 } // namespace pallas
@@ -0,0 +1,248 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include "pallas/gradient_problem.h"
+
+#include <mutex>
+#include <vector>
+
+#include "glog/logging.h"
+#include "pallas/scoped_ptr.h"
+
+namespace pallas {
+
+    namespace {
+
+        /**
+         * Scalar cost `0.5 * rho(|r|^2)` of a residual block and its gradient `rho'(|r|^2) J'r`. Scratch space
+         * is allocated per call so the cost may be evaluated concurrently, as the global phase of the solvers does.
+         */
+        class LeastSquaresFunction : public GradientCostFunction {
+        public:
+            LeastSquaresFunction(LeastSquaresCostFunction* cost_function,
+                                 ceres::LossFunction* loss_function)
+                    : cost_function_(cost_function),
+                      loss_function_(loss_function),
+                      num_parameters_(0) {
+                const std::vector<int>& block_sizes = cost_function->parameter_block_sizes();
+                CHECK(!block_sizes.empty()) << "The least squares cost function has no parameter blocks.";
+                for (unsigned int i = 0; i < block_sizes.size(); ++i) {
+                    block_offsets_.push_back(num_parameters_);
+                    num_parameters_ += block_sizes[i];
+                }
+            }
+
+            virtual bool Evaluate(const double* parameters,
+                                  double* cost,
+                                  double* gradient) const {
+                const std::vector<int>& block_sizes = cost_function_->parameter_block_sizes();
+                const int num_blocks = static_cast<int>(block_sizes.size());
+                const int num_residuals = cost_function_->num_residuals();
+
+                std::vector<const double*> blocks(num_blocks);
+                for (int i = 0; i < num_blocks; ++i)
+                    blocks[i] = parameters + block_offsets_[i];
+
+                Vector residuals(num_residuals);
+                std::vector<Matrix> jacobians;
+                std::vector<double*> jacobian_ptrs;
+                if (gradient != NULL) {
+                    jacobians.resize(num_blocks);
+                    jacobian_ptrs.resize(num_blocks);
+                    for (int i = 0; i < num_blocks; ++i) {
+                        // ceres expects row-major jacobians, which is the transpose of a column-major one
+                        jacobians[i].resize(block_sizes[i], num_residuals);
+                        jacobian_ptrs[i] = jacobians[i].data();
+                    }
+                }
+
+                if (!cost_function_->Evaluate(blocks.data(),
+                                              residuals.data(),
+                                              gradient != NULL ? jacobian_ptrs.data() : NULL)) {
+                    return false;
+                }
+
+                const double squared_norm = residuals.squaredNorm();
+                double rho[3] = {squared_norm, 1.0, 0.0};
+                if (loss_function_.get() != NULL)
+                    loss_function_->Evaluate(squared_norm, rho);
+                *cost = 0.5 * rho[0];
+
+                if (gradient != NULL) {
+                    for (int i = 0; i < num_blocks; ++i) {
+                        VectorRef(gradient + block_offsets_[i], block_sizes[i]).noalias() =
+                                rho[1] * jacobians[i] * residuals;
+                    }
+                }
+                return true;
+            }
+
+            virtual int NumParameters() const { return num_parameters_; }
+
+        private:
+            scoped_ptr<LeastSquaresCostFunction> cost_function_;
+            scoped_ptr<ceres::LossFunction> loss_function_;
+            std::vector<int> block_offsets_;
+            int num_parameters_;
+        };
+
+        /**
+         * Forwards the evaluations to a `ceres::GradientProblem` without a local parameterization, whose cost
+         * function cannot be reached directly. The problem is not owned. A ceres problem computes gradients in a
+         * single scratch buffer, so gradient evaluations are serialized; cost evaluations do not touch it and run
+         * concurrently.
+         */
+        class CeresProblemFunction : public GradientCostFunction {
+        public:
+            explicit CeresProblemFunction(const ceres::GradientProblem& problem) : problem_(problem) {
+                CHECK_EQ(problem.NumParameters(), problem.NumLocalParameters())
+                    << "A ceres::GradientProblem with a local parameterization cannot be converted, build a "
+                       "pallas::GradientProblem from its cost function and parameterization instead.";
+            }
+
+            virtual bool Evaluate(const double* parameters,
+                                  double* cost,
+                                  double* gradient) const {
+                if (gradient == NULL)
+                    return problem_.Evaluate(parameters, cost, NULL);
+
+                std::lock_guard<std::mutex> lock(gradient_mutex_);
+                return problem_.Evaluate(parameters, cost, gradient);
+            }
+
+            virtual int NumParameters() const { return problem_.NumParameters(); }
+
+        private:
+            const ceres::GradientProblem& problem_;
+            mutable std::mutex gradient_mutex_;
+        };
+
+    } // namespace
+
+    GradientProblem::GradientProblem(const ceres::GradientProblem& problem)
+            : GradientProblem(new CeresProblemFunction(problem)) {
+
+    };
+
+    GradientProblem::GradientProblem(GradientCostFunction* function)
+            : ceres::GradientProblem(function),
+              function_(function),
+              batch_function_(dynamic_cast<const BatchGradientCostFunction*>(function)),
+              parameterization_(NULL),
+              least_squares_function_(NULL),
+              loss_function_(NULL) {
+
+    };
+
+    GradientProblem::GradientProblem(GradientCostFunction* function,
+                                     ceres::LocalParameterization* parameterization)
+            : ceres::GradientProblem(function, parameterization),
+              function_(function),
+              batch_function_(dynamic_cast<const BatchGradientCostFunction*>(function)),
+              parameterization_(parameterization),
+              least_squares_function_(NULL),
+              loss_function_(NULL) {
+
+    };
+
+    GradientProblem::GradientProblem(LeastSquaresCostFunction* cost_function)
+            : GradientProblem(new LeastSquaresFunction(cost_function, NULL), NULL, cost_function, NULL) {
+
+    };
+
+    GradientProblem::GradientProblem(LeastSquaresCostFunction* cost_function,
+                                     ceres::LossFunction* loss_function)
+            : GradientProblem(new LeastSquaresFunction(cost_function, loss_function),
+                              NULL, cost_function, loss_function) {
+
+    };
+
+    GradientProblem::GradientProblem(LeastSquaresCostFunction* cost_function,
+                                     ceres::LossFunction* loss_function,
+                                     ceres::LocalParameterization* parameterization)
+            : GradientProblem(new LeastSquaresFunction(cost_function, loss_function),
+                              parameterization, cost_function, loss_function) {
+        CHECK_EQ(cost_function->parameter_block_sizes().size(), 1)
+            << "A local parameterization requires residuals that depend on a single parameter block.";
+    };
+
+    GradientProblem::GradientProblem(GradientCostFunction* function,
+                                     ceres::LocalParameterization* parameterization,
+                                     LeastSquaresCostFunction* cost_function,
+                                     ceres::LossFunction* loss_function)
+            : ceres::GradientProblem(function,
+                                     parameterization != NULL ?
+                                     parameterization :
+                                     new ceres::IdentityParameterization(function->NumParameters())),
+              function_(function),
+              batch_function_(NULL),
+              parameterization_(parameterization),
+              least_squares_function_(cost_function),
+              loss_function_(loss_function) {
+
+    };
+
+    bool GradientProblem::EvaluateBatch(int num_candidates,
+                                        const double* parameters,
+                                        double* costs) const {
+        if (batch_function_ != NULL) {
+            return batch_function_->EvaluateBatch(num_candidates, parameters, costs);
+        }
+
+        const int num_parameters = NumParameters();
+        for (int i = 0; i < num_candidates; ++i) {
+            if (!Evaluate(parameters + i * num_parameters, costs + i, NULL)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const GradientCostFunction* GradientProblem::function() const {
+        return function_;
+    };
+
+    const BatchGradientCostFunction* GradientProblem::batch_function() const {
+        return batch_function_;
+    };
+
+    const ceres::LocalParameterization* GradientProblem::parameterization() const {
+        return parameterization_;
+    };
+
+    CostFunctionType GradientProblem::cost_function_type() const {
+        return least_squares_function_ != NULL ? LEAST_SQUARES : GRADIENT;
+    };
+
+    const LeastSquaresCostFunction* GradientProblem::least_squares_function() const {
+        return least_squares_function_;
+    };
+
+    const ceres::LossFunction* GradientProblem::loss_function() const {
+        return loss_function_;
+    };
+
+} // namespace pallas
@@ -35,4 +35,9 @@ namespace pallas {
         writer.EndArray();
     }
 
+    void dump(const HistorySeries& history, BinaryHistoryWriter& writer)
+    {
+        for (auto& history_concept : history) dump(history_concept, writer);
+    }
+
 } // namespace pallas
\ No newline at end of file
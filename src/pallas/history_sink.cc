@@ -0,0 +1,126 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include "pallas/history_sink.h"
+
+#include "glog/logging.h"
+
+namespace pallas {
+
+    JsonLinesHistorySink::JsonLinesHistorySink(const std::string& filename, unsigned int max_queued_outputs)
+            : file_(std::fopen(filename.c_str(), "wb")),
+              writer_(buffer_),
+              writer_thread_(max_queued_outputs, [this](const HistoryConcept& history) {
+                  return write_output_(history);
+              }) {
+        LOG_IF(ERROR, file_ == NULL) << "Unable to open history file " << filename
+                                     << ". The history outputs will be discarded.";
+    }
+
+    JsonLinesHistorySink::~JsonLinesHistorySink() {
+        writer_thread_.Flush();
+        if (file_ != NULL)
+            std::fclose(file_);
+    }
+
+    void JsonLinesHistorySink::Append(HistoryConcept history) {
+        writer_thread_.Append(std::move(history));
+    }
+
+    void JsonLinesHistorySink::Flush() {
+        writer_thread_.Flush();
+        if (file_ != NULL)
+            std::fflush(file_);
+    }
+
+    bool JsonLinesHistorySink::IsGood() const {
+        return file_ != NULL && writer_thread_.IsGood();
+    }
+
+    uint64_t JsonLinesHistorySink::NumOutputsWritten() const {
+        return writer_thread_.NumOutputsWritten();
+    }
+
+    bool JsonLinesHistorySink::write_output_(const HistoryConcept& history) {
+        if (file_ == NULL)
+            return false;
+
+        // the buffer is reused, so once it has grown to the size of the largest output no more memory is allocated
+        buffer_.Clear();
+        writer_.Reset(buffer_);
+        dump(history, writer_);
+        buffer_.Put('\n');
+        return std::fwrite(buffer_.GetString(), 1, buffer_.GetSize(), file_) == buffer_.GetSize();
+    }
+
+    BinaryHistorySink::BinaryHistorySink(const std::string& filename, unsigned int max_queued_outputs)
+            : file_(std::fopen(filename.c_str(), "wb")),
+              writer_thread_(max_queued_outputs, [this](const HistoryConcept& history) {
+                  return write_output_(history);
+              }) {
+        LOG_IF(ERROR, file_ == NULL) << "Unable to open history file " << filename
+                                     << ". The history outputs will be discarded.";
+    }
+
+    BinaryHistorySink::~BinaryHistorySink() {
+        writer_thread_.Flush();
+        if (file_ != NULL)
+            std::fclose(file_);
+    }
+
+    void BinaryHistorySink::Append(HistoryConcept history) {
+        writer_thread_.Append(std::move(history));
+    }
+
+    void BinaryHistorySink::Flush() {
+        writer_thread_.Flush();
+        if (file_ != NULL)
+            std::fflush(file_);
+    }
+
+    bool BinaryHistorySink::IsGood() const {
+        return file_ != NULL && writer_thread_.IsGood();
+    }
+
+    uint64_t BinaryHistorySink::NumOutputsWritten() const {
+        return writer_thread_.NumOutputsWritten();
+    }
+
+    bool BinaryHistorySink::write_output_(const HistoryConcept& history) {
+        if (file_ == NULL)
+            return false;
+
+        writer_.Clear();
+        dump(history, writer_);
+        if (writer_.GetSize() == 0) {
+            LOG(ERROR) << "History output does not match the layout of the first output of the binary history file. "
+                          "The output is dropped.";
+            return false;
+        }
+        return std::fwrite(writer_.GetData(), 1, writer_.GetSize(), file_) == writer_.GetSize();
+    }
+
+} // namespace pallas
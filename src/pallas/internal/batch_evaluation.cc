@@ -0,0 +1,67 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "pallas/internal/batch_evaluation.h"
+#include "pallas/internal/parallel_for.h"
+
+namespace pallas {
+    namespace internal {
+
+        bool EvaluateBatch(const GradientProblem& problem,
+                           int num_candidates,
+                           const double* parameters,
+                           int num_threads,
+                           double* costs) {
+            if (num_candidates <= 0) {
+                return true;
+            }
+
+            const int num_chunks = std::max(1, std::min(num_threads, num_candidates));
+            if (num_chunks == 1) {
+                return problem.EvaluateBatch(num_candidates, parameters, costs);
+            }
+
+            const int num_parameters = problem.NumParameters();
+            const int chunk_size = (num_candidates + num_chunks - 1) / num_chunks;
+            std::vector<char> chunk_succeeded(num_chunks, 0);
+
+            ParallelFor(num_chunks, 0, num_chunks, [&](int /*thread_id*/, int64_t chunk) {
+                const int begin = static_cast<int>(chunk) * chunk_size;
+                const int end = std::min(num_candidates, begin + chunk_size);
+                chunk_succeeded[chunk] = begin >= end ||
+                                         problem.EvaluateBatch(end - begin,
+                                                               parameters + static_cast<ptrdiff_t>(begin) * num_parameters,
+                                                               costs + begin);
+            });
+
+            return std::find(chunk_succeeded.begin(), chunk_succeeded.end(), 0) == chunk_succeeded.end();
+        }
+
+    } // namespace internal
+} // namespace pallas
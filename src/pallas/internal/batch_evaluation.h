@@ -0,0 +1,58 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_INTERNAL_BATCH_EVALUATION_H
+#define PALLAS_INTERNAL_BATCH_EVALUATION_H
+
+#include "pallas/gradient_problem.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Evaluates the cost of a block of candidates, splitting the block over several threads.
+         * @details The candidates are divided into at most `num_threads` contiguous chunks and each chunk is
+         * passed to `GradientProblem::EvaluateBatch` in a single call. The chunk boundaries only depend on
+         * `num_candidates` and `num_threads`.
+         *
+         * @param problem pallas::GradientProblem. The problem to evaluate.
+         * @param num_candidates int. Number of candidates to evaluate.
+         * @param parameters const double*. Column-major `problem.NumParameters() x num_candidates` block
+         * holding one candidate per column.
+         * @param num_threads int. Maximum number of threads to use.
+         * @param costs double*. Array of length `num_candidates` that receives the cost of each candidate.
+         * @return Returns `true` if every candidate was evaluated successfully, `false` otherwise.
+         */
+        bool EvaluateBatch(const GradientProblem& problem,
+                           int num_candidates,
+                           const double* parameters,
+                           int num_threads,
+                           double* costs);
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_BATCH_EVALUATION_H
@@ -47,47 +47,42 @@ namespace pallas {
             crossover_probability_ = crossover_probability;
         };
 
-        BinomialCrossover::BinomialCrossover(double crossover_probability, unsigned int num_parameters) {
-            scoped_ptr <RandomNumberGenerator<double>> tmp_rng_dbl(new RandomNumberGenerator<double>());
-            swap(random_double_, tmp_rng_dbl);
+        CrossoverStrategy::CrossoverStrategy(double crossover_probability, unsigned int num_parameters)
+                : random_uint_(0, num_parameters - 1),
+                  crossover_probability_(crossover_probability) {
 
-            scoped_ptr <RandomNumberGenerator<unsigned int>> tmp_rng_uint(
-                    new RandomNumberGenerator <unsigned int>(0, num_parameters - 1));
-            swap(random_uint_, tmp_rng_uint);
+        };
+
+        BinomialCrossover::BinomialCrossover(double crossover_probability, unsigned int num_parameters)
+                : CrossoverStrategy(crossover_probability, num_parameters),
+                  uniforms_(num_parameters) {
 
-            crossover_probability_ = crossover_probability;
         };
 
-        void BinomialCrossover::Crossover(Vector &trial, const Vector &bprime) {
-            for (unsigned int i = 0; i < trial.size() - 1; ++i) {
-                if ((*random_double_)() < crossover_probability_) {
+        void BinomialCrossover::Crossover(Eigen::Ref<Vector> trial, const Eigen::Ref<const Vector> &bprime) {
+            random_double_.Fill(uniforms_.data(), trial.size());
+            for (unsigned int i = 0; i < trial.size(); ++i) {
+                if (uniforms_[i] < crossover_probability_) {
                     trial[i] = bprime[i];
                 }
             }
 
             // one random entry in trial will always have a crossover
-            const unsigned int fill_point = (*random_uint_)();
+            const unsigned int fill_point = random_uint_();
             trial[fill_point] = bprime[fill_point];
         };
 
-        ExponentialCrossover::ExponentialCrossover(double crossover_probability, unsigned int num_parameters) {
-            scoped_ptr <RandomNumberGenerator<double>> tmp_rng_dbl(new RandomNumberGenerator<double>());
-            swap(random_double_, tmp_rng_dbl);
+        ExponentialCrossover::ExponentialCrossover(double crossover_probability, unsigned int num_parameters)
+                : CrossoverStrategy(crossover_probability, num_parameters) {
 
-
-            scoped_ptr <RandomNumberGenerator<unsigned int>> tmp_rng_uint(
-                    new RandomNumberGenerator <unsigned int>(0, num_parameters - 1));
-            swap(random_uint_, tmp_rng_uint);
-
-            crossover_probability_ = crossover_probability;
         };
 
-        void ExponentialCrossover::Crossover(Vector &trial, const Vector &bprime) {
+        void ExponentialCrossover::Crossover(Eigen::Ref<Vector> trial, const Eigen::Ref<const Vector> &bprime) {
             unsigned int i = 0;
             const unsigned int num_parameters = trial.size();
-            unsigned int fill_point = (*random_uint_)();
+            unsigned int fill_point = random_uint_();
 
-            while (i < num_parameters && (*random_double_)() < crossover_probability_) {
+            while (i < num_parameters && random_double_() < crossover_probability_) {
                 trial[fill_point] = bprime[fill_point];
                 fill_point = (fill_point + 1) % num_parameters;
                 ++i;
@@ -28,7 +28,6 @@
 #define PALLAS_CROSSOVER_STRATEGY_H
 
 #include "pallas/types.h"
-#include "pallas/scoped_ptr.h"
 #include "pallas/internal/random_number_generator.h"
 
 namespace pallas {
@@ -42,13 +41,15 @@ namespace pallas {
 
             virtual ~CrossoverStrategy() { };
 
-            virtual void Crossover(Vector &trial, const Vector &bprime) = 0;
+            virtual void Crossover(Eigen::Ref<Vector> trial, const Eigen::Ref<const Vector> &bprime) = 0;
 
             void set_crossover_probability(double crossover_probability);
 
         protected:
-            scoped_ptr <RandomNumberGenerator<double>> random_double_;
-            scoped_ptr <RandomNumberGenerator<unsigned int>> random_uint_;
+            CrossoverStrategy(double crossover_probability, unsigned int num_parameters);
+
+            RandomNumberGenerator<double> random_double_;
+            RandomNumberGenerator<unsigned int> random_uint_;
             double crossover_probability_;
         };
 
@@ -56,14 +57,17 @@ namespace pallas {
         public:
             BinomialCrossover(double crossover_probability, unsigned int num_parameters);
 
-            void Crossover(Vector &trial, const Vector &bprime);
+            void Crossover(Eigen::Ref<Vector> trial, const Eigen::Ref<const Vector> &bprime);
+
+        private:
+            Vector uniforms_;
         };
 
         class ExponentialCrossover : public CrossoverStrategy {
         public:
             ExponentialCrossover(double crossover_probability, unsigned int num_parameters);
 
-            void Crossover(Vector &trial, const Vector &bprime);
+            void Crossover(Eigen::Ref<Vector> trial, const Eigen::Ref<const Vector> &bprime);
         };
 
     } // namespace internal
@@ -0,0 +1,57 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include "pallas/internal/batch_evaluation.h"
+#include "pallas/internal/evaluator.h"
+
+namespace pallas {
+    namespace internal {
+
+        Evaluator::Evaluator(const GradientProblem& problem)
+                : problem_(problem),
+                  num_cost_evaluations_(0),
+                  num_gradient_evaluations_(0) {
+
+        };
+
+        bool Evaluator::Evaluate(const double* x, double* cost) {
+            ++num_cost_evaluations_;
+            return problem_.Evaluate(x, cost, NULL);
+        };
+
+        bool Evaluator::Evaluate(const double* x, double* cost, double* gradient) {
+            ++num_gradient_evaluations_;
+            return problem_.Evaluate(x, cost, gradient);
+        };
+
+        bool Evaluator::EvaluateBatch(int num_candidates, const double* parameters, int num_threads, double* costs) {
+            num_cost_evaluations_ += num_candidates;
+            return internal::EvaluateBatch(problem_, num_candidates, parameters, num_threads, costs);
+        };
+
+    } // namespace internal
+} // namespace pallas
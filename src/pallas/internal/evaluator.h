@@ -0,0 +1,80 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_INTERNAL_EVALUATOR_H
+#define PALLAS_INTERNAL_EVALUATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include "pallas/gradient_problem.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Evaluates a problem on behalf of a solver, computing gradients only on request.
+         * @details Every evaluation a solver performs outside of local minimization goes through an evaluator.
+         * Callers that only compare costs use the cost-only overloads, so the cost function is called with a
+         * `NULL` gradient and can skip computing it. The number of cost-only and cost and gradient evaluations
+         * are counted separately for the solver summaries. Counting is thread safe and so are the cost-only
+         * overloads; evaluating the gradient is not, since ceres::GradientProblem uses shared scratch space.
+         */
+        class Evaluator {
+        public:
+            explicit Evaluator(const GradientProblem& problem);
+
+            /**
+             * @brief Evaluates the cost at `x`.
+             */
+            bool Evaluate(const double* x, double* cost);
+
+            /**
+             * @brief Evaluates the cost and the gradient at `x`.
+             */
+            bool Evaluate(const double* x, double* cost, double* gradient);
+
+            /**
+             * @brief Evaluates the cost of a block of candidates. See pallas::internal::EvaluateBatch.
+             */
+            bool EvaluateBatch(int num_candidates, const double* parameters, int num_threads, double* costs);
+
+            const GradientProblem& problem() const { return problem_; }
+
+            int64_t num_cost_evaluations() const { return num_cost_evaluations_; }
+
+            int64_t num_gradient_evaluations() const { return num_gradient_evaluations_; }
+
+        private:
+            const GradientProblem& problem_;
+            std::atomic<int64_t> num_cost_evaluations_;/**<Number of cost-only evaluations.*/
+            std::atomic<int64_t> num_gradient_evaluations_;/**<Number of cost and gradient evaluations.*/
+        };
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_EVALUATOR_H
@@ -0,0 +1,88 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include <limits>
+#include "glog/logging.h"
+#include "pallas/internal/grid_decoder.h"
+
+namespace pallas {
+    namespace internal {
+
+        GridDecoder::GridDecoder(const std::vector<Vector>& sample_points)
+                : sample_points_(sample_points),
+                  num_points_(1) {
+            for (size_t i = 0; i < sample_points_.size(); ++i) {
+                const uint64_t size = static_cast<uint64_t>(sample_points_[i].size());
+                CHECK(size > 0) << "Parameter range " << i << " does not contain any sample points.";
+                CHECK(num_points_ <= std::numeric_limits<uint64_t>::max() / size)
+                    << "The number of grid points exceeds the range of a 64 bit index.";
+                num_points_ *= size;
+            }
+        };
+
+        void GridDecoder::Decode(uint64_t index, double* point) const {
+            for (size_t j = sample_points_.size(); j-- > 0;) {
+                const uint64_t size = static_cast<uint64_t>(sample_points_[j].size());
+                point[j] = sample_points_[j][static_cast<int>(index % size)];
+                index /= size;
+            }
+        };
+
+        void GridDecoder::DecodeRange(uint64_t start, int num_points, double* points, int* counters) const {
+            if (num_points <= 0) {
+                return;
+            }
+
+            const size_t num_parameters = sample_points_.size();
+            uint64_t index = start;
+            for (size_t j = num_parameters; j-- > 0;) {
+                const uint64_t size = static_cast<uint64_t>(sample_points_[j].size());
+                counters[j] = static_cast<int>(index % size);
+                points[j] = sample_points_[j][counters[j]];
+                index /= size;
+            }
+
+            for (int i = 1; i < num_points; ++i) {
+                double* point = points + i * num_parameters;
+                const double* previous = point - num_parameters;
+                for (size_t j = 0; j < num_parameters; ++j)
+                    point[j] = previous[j];
+
+                // odometer increment with the last degree of freedom varying fastest
+                for (size_t j = num_parameters; j-- > 0;) {
+                    if (++counters[j] < sample_points_[j].size()) {
+                        point[j] = sample_points_[j][counters[j]];
+                        break;
+                    }
+                    counters[j] = 0;
+                    point[j] = sample_points_[j][0];
+                }
+            }
+        };
+
+    } // namespace internal
+} // namespace pallas
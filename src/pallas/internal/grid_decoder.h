@@ -0,0 +1,87 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_INTERNAL_GRID_DECODER_H
+#define PALLAS_INTERNAL_GRID_DECODER_H
+
+#include <cstdint>
+#include <vector>
+#include "pallas/types.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Maps linear indices of a regular grid to grid points without storing the grid.
+         * @details The grid is the Cartesian product of the sample points of each degree of freedom. Points are
+         * numbered in row-major order, i.e. the last degree of freedom varies fastest. Only the sample points
+         * of each degree of freedom are stored, so any range of indices can be decoded independently of the others.
+         */
+        class GridDecoder {
+        public:
+            /**
+             * @brief Constructor
+             *
+             * @param sample_points std::vector<Vector>. Sample points along each degree of freedom.
+             * The total number of grid points must fit in a 64 bit unsigned integer.
+             */
+            explicit GridDecoder(const std::vector<Vector>& sample_points);
+
+            /**
+             * @brief Returns the total number of grid points.
+             */
+            uint64_t NumPoints() const { return num_points_; }
+
+            /**
+             * @brief Writes the grid point with linear index `index` into `point`.
+             *
+             * @param index uint64_t. Linear index of the grid point. Must be less than `NumPoints()`.
+             * @param point double*. Output array of length equal to the number of degrees of freedom.
+             */
+            void Decode(uint64_t index, double* point) const;
+
+            /**
+             * @brief Writes `num_points` consecutive grid points starting at linear index `start` into `points`.
+             * @details Only the first point is decoded with divisions; the remaining points are produced by
+             * incrementing the per-dimension counters.
+             *
+             * @param start uint64_t. Linear index of the first grid point.
+             * @param num_points int. Number of grid points to write. `start + num_points` must not exceed `NumPoints()`.
+             * @param points double*. Column-major output block with one grid point per column.
+             * @param counters int*. Scratch array with one entry per degree of freedom.
+             */
+            void DecodeRange(uint64_t start, int num_points, double* points, int* counters) const;
+
+        private:
+            std::vector<Vector> sample_points_;
+            uint64_t num_points_;
+        };
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_GRID_DECODER_H
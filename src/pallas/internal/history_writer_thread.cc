@@ -0,0 +1,105 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include "pallas/internal/history_writer_thread.h"
+
+#include <algorithm>
+
+namespace pallas {
+    namespace internal {
+
+        HistoryWriterThread::HistoryWriterThread(unsigned int max_queued_outputs,
+                                                 const std::function<bool(const HistoryConcept&)>& write)
+                : write_(write),
+                  max_queued_outputs_(std::max(1u, max_queued_outputs)),
+                  is_writing_(false),
+                  is_closing_(false),
+                  is_good_(true),
+                  num_outputs_written_(0),
+                  thread_(&HistoryWriterThread::write_outputs_, this) {
+        }
+
+        HistoryWriterThread::~HistoryWriterThread() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                is_closing_ = true;
+            }
+            is_not_empty_.notify_one();
+            thread_.join();
+        }
+
+        void HistoryWriterThread::Append(HistoryConcept history) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                is_not_full_.wait(lock, [this] { return queue_.size() < max_queued_outputs_; });
+                queue_.push_back(std::move(history));
+            }
+            is_not_empty_.notify_one();
+        }
+
+        void HistoryWriterThread::Flush() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            is_idle_.wait(lock, [this] { return queue_.empty() && !is_writing_; });
+        }
+
+        bool HistoryWriterThread::IsGood() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return is_good_;
+        }
+
+        uint64_t HistoryWriterThread::NumOutputsWritten() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return num_outputs_written_;
+        }
+
+        void HistoryWriterThread::write_outputs_() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+                is_not_empty_.wait(lock, [this] { return !queue_.empty() || is_closing_; });
+                if (queue_.empty())
+                    break;
+
+                HistoryConcept history = std::move(queue_.front());
+                queue_.pop_front();
+                is_writing_ = true;
+                lock.unlock();
+                is_not_full_.notify_one();
+
+                const bool is_written = write_(history);
+
+                lock.lock();
+                is_writing_ = false;
+                is_good_ = is_good_ && is_written;
+                if (is_written)
+                    ++num_outputs_written_;
+                if (queue_.empty())
+                    is_idle_.notify_all();
+            }
+            is_idle_.notify_all();
+        }
+
+    } // namespace internal
+} // namespace pallas
@@ -0,0 +1,103 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_INTERNAL_HISTORY_WRITER_THREAD_H
+#define PALLAS_INTERNAL_HISTORY_WRITER_THREAD_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "pallas/history_concept.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Bounded queue of history outputs drained by a dedicated thread.
+         * @details Used by the streaming history sinks to keep the encoding and disk writes off the solver thread.
+         * Every appended output is passed to `write` on the writer thread, in the order it was appended. At most
+         * `max_queued_outputs` outputs are queued; `Append` blocks while the queue is full. The destructor
+         * writes the remaining outputs and joins the thread, so an owner that declares the writer thread as its
+         * last member can safely use its other members in `write`.
+         */
+        class HistoryWriterThread {
+        public:
+            /**
+             * @brief Constructor
+             *
+             * @param max_queued_outputs unsigned int. Maximum number of outputs waiting to be written.
+             * @param write std::function. Writes one output and returns `false` if the write failed.
+             */
+            HistoryWriterThread(unsigned int max_queued_outputs,
+                                const std::function<bool(const HistoryConcept&)>& write);
+
+            ~HistoryWriterThread();
+
+            /**
+             * @brief Queues `history` to be written, blocking while the queue is full.
+             */
+            void Append(HistoryConcept history);
+
+            /**
+             * @brief Blocks until every output appended so far has been written.
+             */
+            void Flush();
+
+            /**
+             * @brief Whether every write so far succeeded.
+             */
+            bool IsGood() const;
+
+            /**
+             * @brief Number of outputs written successfully.
+             */
+            uint64_t NumOutputsWritten() const;
+
+        private:
+            void write_outputs_();
+
+            std::function<bool(const HistoryConcept&)> write_;/**<Writes one output on the writer thread.*/
+            unsigned int max_queued_outputs_;/**<Maximum number of outputs in `queue_`.*/
+            std::deque<HistoryConcept> queue_;/**<Outputs waiting to be written, oldest first.*/
+            mutable std::mutex mutex_;/**<Guards all of the members below.*/
+            std::condition_variable is_not_empty_;/**<Signalled when an output is queued or the thread is stopping.*/
+            std::condition_variable is_not_full_;/**<Signalled when the writer takes an output off the queue.*/
+            std::condition_variable is_idle_;/**<Signalled when the writer has written everything queued.*/
+            bool is_writing_;/**<Whether the writer holds an output taken off the queue.*/
+            bool is_closing_;/**<Set by the destructor to stop the writer.*/
+            bool is_good_;/**<Whether every write so far succeeded.*/
+            uint64_t num_outputs_written_;/**<Number of outputs written successfully.*/
+            std::thread thread_;/**<Thread running `write_outputs_`. Started last, after the members it uses.*/
+        };
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_HISTORY_WRITER_THREAD_H
@@ -0,0 +1,85 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_INTERNAL_INDEX_SAMPLER_H
+#define PALLAS_INTERNAL_INDEX_SAMPLER_H
+
+#include "pallas/internal/random_number_generator.h"
+
+namespace pallas {
+    namespace internal {
+        /**
+         * @brief Draws a few distinct population indices that differ from a target index.
+         * @details Uses rejection sampling: each draw is repeated until it differs from the target and from the
+         * indices already drawn. For the handful of indices required by the mutation strategies this costs
+         * O(k^2) comparisons and O(k) draws on average, independent of the population size, whereas
+         * shuffling the whole population costs O(NP). The population must contain at least `num_samples + 1`
+         * members.
+         */
+        class IndexSampler {
+        public:
+            IndexSampler(unsigned int population_size)
+                    : random_idx_(0, population_size - 1) {
+
+            };
+
+            /**
+            * @brief Restarts the sampler on its own random stream of `seed`.
+            */
+            void seed(uint64_t seed, unsigned int thread_id = 0) {
+                random_idx_.seed(seed, INDEX_SAMPLER_STREAM, thread_id);
+            };
+
+            /**
+             * @brief Writes `num_samples` distinct indices, none equal to `target`, into `samples`.
+             *
+             * @param target unsigned int. Index that must not be drawn.
+             * @param num_samples unsigned int. Number of indices to draw.
+             * @param samples int*. Output array of length `num_samples`.
+             */
+            void Sample(unsigned int target, unsigned int num_samples, int* samples) {
+                for (unsigned int k = 0; k < num_samples; ++k) {
+                    unsigned int idx;
+                    bool is_duplicate;
+                    do {
+                        idx = random_idx_();
+                        is_duplicate = idx == target;
+                        for (unsigned int j = 0; j < k && !is_duplicate; ++j)
+                            is_duplicate = static_cast<unsigned int>(samples[j]) == idx;
+                    } while (is_duplicate);
+                    samples[k] = static_cast<int>(idx);
+                }
+            };
+
+        private:
+            RandomNumberGenerator<unsigned int> random_idx_;
+        };
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_INDEX_SAMPLER_H
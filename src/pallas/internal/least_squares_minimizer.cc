@@ -0,0 +1,133 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "glog/logging.h"
+#include "pallas/internal/least_squares_minimizer.h"
+
+namespace pallas {
+    namespace internal {
+
+        namespace {
+
+            class CountingCostFunction : public LeastSquaresCostFunction {
+            public:
+                explicit CountingCostFunction(const LeastSquaresCostFunction* cost_function)
+                        : cost_function_(cost_function),
+                          num_residual_evaluations_(0),
+                          num_jacobian_evaluations_(0) {
+                    *mutable_parameter_block_sizes() = cost_function->parameter_block_sizes();
+                    set_num_residuals(cost_function->num_residuals());
+                }
+
+                virtual bool Evaluate(double const* const* parameters,
+                                      double* residuals,
+                                      double** jacobians) const {
+                    ++num_residual_evaluations_;
+                    if (jacobians != NULL)
+                        ++num_jacobian_evaluations_;
+                    return cost_function_->Evaluate(parameters, residuals, jacobians);
+                }
+
+                int num_residual_evaluations() const { return num_residual_evaluations_; }
+
+                int num_jacobian_evaluations() const { return num_jacobian_evaluations_; }
+
+            private:
+                const LeastSquaresCostFunction* cost_function_;
+                mutable std::atomic<int> num_residual_evaluations_;
+                mutable std::atomic<int> num_jacobian_evaluations_;
+            };
+
+        } // namespace
+
+        void MinimizeLeastSquares(const LeastSquaresLocalMinimizer::Options& options,
+                                  const GradientProblem& problem,
+                                  const double* lower_bounds,
+                                  const double* upper_bounds,
+                                  double* parameters,
+                                  GradientLocalMinimizer::Summary* summary) {
+            CHECK_EQ(problem.cost_function_type(), LEAST_SQUARES)
+                << "The problem was not built from a least squares cost function.";
+
+            CountingCostFunction cost_function(problem.least_squares_function());
+            const std::vector<int>& block_sizes = cost_function.parameter_block_sizes();
+            std::vector<double*> parameter_blocks(block_sizes.size());
+            int offset = 0;
+            for (unsigned int i = 0; i < block_sizes.size(); ++i) {
+                parameter_blocks[i] = parameters + offset;
+                offset += block_sizes[i];
+            }
+
+            LeastSquaresProblem::Options problem_options;
+            problem_options.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+            problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+            problem_options.local_parameterization_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+            LeastSquaresProblem least_squares_problem(problem_options);
+            least_squares_problem.AddResidualBlock(&cost_function,
+                                                   const_cast<ceres::LossFunction*>(problem.loss_function()),
+                                                   parameter_blocks);
+            if (problem.parameterization() != NULL) {
+                least_squares_problem.SetParameterization(
+                        parameters, const_cast<ceres::LocalParameterization*>(problem.parameterization()));
+            }
+            if (lower_bounds != NULL) {
+                for (unsigned int i = 0; i < block_sizes.size(); ++i) {
+                    const int block_offset = static_cast<int>(parameter_blocks[i] - parameters);
+                    for (int j = 0; j < block_sizes[i]; ++j) {
+                        double& value = parameter_blocks[i][j];
+                        value = std::min(std::max(value, lower_bounds[block_offset + j]), upper_bounds[block_offset + j]);
+                        least_squares_problem.SetParameterLowerBound(parameter_blocks[i], j, lower_bounds[block_offset + j]);
+                        least_squares_problem.SetParameterUpperBound(parameter_blocks[i], j, upper_bounds[block_offset + j]);
+                    }
+                }
+            }
+
+            LeastSquaresLocalMinimizer::Summary least_squares_summary;
+            LeastSquaresLocalMinimizer local_minimizer;
+            local_minimizer.Solve(options, &least_squares_problem, &least_squares_summary);
+
+            summary->termination_type = least_squares_summary.termination_type;
+            summary->message = least_squares_summary.message;
+            summary->initial_cost = least_squares_summary.initial_cost;
+            summary->final_cost = least_squares_summary.final_cost;
+            summary->iterations.swap(least_squares_summary.iterations);
+            summary->num_cost_evaluations = cost_function.num_residual_evaluations() -
+                                            cost_function.num_jacobian_evaluations();
+            summary->num_gradient_evaluations = cost_function.num_jacobian_evaluations();
+            summary->total_time_in_seconds = least_squares_summary.total_time_in_seconds;
+            summary->cost_evaluation_time_in_seconds = least_squares_summary.residual_evaluation_time_in_seconds;
+            summary->gradient_evaluation_time_in_seconds = least_squares_summary.jacobian_evaluation_time_in_seconds;
+            summary->num_parameters = problem.NumParameters();
+            summary->num_local_parameters = problem.NumLocalParameters();
+        };
+
+    } // namespace internal
+} // namespace pallas
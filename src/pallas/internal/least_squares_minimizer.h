@@ -0,0 +1,64 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_INTERNAL_LEAST_SQUARES_MINIMIZER_H
+#define PALLAS_INTERNAL_LEAST_SQUARES_MINIMIZER_H
+
+#include "pallas/gradient_problem.h"
+#include "pallas/types.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Locally minimizes a problem built from residuals with `LeastSquaresLocalMinimizer`.
+         * @details The residuals, loss function and local parameterization of `problem` are added to a new
+         * `LeastSquaresProblem` without handing over their ownership, with one parameter block per parameter block
+         * of the residuals pointing into `parameters`. The result is reported in a
+         * `GradientLocalMinimizer::Summary` so the solvers can treat both kinds of local minimization alike; the
+         * cost and gradient evaluation counts are the number of residual evaluations without and with jacobians.
+         * If bounds are given `parameters` is projected into them first, since ceres requires a feasible start.
+         *
+         * @param options LeastSquaresLocalMinimizer::Options. Options of the minimization, including its linear
+         * solver and number of threads.
+         * @param problem pallas::GradientProblem. The problem to minimize, its cost function type must be `LEAST_SQUARES`.
+         * @param lower_bounds const double*. Lower bound of each parameter, `NULL` if the parameters are unbounded.
+         * @param upper_bounds const double*. Upper bound of each parameter, `NULL` if the parameters are unbounded.
+         * @param parameters double*. The starting point, overwritten with the minimum.
+         * @param summary GradientLocalMinimizer::Summary*. Summary of the minimization.
+         */
+        void MinimizeLeastSquares(const LeastSquaresLocalMinimizer::Options& options,
+                                  const GradientProblem& problem,
+                                  const double* lower_bounds,
+                                  const double* upper_bounds,
+                                  double* parameters,
+                                  GradientLocalMinimizer::Summary* summary);
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_LEAST_SQUARES_MINIMIZER_H
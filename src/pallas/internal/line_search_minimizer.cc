@@ -0,0 +1,453 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "glog/logging.h"
+
+#include "pallas/internal/least_squares_minimizer.h"
+#include "pallas/internal/line_search_minimizer.h"
+#include "pallas/internal/solver_utils.h"
+#include "pallas/internal/wall_time.h"
+
+namespace pallas {
+    namespace internal {
+
+        namespace {
+
+            /**
+             * @brief Runs the user callbacks and returns `false` if one of them asked to stop.
+             */
+            bool RunCallbacks(const GradientLocalMinimizer::Options& options,
+                              const ceres::IterationSummary& iteration_summary,
+                              GradientLocalMinimizer::Summary* summary) {
+                for (size_t i = 0; i < options.callbacks.size(); ++i) {
+                    switch ((*options.callbacks[i])(iteration_summary)) {
+                        case ceres::SOLVER_ABORT:
+                            summary->termination_type = TerminationType::USER_FAILURE;
+                            summary->message = "User callback returned SOLVER_ABORT.";
+                            return false;
+                        case ceres::SOLVER_TERMINATE_SUCCESSFULLY:
+                            summary->termination_type = TerminationType::USER_SUCCESS;
+                            summary->message = "User callback returned SOLVER_TERMINATE_SUCCESSFULLY.";
+                            return false;
+                        default:
+                            break;
+                    }
+                }
+                return true;
+            }
+
+        }  // namespace
+
+        void LineSearchMinimizer::Minimize(const GradientLocalMinimizer::Options& options,
+                                      const GradientProblem& problem,
+                                      double* parameters,
+                                      GradientLocalMinimizer::Summary* summary) {
+            const double start_time = WallTimeInSeconds();
+            const int num_parameters = problem.NumParameters();
+            const int num_local_parameters = problem.NumLocalParameters();
+            const LineSearchDirectionType direction_type = DirectionType(options.line_search_direction_type);
+            if (lower_bounds_ != NULL) {
+                CHECK(problem.parameterization() == NULL)
+                    << "Bounds can not be used with a local parameterization.";
+            }
+            resize_(num_parameters, num_local_parameters, std::max(1, options.max_lbfgs_rank), direction_type);
+
+            summary->termination_type = TerminationType::FAILURE;
+            summary->iterations.clear();
+            summary->num_cost_evaluations = 0;
+            summary->num_gradient_evaluations = 0;
+            summary->cost_evaluation_time_in_seconds = 0.0;
+            summary->gradient_evaluation_time_in_seconds = 0.0;
+            summary->num_parameters = num_parameters;
+            summary->num_local_parameters = num_local_parameters;
+            summary->line_search_direction_type = direction_type;
+
+            x_ = ConstVectorRef(parameters, num_parameters);
+            project_(&x_);
+            double cost;
+            if (!evaluate_(problem, x_, &cost, &gradient_, summary)) {
+                summary->message = "Initial cost and gradient evaluation failed.";
+                summary->initial_cost = summary->final_cost = -1.0;
+                summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
+                return;
+            }
+            summary->initial_cost = cost;
+
+            ceres::IterationSummary iteration_summary;
+            iteration_summary.cost = cost;
+            reduce_gradient_(&iteration_summary);
+            iteration_summary.cumulative_time_in_seconds = WallTimeInSeconds() - start_time;
+
+            bool is_converged = false;
+            int num_small_steps = 0;
+            while (true) {
+                summary->iterations.push_back(iteration_summary);
+                if (!RunCallbacks(options, iteration_summary, summary) || is_converged)
+                    break;
+
+                if (iteration_summary.gradient_max_norm <= options.gradient_tolerance) {
+                    summary->termination_type = TerminationType::CONVERGENCE;
+                    summary->message = "Gradient tolerance reached.";
+                    break;
+                }
+                if (iteration_summary.iteration >= options.max_num_iterations) {
+                    summary->termination_type = TerminationType::NO_CONVERGENCE;
+                    summary->message = "Maximum number of iterations reached.";
+                    break;
+                }
+                if (WallTimeInSeconds() - start_time >= options.max_solver_time_in_seconds) {
+                    summary->termination_type = TerminationType::NO_CONVERGENCE;
+                    summary->message = "Maximum solver time reached.";
+                    break;
+                }
+
+                const double iteration_start_time = WallTimeInSeconds();
+                double trial_cost;
+
+                // without curvature information the first step moves the largest coordinate by one
+                const double steepest_descent_step_size = 1.0 / iteration_summary.gradient_max_norm;
+                bool has_step = line_search_(options, problem, cost, history_.size > 0,
+                                             history_.size > 0 ? 1.0 : steepest_descent_step_size,
+                                             &trial_cost, &iteration_summary, summary);
+                if (!has_step && history_.size > 0) {
+                    // the history may describe another basin, retry along steepest descent
+                    has_step = line_search_(options, problem, cost, false, steepest_descent_step_size,
+                                            &trial_cost, &iteration_summary, summary);
+                }
+                if (!has_step && iteration_summary.iteration == 0) {
+                    summary->termination_type = TerminationType::FAILURE;
+                    summary->message = "Line search failed to find a step that sufficiently decreases the cost.";
+                    break;
+                }
+                if (!has_step) {
+                    // near the minimum the cost changes by less than its round off error
+                    summary->termination_type = TerminationType::CONVERGENCE;
+                    summary->message = "Line search could not decrease the cost any further.";
+                    break;
+                }
+
+                gradient_change_ = gradient_trial_ - gradient_;
+                update_history_();
+                x_.swap(x_trial_);
+                gradient_.swap(gradient_trial_);
+
+                const double previous_cost = cost;
+                cost = trial_cost;
+
+                ++iteration_summary.iteration;
+                iteration_summary.step_is_valid = true;
+                iteration_summary.step_is_successful = true;
+                iteration_summary.cost = cost;
+                iteration_summary.cost_change = previous_cost - cost;
+                reduce_gradient_(&iteration_summary);
+                iteration_summary.step_norm = step_.norm();
+                iteration_summary.iteration_time_in_seconds = WallTimeInSeconds() - iteration_start_time;
+                iteration_summary.cumulative_time_in_seconds = WallTimeInSeconds() - start_time;
+
+                // steepest descent steps are arbitrarily scaled and a young quasi-Newton model may not have seen the
+                // curvature along the valley yet, so the parameters only converged once two consecutive quasi-Newton
+                // steps put the minimum of the model within the tolerance
+                const bool is_small_step = is_quasi_newton_step_ &&
+                        direction_.norm() <= options.parameter_tolerance * (x_.norm() + options.parameter_tolerance);
+                num_small_steps = is_small_step ? num_small_steps + 1 : 0;
+                if (num_small_steps >= 2) {
+                    summary->termination_type = TerminationType::CONVERGENCE;
+                    summary->message = "Parameter tolerance reached.";
+                    is_converged = true;
+                } else if (std::abs(iteration_summary.cost_change) <= options.function_tolerance * std::abs(previous_cost)) {
+                    summary->termination_type = TerminationType::CONVERGENCE;
+                    summary->message = "Function tolerance reached.";
+                    is_converged = true;
+                }
+            }
+
+            summary->final_cost = cost;
+            if (IsSolutionUsable(summary))
+                VectorRef(parameters, num_parameters) = x_;
+            summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
+        };
+
+        void LineSearchMinimizer::ClearHistory() {
+            history_.size = 0;
+            history_.newest = -1;
+        };
+
+        void LineSearchMinimizer::set_bounds(const double* lower_bounds, const double* upper_bounds) {
+            CHECK((lower_bounds == NULL) == (upper_bounds == NULL))
+                << "Both or neither of the lower and upper bounds must be given.";
+            lower_bounds_ = lower_bounds;
+            upper_bounds_ = upper_bounds;
+        };
+
+        LineSearchDirectionType LineSearchMinimizer::DirectionType(LineSearchDirectionType requested) {
+            if (requested == ceres::STEEPEST_DESCENT || requested == ceres::BFGS)
+                return requested;
+            return ceres::LBFGS;
+        };
+
+        void LineSearchMinimizer::resize_(int num_parameters,
+                                          int num_local_parameters,
+                                          int max_rank,
+                                          LineSearchDirectionType direction_type) {
+            bool is_stale = history_.direction_type != direction_type;
+            if (direction_type == ceres::LBFGS) {
+                is_stale = is_stale || history_.s.rows() != num_local_parameters || history_.s.cols() != max_rank;
+            } else if (direction_type == ceres::BFGS) {
+                is_stale = is_stale || history_.inverse_hessian.rows() != num_local_parameters;
+            }
+
+            if (is_stale) {
+                history_.direction_type = direction_type;
+                if (direction_type == ceres::LBFGS) {
+                    history_.s.resize(num_local_parameters, max_rank);
+                    history_.y.resize(num_local_parameters, max_rank);
+                    history_.rho.resize(max_rank);
+                } else if (direction_type == ceres::BFGS) {
+                    history_.inverse_hessian.resize(num_local_parameters, num_local_parameters);
+                }
+                ClearHistory();
+            }
+            // the scratch space is sized on every call because a history of matching size may have been handed
+            // over through set_history(), in which case the branch above is skipped
+            if (direction_type == ceres::LBFGS) {
+                alpha_.resize(max_rank);
+            } else if (direction_type == ceres::BFGS) {
+                inverse_hessian_times_change_.resize(num_local_parameters);
+            }
+            x_.resize(num_parameters);
+            x_trial_.resize(num_parameters);
+            gradient_.resize(num_local_parameters);
+            reduced_gradient_.resize(num_local_parameters);
+            gradient_trial_.resize(num_local_parameters);
+            direction_.resize(num_local_parameters);
+            step_.resize(num_local_parameters);
+            gradient_change_.resize(num_local_parameters);
+        };
+
+        bool LineSearchMinimizer::evaluate_(const GradientProblem& problem,
+                                       const Vector& x,
+                                       double* cost,
+                                       Vector* gradient,
+                                       GradientLocalMinimizer::Summary* summary) {
+            const double start_time = WallTimeInSeconds();
+            const bool is_evaluated = problem.Evaluate(x.data(), cost, gradient->data());
+            summary->gradient_evaluation_time_in_seconds += WallTimeInSeconds() - start_time;
+            ++summary->num_cost_evaluations;
+            ++summary->num_gradient_evaluations;
+            return is_evaluated && std::isfinite(*cost);
+        };
+
+        void LineSearchMinimizer::project_(Vector* x) const {
+            if (lower_bounds_ == NULL)
+                return;
+            for (int i = 0; i < x->size(); ++i)
+                (*x)[i] = std::min(std::max((*x)[i], lower_bounds_[i]), upper_bounds_[i]);
+        };
+
+        bool LineSearchMinimizer::is_active_(int i) const {
+            return lower_bounds_ != NULL &&
+                   ((x_[i] <= lower_bounds_[i] && gradient_[i] > 0.0) ||
+                    (x_[i] >= upper_bounds_[i] && gradient_[i] < 0.0));
+        };
+
+        void LineSearchMinimizer::reduce_gradient_(ceres::IterationSummary* iteration_summary) {
+            reduced_gradient_ = gradient_;
+            if (lower_bounds_ != NULL) {
+                for (int i = 0; i < reduced_gradient_.size(); ++i) {
+                    if (is_active_(i))
+                        reduced_gradient_[i] = 0.0;
+                }
+            }
+            iteration_summary->gradient_max_norm = reduced_gradient_.lpNorm<Eigen::Infinity>();
+            iteration_summary->gradient_norm = reduced_gradient_.norm();
+        };
+
+        void LineSearchMinimizer::compute_direction_() {
+            if (history_.direction_type == ceres::BFGS) {
+                direction_.noalias() = history_.inverse_hessian * reduced_gradient_;
+                direction_ *= -1.0;
+                return;
+            }
+
+            const int max_rank = static_cast<int>(history_.s.cols());
+            direction_ = reduced_gradient_;
+
+            int i = history_.newest;
+            for (int k = 0; k < history_.size; ++k, i = (i + max_rank - 1) % max_rank) {
+                alpha_[i] = history_.rho[i] * history_.s.col(i).dot(direction_);
+                direction_ -= alpha_[i] * history_.y.col(i);
+            }
+
+            if (history_.size > 0) {
+                // scale the initial inverse Hessian by s'y / y'y of the newest pair
+                const double y_norm2 = history_.y.col(history_.newest).squaredNorm();
+                direction_ /= history_.rho[history_.newest] * y_norm2;
+            }
+
+            i = (history_.newest - history_.size + 1 + max_rank) % max_rank;
+            for (int k = 0; k < history_.size; ++k, i = (i + 1) % max_rank) {
+                const double beta = history_.rho[i] * history_.y.col(i).dot(direction_);
+                direction_ += (alpha_[i] - beta) * history_.s.col(i);
+            }
+            direction_ *= -1.0;
+        };
+
+        bool LineSearchMinimizer::line_search_(const GradientLocalMinimizer::Options& options,
+                                          const GradientProblem& problem,
+                                          double cost,
+                                          bool use_history,
+                                          double initial_step_size,
+                                          double* trial_cost,
+                                          ceres::IterationSummary* iteration_summary,
+                                          GradientLocalMinimizer::Summary* summary) {
+            double directional_derivative = 0.0;
+            if (use_history) {
+                compute_direction_();
+                if (lower_bounds_ != NULL) {
+                    for (int i = 0; i < direction_.size(); ++i) {
+                        if (is_active_(i))
+                            direction_[i] = 0.0;
+                    }
+                }
+                directional_derivative = gradient_.dot(direction_);
+            }
+            is_quasi_newton_step_ = directional_derivative < 0.0;
+            if (!is_quasi_newton_step_) {
+                direction_ = -reduced_gradient_;
+                directional_derivative = -reduced_gradient_.squaredNorm();
+            }
+            const double direction_max_norm = direction_.lpNorm<Eigen::Infinity>();
+
+            double step_size = initial_step_size;
+            iteration_summary->line_search_iterations = 0;
+            while (iteration_summary->line_search_iterations < options.max_num_line_search_step_size_iterations &&
+                   step_size * direction_max_norm >= options.min_line_search_step_size) {
+                ++iteration_summary->line_search_iterations;
+                step_ = step_size * direction_;
+                double linear_decrease = step_size * directional_derivative;
+                bool is_valid;
+                if (lower_bounds_ == NULL) {
+                    is_valid = problem.Plus(x_.data(), step_.data(), x_trial_.data()) &&
+                               evaluate_(problem, x_trial_, trial_cost, &gradient_trial_, summary);
+                } else {
+                    // follow the projection of the search direction onto the bounds
+                    x_trial_ = x_ + step_;
+                    project_(&x_trial_);
+                    step_ = x_trial_ - x_;
+                    linear_decrease = gradient_.dot(step_);
+                    is_valid = linear_decrease < 0.0 &&
+                               evaluate_(problem, x_trial_, trial_cost, &gradient_trial_, summary);
+                }
+                if (is_valid &&
+                    *trial_cost <= cost + options.line_search_sufficient_function_decrease * linear_decrease) {
+                    iteration_summary->step_size = step_size;
+                    iteration_summary->line_search_function_evaluations = iteration_summary->line_search_iterations;
+                    iteration_summary->line_search_gradient_evaluations = iteration_summary->line_search_iterations;
+                    return true;
+                }
+
+                // minimize the quadratic through the cost, its slope at the current point and the trial cost
+                double next_step_size = options.max_line_search_step_contraction * step_size;
+                if (is_valid) {
+                    const double curvature = *trial_cost - cost - directional_derivative * step_size;
+                    if (curvature > 0.0)
+                        next_step_size = -0.5 * directional_derivative * step_size * step_size / curvature;
+                }
+                step_size = std::min(std::max(next_step_size, options.max_line_search_step_contraction * step_size),
+                                     options.min_line_search_step_contraction * step_size);
+            }
+            return false;
+        };
+
+        void LineSearchMinimizer::update_history_() {
+            const double curvature = step_.dot(gradient_change_);
+            if (history_.direction_type == ceres::STEEPEST_DESCENT ||
+                !(curvature > std::numeric_limits<double>::epsilon() * step_.norm() * gradient_change_.norm()))
+                return;
+            const double rho = 1.0 / curvature;
+
+            if (history_.direction_type == ceres::LBFGS) {
+                const int max_rank = static_cast<int>(history_.s.cols());
+                history_.newest = (history_.newest + 1) % max_rank;
+                history_.s.col(history_.newest) = step_;
+                history_.y.col(history_.newest) = gradient_change_;
+                history_.rho[history_.newest] = rho;
+                history_.size = std::min(history_.size + 1, max_rank);
+                return;
+            }
+
+            Matrix& inverse_hessian = history_.inverse_hessian;
+            if (history_.size == 0) {
+                inverse_hessian.setIdentity();
+                inverse_hessian *= curvature / gradient_change_.squaredNorm();
+            }
+
+            // H += (rho + rho^2 y'Hy) ss' - rho (Hy s' + s y'H)
+            inverse_hessian_times_change_.noalias() = inverse_hessian * gradient_change_;
+            const double ss_coefficient = rho + rho * rho * gradient_change_.dot(inverse_hessian_times_change_);
+            const int num_local_parameters = static_cast<int>(inverse_hessian.rows());
+            for (int j = 0; j < num_local_parameters; ++j) {
+                for (int i = 0; i < num_local_parameters; ++i) {
+                    inverse_hessian(i, j) += ss_coefficient * step_[i] * step_[j] -
+                                             rho * (inverse_hessian_times_change_[i] * step_[j] +
+                                                    step_[i] * inverse_hessian_times_change_[j]);
+                }
+            }
+            ++history_.size;
+        };
+
+        void MinimizeLocally(LocalMinimizerType type,
+                             const GradientLocalMinimizer::Options& options,
+                             const LeastSquaresLocalMinimizer::Options& least_squares_options,
+                             const GradientProblem& problem,
+                             const double* lower_bounds,
+                             const double* upper_bounds,
+                             double* parameters,
+                             GradientLocalMinimizer::Summary* summary) {
+            if (problem.parameterization() != NULL) {
+                lower_bounds = NULL;
+                upper_bounds = NULL;
+            }
+
+            if (problem.cost_function_type() == LEAST_SQUARES) {
+                MinimizeLeastSquares(least_squares_options, problem, lower_bounds, upper_bounds, parameters, summary);
+            } else if (type == PALLAS_LOCAL_MINIMIZER || lower_bounds != NULL) {
+                LineSearchMinimizer local_minimizer;
+                local_minimizer.set_bounds(lower_bounds, upper_bounds);
+                local_minimizer.Minimize(options, problem, parameters, summary);
+            } else {
+                GradientLocalMinimizer local_minimizer;
+                local_minimizer.Solve(options, problem, parameters, summary);
+            }
+        };
+
+    } // namespace internal
+} // namespace pallas
@@ -0,0 +1,238 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_INTERNAL_LINE_SEARCH_MINIMIZER_H
+#define PALLAS_INTERNAL_LINE_SEARCH_MINIMIZER_H
+
+#include "pallas/gradient_problem.h"
+#include "pallas/types.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Reusable line search local minimizer with preallocated workspaces.
+         * @details Unlike `GradientLocalMinimizer`, which validates its options, builds its reports and allocates
+         * its workspace on every call, this minimizer keeps its workspace and its inverse Hessian approximation
+         * between calls. Once it has minimized a problem, further minimizations of problems of the same size do not
+         * allocate (apart from growing the iteration list of a new summary) and start from the curvature left by
+         * the previous call (see `ClearHistory` and `set_history`).\n
+
+           The search direction is `LBFGS`, `BFGS` (a dense inverse Hessian, worthwhile for a few dozen parameters
+           or less) or `STEEPEST_DESCENT`; `NONLINEAR_CONJUGATE_GRADIENT` is run as `LBFGS`. The step size is found by
+           a backtracking Armijo line search. The tolerances, iteration and time limits, `max_lbfgs_rank`, line
+           search step limits and callbacks of `GradientLocalMinimizer::Options` are honoured with the same meaning
+           as in ceres, and the summary is filled like the one of `GradientLocalMinimizer`.\n
+
+           If bounds are set (see `set_bounds`) the minimization is a projected quasi-Newton method in the spirit of
+           L-BFGS-B: the starting point is projected into the bounds, the search direction leaves the parameters that
+           sit on a bound and are pushed against it untouched, and every trial point of the line search is projected
+           back into the bounds, so the cost is never evaluated outside of them. The reported gradient norms are the
+           ones of this reduced gradient, which vanishes at a constrained minimum.
+         */
+        class LineSearchMinimizer {
+        public:
+            /**
+             * @brief Curvature information approximating the inverse Hessian.
+             */
+            struct History {
+                /**
+                 * @brief Default constructor
+                 */
+                History() : direction_type(ceres::LBFGS), size(0), newest(-1) {}
+
+                LineSearchDirectionType direction_type;/**<Search direction the history was built for.*/
+                Matrix s;/**<L-BFGS steps, one per column. Used as a circular buffer.*/
+                Matrix y;/**<L-BFGS gradient changes over the steps, one per column.*/
+                Vector rho;/**<Inverse of the inner product of each L-BFGS step and its gradient change.*/
+                Matrix inverse_hessian;/**<Dense BFGS inverse Hessian approximation.*/
+                int size;/**<Number of stored L-BFGS pairs or number of BFGS updates.*/
+                int newest;/**<Column of the most recent L-BFGS pair, -1 if there is none.*/
+            };
+
+            /**
+             * @brief Default constructor
+             */
+            LineSearchMinimizer()
+                    : lower_bounds_(NULL),
+                      upper_bounds_(NULL),
+                      is_quasi_newton_step_(false) {}
+
+            /**
+             * @brief Minimizes `problem` starting from `parameters`.
+             * @details The minimum is stored in `parameters` if the solution is usable (see
+             * `GradientLocalMinimizer::Summary::IsSolutionUsable`).
+             *
+             * @param options GradientLocalMinimizer::Options. Options of the minimization.
+             * @param problem pallas::GradientProblem. The problem to minimize.
+             * @param parameters double*. The starting point, overwritten with the minimum.
+             * @param summary GradientLocalMinimizer::Summary*. Summary of the minimization.
+             */
+            void Minimize(const GradientLocalMinimizer::Options& options,
+                          const GradientProblem& problem,
+                          double* parameters,
+                          GradientLocalMinimizer::Summary* summary);
+
+            /**
+             * @brief Forgets the curvature information so the next minimization starts from steepest descent.
+             */
+            void ClearHistory();
+
+            /**
+             * @brief Returns the curvature information left by the last minimization.
+             */
+            const History& history() const { return history_; }
+
+            /**
+             * @brief Replaces the curvature information used to start the next minimization.
+             * @details A history built for another search direction or another problem size is discarded.
+             */
+            void set_history(const History& history) { history_ = history; }
+
+            /**
+             * @brief Restricts the following minimizations to the box between `lower_bounds` and `upper_bounds`.
+             * @details The bounds are not copied and must outlive the minimizations. They can only be used with
+             * problems without a local parameterization. Pass `NULL` for both to minimize without bounds.
+             *
+             * @param lower_bounds const double*. Lower bound of each parameter.
+             * @param upper_bounds const double*. Upper bound of each parameter.
+             */
+            void set_bounds(const double* lower_bounds, const double* upper_bounds);
+
+            /**
+             * @brief Returns the search direction used when `requested` is asked for.
+             */
+            static LineSearchDirectionType DirectionType(LineSearchDirectionType requested);
+
+        private:
+            /**
+             * @brief Sizes the workspace, discarding the history if it does not match the minimization.
+             */
+            void resize_(int num_parameters,
+                         int num_local_parameters,
+                         int max_rank,
+                         LineSearchDirectionType direction_type);
+
+            /**
+             * @brief Evaluates the cost and gradient at `x` and counts the evaluation in the summary.
+             * @return Returns `false` if the evaluation failed or the cost is not finite.
+             */
+            bool evaluate_(const GradientProblem& problem,
+                           const Vector& x,
+                           double* cost,
+                           Vector* gradient,
+                           GradientLocalMinimizer::Summary* summary);
+
+            /**
+             * @brief Clamps `x` between the bounds.
+             */
+            void project_(Vector* x) const;
+
+            /**
+             * @brief Returns whether the `i`th parameter sits on a bound and the gradient pushes it against the bound.
+             */
+            bool is_active_(int i) const;
+
+            /**
+             * @brief Sets the reduced gradient from the gradient at the current point and stores its norms in
+             * `iteration_summary`.
+             */
+            void reduce_gradient_(ceres::IterationSummary* iteration_summary);
+
+            /**
+             * @brief Computes the search direction from the reduced gradient and the history.
+             */
+            void compute_direction_();
+
+            /**
+             * @brief Searches for a step that sufficiently decreases `cost`.
+             * @details Searches along the quasi-Newton direction if `use_history` is `true` and it is a descent
+             * direction, otherwise along steepest descent. On success the trial point, its cost and gradient, and
+             * the step hold the accepted step.
+             *
+             * @return Returns `true` if such a step was found.
+             */
+            bool line_search_(const GradientLocalMinimizer::Options& options,
+                              const GradientProblem& problem,
+                              double cost,
+                              bool use_history,
+                              double initial_step_size,
+                              double* trial_cost,
+                              ceres::IterationSummary* iteration_summary,
+                              GradientLocalMinimizer::Summary* summary);
+
+            /**
+             * @brief Adds the last step and gradient change to the history unless their curvature is not positive.
+             */
+            void update_history_();
+
+            History history_;/**<Curvature information approximating the inverse Hessian.*/
+            const double* lower_bounds_;/**<Non-owning pointer to the lower bounds (`NULL` without bounds).*/
+            const double* upper_bounds_;/**<Non-owning pointer to the upper bounds (`NULL` without bounds).*/
+            Vector x_;/**<Current point.*/
+            Vector x_trial_;/**<Point tried by the line search.*/
+            Vector gradient_;/**<Gradient at the current point.*/
+            Vector reduced_gradient_;/**<Gradient at the current point without the components of the active bounds.*/
+            Vector gradient_trial_;/**<Gradient at the trial point.*/
+            Vector direction_;/**<Search direction.*/
+            Vector step_;/**<Step from the current point to the trial point.*/
+            Vector gradient_change_;/**<Gradient change over the last step.*/
+            Vector alpha_;/**<Coefficients of the L-BFGS two-loop recursion.*/
+            Vector inverse_hessian_times_change_;/**<Product of the BFGS inverse Hessian and the gradient change.*/
+            bool is_quasi_newton_step_;/**<Whether the last line search was along the quasi-Newton direction.*/
+        };
+
+        /**
+         * @brief Locally minimizes `problem` from `parameters` with a new local minimizer of the given type, or with
+         * `LeastSquaresLocalMinimizer` if the problem was built from residuals.
+         * @details If bounds are given the minimization stays within them. `GradientLocalMinimizer` can not enforce
+         * bounds, so bounded gradient problems are always minimized by a pallas::internal::LineSearchMinimizer.
+         * Bounds are ignored for problems with a local parameterization.
+         *
+         * @param type LocalMinimizerType. Local minimizer to use for gradient problems.
+         * @param options GradientLocalMinimizer::Options. Options of the minimization of gradient problems.
+         * @param least_squares_options LeastSquaresLocalMinimizer::Options. Options of the minimization of
+         * least squares problems.
+         * @param problem pallas::GradientProblem. The problem to minimize.
+         * @param lower_bounds const double*. Lower bound of each parameter, `NULL` if the parameters are unbounded.
+         * @param upper_bounds const double*. Upper bound of each parameter, `NULL` if the parameters are unbounded.
+         * @param parameters double*. The starting point, overwritten with the minimum.
+         * @param summary GradientLocalMinimizer::Summary*. Summary of the minimization.
+         */
+        void MinimizeLocally(LocalMinimizerType type,
+                             const GradientLocalMinimizer::Options& options,
+                             const LeastSquaresLocalMinimizer::Options& least_squares_options,
+                             const GradientProblem& problem,
+                             const double* lower_bounds,
+                             const double* upper_bounds,
+                             double* parameters,
+                             GradientLocalMinimizer::Summary* summary);
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_LINE_SEARCH_MINIMIZER_H
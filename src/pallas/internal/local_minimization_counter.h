@@ -0,0 +1,74 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_INTERNAL_LOCAL_MINIMIZATION_COUNTER_H
+#define PALLAS_INTERNAL_LOCAL_MINIMIZATION_COUNTER_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "pallas/types.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Iterations and evaluations of local minimizations, added up from their summaries.
+         */
+        struct LocalMinimizationCounter {
+            LocalMinimizationCounter()
+                    : num_iterations(0),
+                      num_cost_evaluations(0),
+                      num_gradient_evaluations(0) {}
+
+            /**
+             * @brief Adds the work reported by the summary of a local minimization.
+             * @details The counts of a summary whose minimization did not run are negative and ignored.
+             */
+            void Add(const GradientLocalMinimizer::Summary& summary) {
+                num_iterations += std::max(0, static_cast<int>(summary.iterations.size()) - 1);
+                num_cost_evaluations += std::max(0, summary.num_cost_evaluations);
+                num_gradient_evaluations += std::max(0, summary.num_gradient_evaluations);
+            }
+
+            /**
+             * @brief Adds the work of another counter.
+             */
+            void Add(const LocalMinimizationCounter& counter) {
+                num_iterations += counter.num_iterations;
+                num_cost_evaluations += counter.num_cost_evaluations;
+                num_gradient_evaluations += counter.num_gradient_evaluations;
+            }
+
+            unsigned int num_iterations;/**<Number of local minimizer iterations.*/
+            int64_t num_cost_evaluations;/**<Number of cost-only evaluations.*/
+            int64_t num_gradient_evaluations;/**<Number of cost and gradient evaluations.*/
+        };
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_LOCAL_MINIMIZATION_COUNTER_H
@@ -47,13 +47,12 @@ namespace pallas {
         */
         class Metropolis {
             double beta;
-            RandomNumberGenerator<double> *random_num;/**<generates random numbers to determine if candidate solution is accepted.*/
+            RandomNumberGenerator<double> random_num;/**<generates random numbers to determine if candidate solution is accepted.*/
 
         public:
 
             Metropolis() {
                 beta = 1.0;
-                random_num = new RandomNumberGenerator<double>();
             };
 
             /**Constructor
@@ -61,12 +60,16 @@ namespace pallas {
             */
             Metropolis(double T) {
                 beta = 1.0 / T;
-                random_num = new RandomNumberGenerator<double>();
             };
 
-            /**Default destructor*/
-            ~Metropolis() {
-                delete random_num;
+            /**
+            * @brief Restarts the acceptance test on its own random stream of `seed`.
+            *
+            * @param seed uint64_t. Seed shared by all random streams of the optimization.
+            * @param thread_id unsigned int. Index of the thread (or chain) that owns the acceptance test.
+            */
+            void seed(uint64_t seed, unsigned int thread_id = 0) {
+                random_num.seed(seed, METROPOLIS_STREAM, thread_id);
             };
 
             /**
@@ -75,7 +78,7 @@ namespace pallas {
             * Accepts the candidate solution based on the function:
             * /code
             * 	double w = std::min(1.0, exp(-1.0*(cost_new - cost_old)*beta));
-            *	double r = (*random_num)();
+            *	double r = random_num();
             *	return w >= r;
             * /endcode
             *
@@ -86,15 +89,30 @@ namespace pallas {
             */
             bool accept_reject(double cost_new, double cost_old) {
                 double w = std::min(1.0, exp(-1.0 * (cost_new - cost_old) * beta));
-                double r = (*random_num)();
+                double r = random_num();
                 return w >= r;
             };
 
+            /**
+            * @brief Draws the random number of an acceptance test before the cost of the candidate is known.
+            * @details Returns the highest cost a candidate may have and still be accepted against `cost_old`, i.e.
+            * the candidate is accepted if and only if its cost is not greater than the returned value. This is the
+            * same test as accept_reject and consumes the same random number.
+            *
+            * @param cost_old cost of the current solution.
+            *
+            * @return <B>double</B> the acceptance threshold; infinite if every candidate would be accepted.
+            */
+            double acceptance_threshold(double cost_old) {
+                double r = random_num();
+                return cost_old - log(r) / beta;
+            };
+
             /** @brief Calls the accept_reject function
             * Accepts the candidate solution based on the function:
             * /code
             * 	double w = std::min(1.0, exp(-1.0*(cost_new - cost_old)*beta));
-            *	double r = (*random_num)();
+            *	double r = random_num();
             *	return w >= r;
             * /endcode
             * @param cost_new double. cost of the candidate solution.
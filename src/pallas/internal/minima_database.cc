@@ -0,0 +1,111 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "glog/logging.h"
+
+#include "pallas/internal/minima_database.h"
+
+namespace pallas {
+    namespace internal {
+
+        MinimaDatabase::MinimaDatabase(unsigned int num_parameters, double radius)
+                : num_parameters_(num_parameters),
+                  radius_(radius) {
+            CHECK_GT(num_parameters_, 0);
+            CHECK_GE(radius_, 0.0);
+        };
+
+        int MinimaDatabase::Find(const double* x) const {
+            if (nodes_.empty())
+                return -1;
+
+            int nearest = -1;
+            double nearest_distance = radius_;
+
+            // nodes to visit and their depth in the tree; the split dimension is depth % num_parameters_
+            std::vector<std::pair<int, unsigned int> > stack(1, std::make_pair(0, 0u));
+            while (!stack.empty()) {
+                const int node = stack.back().first;
+                const unsigned int depth = stack.back().second;
+                stack.pop_back();
+
+                const double* point = minimum(node);
+                double distance = 0.0;
+                for (unsigned int i = 0; i < num_parameters_ && distance <= nearest_distance; ++i)
+                    distance = std::max(distance, std::abs(x[i] - point[i]));
+
+                if (distance < nearest_distance || (distance == nearest_distance && nearest < 0)) {
+                    nearest = node;
+                    nearest_distance = distance;
+                }
+
+                const unsigned int split = depth % num_parameters_;
+                const double difference = x[split] - point[split];
+                const int near_side = difference < 0.0 ? 0 : 1;
+                const int far_child = nodes_[node].children[1 - near_side];
+                const int near_child = nodes_[node].children[near_side];
+                if (far_child >= 0 && std::abs(difference) <= nearest_distance)
+                    stack.push_back(std::make_pair(far_child, depth + 1));
+                if (near_child >= 0)
+                    stack.push_back(std::make_pair(near_child, depth + 1));
+            }
+            return nearest;
+        };
+
+        bool MinimaDatabase::Insert(const double* x, double cost) {
+            if (Find(x) >= 0)
+                return false;
+
+            const int index = size();
+            points_.insert(points_.end(), x, x + num_parameters_);
+            costs_.push_back(cost);
+            Node leaf = {{-1, -1}};
+            nodes_.push_back(leaf);
+
+            if (index == 0)
+                return true;
+
+            int node = 0;
+            unsigned int depth = 0;
+            while (true) {
+                const unsigned int split = depth % num_parameters_;
+                const int side = x[split] < minimum(node)[split] ? 0 : 1;
+                if (nodes_[node].children[side] < 0) {
+                    nodes_[node].children[side] = index;
+                    return true;
+                }
+                node = nodes_[node].children[side];
+                ++depth;
+            }
+        };
+
+    } // namespace internal
+} // namespace pallas
@@ -0,0 +1,97 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_INTERNAL_MINIMA_DATABASE_H
+#define PALLAS_INTERNAL_MINIMA_DATABASE_H
+
+#include <vector>
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Stores the local minima found during an optimization and finds the minimum near a point.
+         * @details Minima are kept in a kd-tree that is built incrementally in insertion order, so lookups
+         * cost O(log n) on average for any number of parameters. Two points are considered near each other if
+         * every coordinate differs by at most `radius` (i.e. their max-norm distance is at most `radius`).
+         * Lookups only read the database and may run concurrently with each other, but not with `Insert`.
+         */
+        class MinimaDatabase {
+        public:
+            /**
+             * @brief Constructor
+             *
+             * @param num_parameters unsigned int. Number of parameters of each minimum.
+             * @param radius double. Max-norm distance within which a point is considered near a minimum.
+             */
+            MinimaDatabase(unsigned int num_parameters, double radius);
+
+            /**
+             * @brief Returns the index of the stored minimum nearest to `x` within the radius or -1 if there is none.
+             */
+            int Find(const double* x) const;
+
+            /**
+             * @brief Stores the minimum at `x` unless a stored minimum is already within the radius.
+             * @return Returns `true` if the minimum was stored, `false` otherwise.
+             */
+            bool Insert(const double* x, double cost);
+
+            /**
+             * @brief Returns the coordinates of the `i`th stored minimum.
+             */
+            const double* minimum(int i) const { return &points_[i * num_parameters_]; }
+
+            /**
+             * @brief Returns the cost of the `i`th stored minimum.
+             */
+            double cost(int i) const { return costs_[i]; }
+
+            /**
+             * @brief Returns the number of stored minima.
+             */
+            int size() const { return static_cast<int>(costs_.size()); }
+
+        private:
+            /**
+             * @brief Children of a stored minimum in the kd-tree, -1 if absent.
+             */
+            struct Node {
+                int children[2];
+            };
+
+            unsigned int num_parameters_;/**<Number of parameters of each minimum.*/
+            double radius_;/**<Max-norm distance within which a point is considered near a minimum.*/
+            std::vector<double> points_;/**<Coordinates of the stored minima, one after the other.*/
+            std::vector<double> costs_;/**<Cost of each stored minimum.*/
+            std::vector<Node> nodes_;/**<Node of each stored minimum. The first minimum is the root.*/
+        };
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_MINIMA_DATABASE_H
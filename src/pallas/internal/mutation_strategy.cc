@@ -56,77 +56,84 @@ namespace pallas {
             num_samples_ = 2;
         };
 
-        Vector MutateBest1::get_bprime(const std::vector<Vector> &population,
-                                       unsigned int candidate,
-                                       const int* samples,
-                                       double scale) {
+        void MutateBest1::get_bprime(const Matrix &population,
+                                     unsigned int candidate,
+                                     const int* samples,
+                                     double scale,
+                                     Eigen::Ref<Vector> bprime) {
             const int r0 = samples[0];
             const int r1 = samples[1];
 
-            return population[0] + scale * (population[r0] - population[r1]);
+            bprime = population.col(0) + scale * (population.col(r0) - population.col(r1));
         };
 
         MutateRand1::MutateRand1() {
             num_samples_ = 3;
         };
 
-        Vector MutateRand1::get_bprime(const std::vector<Vector> &population,
-                                       unsigned int candidate,
-                                       const int* samples,
-                                       double scale) {
+        void MutateRand1::get_bprime(const Matrix &population,
+                                     unsigned int candidate,
+                                     const int* samples,
+                                     double scale,
+                                     Eigen::Ref<Vector> bprime) {
             const int r0 = samples[0];
             const int r1 = samples[1];
             const int r2 = samples[2];
 
-            return population[r0] + scale * (population[r1] - population[r2]);
+            bprime = population.col(r0) + scale * (population.col(r1) - population.col(r2));
         };
 
         MutateRandToBest1::MutateRandToBest1() {
             num_samples_ = 2;
         };
 
-        Vector MutateRandToBest1::get_bprime(const std::vector<Vector> &population,
-                                             unsigned int candidate,
-                                             const int* samples,
-                                             double scale) {
+        void MutateRandToBest1::get_bprime(const Matrix &population,
+                                           unsigned int candidate,
+                                           const int* samples,
+                                           double scale,
+                                           Eigen::Ref<Vector> bprime) {
             const int r0 = samples[0];
             const int r1 = samples[1];
-            Vector bprime = population[candidate];
-            bprime += scale * (population[0] - bprime);
-            return scale * (population[r0] - population[r1]);
+            bprime = population.col(candidate)
+                     + scale * (population.col(0) - population.col(candidate))
+                     + scale * (population.col(r0) - population.col(r1));
         };
 
         MutateBest2::MutateBest2() {
             num_samples_ = 4;
         };
 
-        Vector MutateBest2::get_bprime(const std::vector<Vector> &population,
-                                       unsigned int candidate,
-                                       const int* samples,
-                                       double scale) {
+        void MutateBest2::get_bprime(const Matrix &population,
+                                     unsigned int candidate,
+                                     const int* samples,
+                                     double scale,
+                                     Eigen::Ref<Vector> bprime) {
             const int r0 = samples[0];
             const int r1 = samples[1];
             const int r2 = samples[2];
             const int r3 = samples[3];
 
-            return population[0] + scale * (population[r0] + population[r1] - population[r2] - population[r3]);
+            bprime = population.col(0) + scale * (population.col(r0) + population.col(r1)
+                                                   - population.col(r2) - population.col(r3));
         };
 
         MutateRand2::MutateRand2() {
             num_samples_ = 5;
         };
 
-        Vector MutateRand2::get_bprime(const std::vector<Vector> &population,
-                                       unsigned int candidate,
-                                       const int* samples,
-                                       double scale) {
+        void MutateRand2::get_bprime(const Matrix &population,
+                                     unsigned int candidate,
+                                     const int* samples,
+                                     double scale,
+                                     Eigen::Ref<Vector> bprime) {
             const int r0 = samples[0];
             const int r1 = samples[1];
             const int r2 = samples[2];
             const int r3 = samples[3];
             const int r4 = samples[4];
 
-            return population[r0] + scale * (population[r1] + population[r2] - population[r3] - population[r4]);
+            bprime = population.col(r0) + scale * (population.col(r1) + population.col(r2)
+                                                    - population.col(r3) - population.col(r4));
         };
 
     } // namespace internal
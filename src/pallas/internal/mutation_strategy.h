@@ -38,10 +38,11 @@ namespace pallas {
 
             virtual ~MutationStrategy() {};
 
-            virtual Vector get_bprime(const std::vector<Vector> &population,
-                                      unsigned int candidate,
-                                      const int* samples,
-                                      double scale) = 0;
+            virtual void get_bprime(const Matrix &population,
+                                    unsigned int candidate,
+                                    const int* samples,
+                                    double scale,
+                                    Eigen::Ref<Vector> bprime) = 0;
 
             unsigned int NumSamples() const;
 
@@ -53,30 +54,33 @@ namespace pallas {
         public:
             MutateBest1();
 
-            Vector get_bprime(const std::vector<Vector> &population,
-                              unsigned int candidate,
-                              const int* samples,
-                              double scale);
+            void get_bprime(const Matrix &population,
+                            unsigned int candidate,
+                            const int* samples,
+                            double scale,
+                            Eigen::Ref<Vector> bprime);
         };
 
         class MutateRand1 : public MutationStrategy {
         public:
             MutateRand1();
 
-            Vector get_bprime(const std::vector<Vector> &population,
-                              unsigned int candidate,
-                              const int* samples,
-                              double scale);
+            void get_bprime(const Matrix &population,
+                            unsigned int candidate,
+                            const int* samples,
+                            double scale,
+                            Eigen::Ref<Vector> bprime);
         };
 
         class MutateRandToBest1 : public MutationStrategy {
         public:
             MutateRandToBest1();
 
-            Vector get_bprime(const std::vector<Vector> &population,
-                              unsigned int candidate,
-                              const int* samples,
-                              double scale);
+            void get_bprime(const Matrix &population,
+                            unsigned int candidate,
+                            const int* samples,
+                            double scale,
+                            Eigen::Ref<Vector> bprime);
 
         };
 
@@ -84,10 +88,11 @@ namespace pallas {
         public:
             MutateBest2();
 
-            Vector get_bprime(const std::vector<Vector> &population,
-                              unsigned int candidate,
-                              const int* samples,
-                              double scale);
+            void get_bprime(const Matrix &population,
+                            unsigned int candidate,
+                            const int* samples,
+                            double scale,
+                            Eigen::Ref<Vector> bprime);
 
         };
 
@@ -95,10 +100,11 @@ namespace pallas {
         public:
             MutateRand2();
 
-            Vector get_bprime(const std::vector<Vector> &population,
-                              unsigned int candidate,
-                              const int* samples,
-                              double scale);
+            void get_bprime(const Matrix &population,
+                            unsigned int candidate,
+                            const int* samples,
+                            double scale,
+                            Eigen::Ref<Vector> bprime);
 
         };
 
@@ -0,0 +1,77 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include "pallas/internal/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace pallas {
+    namespace internal {
+
+        void ParallelFor(int num_threads,
+                         int64_t start,
+                         int64_t end,
+                         const std::function<void(int thread_id, int64_t i)>& function) {
+            if (end <= start) {
+                return;
+            }
+
+            const int64_t num_items = end - start;
+            if (num_threads > num_items) {
+                num_threads = static_cast<int>(num_items);
+            }
+
+            if (num_threads < 2) {
+                for (int64_t i = start; i < end; ++i) {
+                    function(0, i);
+                }
+                return;
+            }
+
+            std::atomic<int64_t> next_index(start);
+            auto worker = [&](int thread_id) {
+                for (int64_t i = next_index++; i < end; i = next_index++) {
+                    function(thread_id, i);
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(num_threads - 1);
+            for (int thread_id = 1; thread_id < num_threads; ++thread_id) {
+                threads.push_back(std::thread(worker, thread_id));
+            }
+            worker(0);
+
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+
+    } // namespace internal
+} // namespace pallas
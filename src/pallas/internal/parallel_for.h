@@ -0,0 +1,55 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_INTERNAL_PARALLEL_FOR_H
+#define PALLAS_INTERNAL_PARALLEL_FOR_H
+
+#include <cstdint>
+#include <functional>
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Calls `function(thread_id, i)` for every `i` in `[start, end)` using up to `num_threads` threads.
+         * @details The calling thread takes part in the work and is always given `thread_id == 0`. Indices are
+         * handed out dynamically, so `function` must not depend on which thread processes which index; the
+         * `thread_id` is only meant for selecting per-thread scratch space. All work is finished when this returns.
+         *
+         * @param num_threads int. Maximum number of threads to use. Values less than 2 run serially on the calling thread.
+         * @param start int64_t. First index (inclusive).
+         * @param end int64_t. Last index (exclusive).
+         * @param function std::function<void(int, int64_t)>. Work to perform for each index.
+         */
+        void ParallelFor(int num_threads,
+                         int64_t start,
+                         int64_t end,
+                         const std::function<void(int thread_id, int64_t i)>& function);
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_PARALLEL_FOR_H
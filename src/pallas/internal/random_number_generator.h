@@ -36,85 +36,240 @@
 #ifndef PALLAS_RANDOM_NUMBER_GENERATOR_H
 #define PALLAS_RANDOM_NUMBER_GENERATOR_H
 
+#include <cstddef>
+#include <cstdint>
 #include <random>
 #include <type_traits>
 
 namespace pallas {
     namespace internal {
+        /**
+        * @brief Identifies the component that owns a random stream.
+        * @details Every component that draws random numbers is assigned its own stream so that, for a fixed seed,
+        * the numbers drawn by one component do not depend on how many numbers the others consumed.
+        */
+        enum RandomStreamType {
+            POPULATION_STREAM,
+            DITHER_STREAM,
+            SHUFFLER_STREAM,
+            CROSSOVER_STREAM,
+            CROSSOVER_INDEX_STREAM,
+            STEP_FUNCTION_STREAM,
+            METROPOLIS_STREAM,
+            INDEX_SAMPLER_STREAM,
+            REPLICA_EXCHANGE_STREAM,
+            MIGRATION_STREAM
+        };
+
+        /**
+        * @brief xoshiro256++ pseudo random number engine.
+        * @details Small (256 bit) state engine with a period of 2^256 - 1 that is stored inline, so it
+        * can be copied and does not require any heap allocations. The state is initialized from a single
+        * 64 bit seed using splitmix64 as recommended by the authors of the generator.
+        * Non-overlapping streams are obtained with the jump functions: `long_jump` advances the engine by
+        * 2^192 draws and `jump` by 2^128 draws, so a seed provides 2^64 component streams, each of
+        * which can be split into 2^64 per-thread substreams.
+        * See http://prng.di.unimi.it/ for details.
+        */
+        class Xoshiro256PlusPlus {
+        public:
+            typedef uint64_t result_type;
+
+            /**
+            * @brief Constructor
+            *
+            * @param seed uint64_t. Value used to initialize the state of the engine.
+            */
+            explicit Xoshiro256PlusPlus(uint64_t seed) {
+                this->seed(seed);
+            };
+
+            /**
+            * @brief Constructs the engine at the start of the substream `substream` of stream `stream`.
+            *
+            * @param seed uint64_t. Value used to initialize the state of the engine.
+            * @param stream uint64_t. Number of times to call `long_jump` after seeding.
+            * @param substream uint64_t. Number of times to call `jump` after selecting the stream.
+            */
+            Xoshiro256PlusPlus(uint64_t seed, uint64_t stream, uint64_t substream) {
+                this->seed(seed, stream, substream);
+            };
+
+            /**
+            * @brief Reinitializes the state of the engine from `seed`.
+            *
+            * @param seed uint64_t. Value used to initialize the state of the engine.
+            */
+            void seed(uint64_t seed) {
+                for (int i = 0; i < 4; ++i) {
+                    seed += 0x9e3779b97f4a7c15ULL;
+                    uint64_t z = seed;
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                    state_[i] = z ^ (z >> 31);
+                }
+            };
+
+            /**
+            * @brief Reinitializes the state of the engine to the start of the substream `substream` of stream `stream`.
+            *
+            * @param seed uint64_t. Value used to initialize the state of the engine.
+            * @param stream uint64_t. Number of times to call `long_jump` after seeding.
+            * @param substream uint64_t. Number of times to call `jump` after selecting the stream.
+            */
+            void seed(uint64_t seed, uint64_t stream, uint64_t substream) {
+                this->seed(seed);
+                for (uint64_t i = 0; i < stream; ++i)
+                    long_jump();
+                for (uint64_t i = 0; i < substream; ++i)
+                    jump();
+            };
+
+            /**
+            * @brief Advances the engine by 2^128 draws.
+            */
+            void jump() {
+                static const uint64_t polynomial[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                                      0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+                jump_(polynomial);
+            };
+
+            /**
+            * @brief Advances the engine by 2^192 draws.
+            */
+            void long_jump() {
+                static const uint64_t polynomial[4] = {0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+                                                      0x77710069854ee241ULL, 0x39109bb02acbe635ULL};
+                jump_(polynomial);
+            };
+
+            static constexpr result_type min() { return 0; }
+
+            static constexpr result_type max() { return ~static_cast<result_type>(0); }
+
+            /**
+            * @brief Returns the next 64 bit output of the engine.
+            */
+            inline result_type operator()() {
+                const uint64_t result = rotl_(state_[0] + state_[3], 23) + state_[0];
+                const uint64_t t = state_[1] << 17;
+
+                state_[2] ^= state_[0];
+                state_[3] ^= state_[1];
+                state_[1] ^= state_[2];
+                state_[0] ^= state_[3];
+
+                state_[2] ^= t;
+                state_[3] = rotl_(state_[3], 45);
+
+                return result;
+            };
+
+            /**
+            * @brief Returns a double uniformly distributed on `[0, 1)` using the upper 53 bits of the next output.
+            */
+            inline double next_double() {
+                return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0);
+            };
+
+        private:
+            static inline uint64_t rotl_(uint64_t x, int k) {
+                return (x << k) | (x >> (64 - k));
+            };
+
+            void jump_(const uint64_t* polynomial) {
+                uint64_t s[4] = {0, 0, 0, 0};
+                for (int i = 0; i < 4; ++i) {
+                    for (int b = 0; b < 64; ++b) {
+                        if (polynomial[i] & (static_cast<uint64_t>(1) << b)) {
+                            s[0] ^= state_[0];
+                            s[1] ^= state_[1];
+                            s[2] ^= state_[2];
+                            s[3] ^= state_[3];
+                        }
+                        (*this)();
+                    }
+                }
+                for (int i = 0; i < 4; ++i)
+                    state_[i] = s[i];
+            };
+
+            uint64_t state_[4];/**<State of the engine*/
+        };
+
+        /**
+        * @brief Returns a seed drawn from `std::random_device`.
+        */
+        inline uint64_t RandomSeed() {
+            std::random_device rd;
+            return (static_cast<uint64_t>(rd()) << 32) ^ static_cast<uint64_t>(rd());
+        };
+
+        /**
+        * @brief Converts a user supplied seed to the seed of the random streams.
+        * @details Negative seeds request a non-reproducible run and are replaced by a non-negative seed drawn
+        * from `std::random_device`, so the returned value can be passed back in to repeat the run.
+        */
+        inline int ResolveSeed(int seed) {
+            return seed < 0 ? static_cast<int>(RandomSeed() & 0x7fffffffULL) : seed;
+        };
+
         /**
         * @brief Generates random numbers.
-        * @details The engine specified by the typedef Engine is used to generate random numbers with a distribution defined by the typedef Distribution.
-        *
+        * @details Random numbers are produced by an inline xoshiro256++ engine and mapped to a uniform
+        * distribution on the range given at construction. Generators can be freely copied; a copy continues
+        * the same sequence as the original.
         */
         template <class T, class Enable = void> class RandomNumberGenerator;
 
         template<class T>
         class RandomNumberGenerator<T, typename std::enable_if<std::is_integral<T>::value >::type> {
-            typedef std::mt19937 Engine;
-            typedef std::uniform_int_distribution<T> Distribution;
-
-        private:
-            Engine *_eng;/**<Pointer to an Engine*/
-            Distribution *_dist;/**<Pointer to a Distribution*/
-            std::random_device rd;/**<Random device used to seed the Engine*/
-
         public:
             /**
             * @brief Constructor with min and max values specified.
-            * @details Produces numbers on the range `[minVal, maxVal)` seeded by a random device.
+            * @details Produces numbers on the range `[minVal, maxVal]` seeded by a random device.
             *
             * @param minVal T. The minimum value that the random number can output (inclusive).
-            * @param maxVal T. The random number generator will output values lower than maxVal (exclusive).
+            * @param maxVal T. The maximum value that the random number can output (inclusive).
             */
-            RandomNumberGenerator(T minVal, T maxVal) {
-                std::random_device rd;
-                _eng = new Engine(rd());
-                _dist = new Distribution(minVal, maxVal);
+            RandomNumberGenerator(T minVal, T maxVal)
+                    : engine_(RandomSeed()) {
+                init_range_(minVal, maxVal);
             };
 
             /**
             * @brief Constructor with min and max values specified and explicit integer seed.
-            * @details Produces numbers on the range `[minVal, maxVal)` seeded by the specified integer seed.
+            * @details Produces numbers on the range `[minVal, maxVal]` seeded by the specified integer seed.
             * Use explicit seed if predictable outputs from the random number generator are needed.
             *
             * @param minVal T. The minimum value that the random number can output (inclusive).
-            * @param maxVal T. The random number generator will output values lower than maxVal (exclusive).
-            * @param seed int. A seeding value. An entire state sequence is generated from this value using
-            * a linear random generator.
+            * @param maxVal T. The maximum value that the random number can output (inclusive).
+            * @param seed int. A seeding value. The state of the engine is generated from this value using splitmix64.
             */
-            RandomNumberGenerator(T minVal, T maxVal, int seed) {
-                std::random_device rd;
-                _eng = new Engine(seed);
-                _dist = new Distribution(minVal, maxVal);
+            RandomNumberGenerator(T minVal, T maxVal, int seed)
+                    : engine_(static_cast<uint64_t>(seed)) {
+                init_range_(minVal, maxVal);
             };
 
             /**
             * @brief Default constructor
-            * @details constructs a random number generator on the interval [0.0,1.0) seeded with a random device.
+            * @details constructs a random number generator on the interval [0,1] seeded with a random device.
             */
-            RandomNumberGenerator() {
-                std::random_device rd;
-                _eng = new Engine(rd());
-                _dist = new Distribution(0, 1);
+            RandomNumberGenerator()
+                    : engine_(RandomSeed()) {
+                init_range_(0, 1);
             };
 
             /**
-            * @brief Constructor with default range '[0, 1)' and explicit integer seed.
-            * @details Produces numbers on the range `[0, 1)` seeded by the specified integer seed.
+            * @brief Constructor with default range '[0, 1]' and explicit integer seed.
+            * @details Produces numbers on the range `[0, 1]` seeded by the specified integer seed.
             * Use explicit seed if predictable outputs from the random number generator are needed.
             *
-            * @param seed int. A seeding value. An entire state sequence is generated from this value using
-            * a linear random generator.
+            * @param seed int. A seeding value. The state of the engine is generated from this value using splitmix64.
             */
-            RandomNumberGenerator(int seed) {
-                std::random_device rd;
-                _eng = new Engine(seed);
-                _dist = new Distribution(0, 1);
-            };
-
-            ~RandomNumberGenerator() {
-                delete _dist;
-                delete _eng;
+            RandomNumberGenerator(int seed)
+                    : engine_(static_cast<uint64_t>(seed)) {
+                init_range_(0, 1);
             };
 
             /**
@@ -123,20 +278,80 @@ namespace pallas {
             * @return Returns a number between the minimum and maximum values specified when constructing the distribution.
             */
             inline T operator()() {
-                return (*_dist)(*_eng);
+                return static_cast<T>(min_ + bounded_(span_));
             };
-        };
 
-        template<class T>
-        class RandomNumberGenerator<T, typename std::enable_if<std::is_floating_point<T>::value >::type> {
-            typedef std::mt19937 Engine;
-            typedef std::uniform_real_distribution<T> Distribution;
+            /**
+            * @brief Fills `out` with `n` random numbers.
+            *
+            * @param out T*. Array of length `n` to write the random numbers to.
+            * @param n size_t. Number of random numbers to generate.
+            */
+            inline void Fill(T* out, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = static_cast<T>(min_ + bounded_(span_));
+                }
+            };
+
+
+            /**
+            * @brief Restarts the generator at the beginning of a random stream, keeping the range.
+            *
+            * @param seed uint64_t. Seed shared by all streams of a run.
+            * @param stream RandomStreamType. Component that owns the generator.
+            * @param substream unsigned int. Index of the thread (or other parallel worker) that owns the generator.
+            */
+            void seed(uint64_t seed, RandomStreamType stream, unsigned int substream = 0) {
+                engine_.seed(seed, static_cast<uint64_t>(stream), static_cast<uint64_t>(substream));
+            };
 
         private:
-            Engine *_eng;/**<Pointer to an Engine*/
-            Distribution *_dist;/**<Pointer to a Distribution*/
-            std::random_device rd;/**<Random device used to seed the Engine*/
+            void init_range_(T minVal, T maxVal) {
+                min_ = static_cast<uint64_t>(minVal);
+                span_ = static_cast<uint64_t>(maxVal) - static_cast<uint64_t>(minVal);
+            };
+
+            /**
+            * @brief Returns a uniformly distributed integer on `[0, span]`.
+            * @details Uses Lemire's nearly divisionless method for spans that fit in 32 bits
+            * and bitmask rejection otherwise.
+            */
+            inline uint64_t bounded_(uint64_t span) {
+                if (span < 0xffffffffULL) {
+                    const uint32_t range = static_cast<uint32_t>(span + 1);
+                    uint64_t m = (engine_() >> 32) * static_cast<uint64_t>(range);
+                    uint32_t l = static_cast<uint32_t>(m);
+                    if (l < range) {
+                        const uint32_t t = static_cast<uint32_t>(-range) % range;
+                        while (l < t) {
+                            m = (engine_() >> 32) * static_cast<uint64_t>(range);
+                            l = static_cast<uint32_t>(m);
+                        }
+                    }
+                    return m >> 32;
+                }
+
+                uint64_t mask = span;
+                mask |= mask >> 1;
+                mask |= mask >> 2;
+                mask |= mask >> 4;
+                mask |= mask >> 8;
+                mask |= mask >> 16;
+                mask |= mask >> 32;
+                uint64_t x;
+                do {
+                    x = engine_() & mask;
+                } while (x > span);
+                return x;
+            };
+
+            Xoshiro256PlusPlus engine_;/**<Engine used to generate the random bits.*/
+            uint64_t min_;/**<Minimum value that can be generated.*/
+            uint64_t span_;/**<Difference between the maximum and minimum values that can be generated.*/
+        };
 
+        template<class T>
+        class RandomNumberGenerator<T, typename std::enable_if<std::is_floating_point<T>::value >::type> {
         public:
             /**
             * @brief Constructor with min and max values specified.
@@ -145,11 +360,10 @@ namespace pallas {
             * @param minVal T. The minimum value that the random number can output (inclusive).
             * @param maxVal T. The random number generator will output values lower than maxVal (exclusive).
             */
-            RandomNumberGenerator(T minVal, T maxVal) {
-                std::random_device rd;
-                _eng = new Engine(rd());
-                _dist = new Distribution(minVal, maxVal);
-            };
+            RandomNumberGenerator(T minVal, T maxVal)
+                    : engine_(RandomSeed()),
+                      min_(minVal),
+                      span_(maxVal - minVal) {};
 
             /**
             * @brief Constructor with min and max values specified and explicit integer seed.
@@ -158,43 +372,33 @@ namespace pallas {
             *
             * @param minVal T. The minimum value that the random number can output (inclusive).
             * @param maxVal T. The random number generator will output values lower than maxVal (exclusive).
-            * @param seed int. A seeding value. An entire state sequence is generated from this value using
-            * a linear random generator.
+            * @param seed int. A seeding value. The state of the engine is generated from this value using splitmix64.
             */
-            RandomNumberGenerator(T minVal, T maxVal, int seed) {
-                std::random_device rd;
-                _eng = new Engine(seed);
-                _dist = new Distribution(minVal, maxVal);
-            };
+            RandomNumberGenerator(T minVal, T maxVal, int seed)
+                    : engine_(static_cast<uint64_t>(seed)),
+                      min_(minVal),
+                      span_(maxVal - minVal) {};
 
             /**
             * @brief Default constructor
             * @details constructs a random number generator on the interval [0.0,1.0) seeded with a random device.
             */
-            RandomNumberGenerator() {
-                std::random_device rd;
-                _eng = new Engine(rd());
-                _dist = new Distribution(0, 1);
-            };
+            RandomNumberGenerator()
+                    : engine_(RandomSeed()),
+                      min_(0),
+                      span_(1) {};
 
             /**
             * @brief Constructor with default range '[0, 1)' and explicit integer seed.
             * @details Produces numbers on the range `[0, 1)` seeded by the specified integer seed.
             * Use explicit seed if predictable outputs from the random number generator are needed.
             *
-            * @param seed int. A seeding value. An entire state sequence is generated from this value using
-            * a linear random generator.
+            * @param seed int. A seeding value. The state of the engine is generated from this value using splitmix64.
             */
-            RandomNumberGenerator(int seed) {
-                std::random_device rd;
-                _eng = new Engine(seed);
-                _dist = new Distribution(0, 1);
-            };
-
-            ~RandomNumberGenerator() {
-                delete _dist;
-                delete _eng;
-            };
+            RandomNumberGenerator(int seed)
+                    : engine_(static_cast<uint64_t>(seed)),
+                      min_(0),
+                      span_(1) {};
 
             /**
             * @brief Returns a random number
@@ -202,11 +406,40 @@ namespace pallas {
             * @return Returns a number between the minimum and maximum values specified when constructing the distribution.
             */
             inline T operator()() {
-                return (*_dist)(*_eng);
+                return min_ + span_ * static_cast<T>(engine_.next_double());
+            };
+
+            /**
+            * @brief Fills `out` with `n` random numbers.
+            *
+            * @param out T*. Array of length `n` to write the random numbers to.
+            * @param n size_t. Number of random numbers to generate.
+            */
+            inline void Fill(T* out, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = min_ + span_ * static_cast<T>(engine_.next_double());
+                }
+            };
+
+
+            /**
+            * @brief Restarts the generator at the beginning of a random stream, keeping the range.
+            *
+            * @param seed uint64_t. Seed shared by all streams of a run.
+            * @param stream RandomStreamType. Component that owns the generator.
+            * @param substream unsigned int. Index of the thread (or other parallel worker) that owns the generator.
+            */
+            void seed(uint64_t seed, RandomStreamType stream, unsigned int substream = 0) {
+                engine_.seed(seed, static_cast<uint64_t>(stream), static_cast<uint64_t>(substream));
             };
+
+        private:
+            Xoshiro256PlusPlus engine_;/**<Engine used to generate the random bits.*/
+            T min_;/**<Minimum value that can be generated.*/
+            T span_;/**<Width of the range of values that can be generated.*/
         };
 
     } // namespace internal
 } // namespace pallas
 
-#endif //PALLAS_RANDOM_NUMBER_GENERATOR_H
\ No newline at end of file
+#endif //PALLAS_RANDOM_NUMBER_GENERATOR_H
@@ -0,0 +1,137 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include "pallas/internal/shared_problem.h"
+
+namespace pallas {
+    namespace internal {
+
+        namespace {
+
+            class SharedFunction : public GradientCostFunction {
+            public:
+                explicit SharedFunction(const GradientCostFunction* function)
+                        : function_(function) {}
+
+                virtual bool Evaluate(const double* parameters,
+                                      double* cost,
+                                      double* gradient) const {
+                    return function_->Evaluate(parameters, cost, gradient);
+                }
+
+                virtual int NumParameters() const { return function_->NumParameters(); }
+
+            private:
+                const GradientCostFunction* function_;
+            };
+
+            class SharedCostFunction : public LeastSquaresCostFunction {
+            public:
+                explicit SharedCostFunction(const LeastSquaresCostFunction* cost_function)
+                        : cost_function_(cost_function) {
+                    *mutable_parameter_block_sizes() = cost_function->parameter_block_sizes();
+                    set_num_residuals(cost_function->num_residuals());
+                }
+
+                virtual bool Evaluate(double const* const* parameters,
+                                      double* residuals,
+                                      double** jacobians) const {
+                    return cost_function_->Evaluate(parameters, residuals, jacobians);
+                }
+
+            private:
+                const LeastSquaresCostFunction* cost_function_;
+            };
+
+            class SharedLossFunction : public ceres::LossFunction {
+            public:
+                explicit SharedLossFunction(const ceres::LossFunction* loss_function)
+                        : loss_function_(loss_function) {}
+
+                virtual void Evaluate(double squared_norm, double rho[3]) const {
+                    loss_function_->Evaluate(squared_norm, rho);
+                }
+
+            private:
+                const ceres::LossFunction* loss_function_;
+            };
+
+            class SharedParameterization : public ceres::LocalParameterization {
+            public:
+                explicit SharedParameterization(const ceres::LocalParameterization* parameterization)
+                        : parameterization_(parameterization) {}
+
+                virtual bool Plus(const double* x,
+                                  const double* delta,
+                                  double* x_plus_delta) const {
+                    return parameterization_->Plus(x, delta, x_plus_delta);
+                }
+
+                virtual bool ComputeJacobian(const double* x, double* jacobian) const {
+                    return parameterization_->ComputeJacobian(x, jacobian);
+                }
+
+                virtual bool MultiplyByJacobian(const double* x,
+                                                const int num_rows,
+                                                const double* global_matrix,
+                                                double* local_matrix) const {
+                    return parameterization_->MultiplyByJacobian(x, num_rows, global_matrix, local_matrix);
+                }
+
+                virtual int GlobalSize() const { return parameterization_->GlobalSize(); }
+
+                virtual int LocalSize() const { return parameterization_->LocalSize(); }
+
+            private:
+                const ceres::LocalParameterization* parameterization_;
+            };
+
+        } // namespace
+
+        GradientProblem* CreateSharedProblem(const GradientProblem& problem) {
+            if (problem.cost_function_type() == LEAST_SQUARES) {
+                ceres::LossFunction* loss_function = problem.loss_function() == NULL ?
+                                                     NULL :
+                                                     new SharedLossFunction(problem.loss_function());
+                if (problem.parameterization() == NULL)
+                    return new GradientProblem(new SharedCostFunction(problem.least_squares_function()),
+                                               loss_function);
+
+                return new GradientProblem(new SharedCostFunction(problem.least_squares_function()),
+                                           loss_function,
+                                           new SharedParameterization(problem.parameterization()));
+            }
+
+            if (problem.parameterization() == NULL)
+                return new GradientProblem(new SharedFunction(problem.function()));
+
+            return new GradientProblem(new SharedFunction(problem.function()),
+                                       new SharedParameterization(problem.parameterization()));
+        }
+
+    } // namespace internal
+} // namespace pallas
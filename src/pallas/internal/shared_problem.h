@@ -0,0 +1,52 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#ifndef PALLAS_INTERNAL_SHARED_PROBLEM_H
+#define PALLAS_INTERNAL_SHARED_PROBLEM_H
+
+#include "pallas/gradient_problem.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Creates a problem that evaluates the cost function and local parameterization of `problem`
+         * without taking ownership of them.
+         * @details ceres::GradientProblem computes gradients in scratch space owned by the problem, so a single
+         * problem can not be minimized on several threads at once. Each problem returned by this function has
+         * its own scratch space, so concurrent local minimizations can each use one, provided the cost
+         * function itself is safe to evaluate concurrently. `problem` must outlive the returned problem.
+         *
+         * @param problem pallas::GradientProblem. The problem to share.
+         * @return A new problem owned by the caller.
+         */
+        GradientProblem* CreateSharedProblem(const GradientProblem& problem);
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_SHARED_PROBLEM_H
@@ -27,8 +27,8 @@
 #ifndef PALLAS_INTERNAL_SHUFFLER_H
 #define PALLAS_INTERNAL_SHUFFLER_H
 
+#include <algorithm>
 #include "pallas/internal/random_number_generator.h"
-#include "pallas/scoped_ptr.h"
 
 
 namespace pallas {
@@ -36,24 +36,30 @@ namespace pallas {
         class Shuffler {
         public:
             Shuffler(unsigned int population_size)
-                    : population_size_(population_size) {
-                scoped_ptr<RandomNumberGenerator<unsigned int>> tmp_random_idx(
-                        new RandomNumberGenerator<unsigned int>(0, population_size_ - 1));
-                swap(random_idx_, tmp_random_idx);
+                    : population_size_(population_size),
+                      random_idx_(0, population_size - 1) {
+
+            };
+
+            /**
+            * @brief Restarts the shuffler on its own random stream of `seed`.
+            */
+            void seed(uint64_t seed, unsigned int thread_id = 0) {
+                random_idx_.seed(seed, SHUFFLER_STREAM, thread_id);
             };
 
             template<typename T>
             void Shuffle(T* data, unsigned int num_times = 1) {
                 for (unsigned int i = 0; i < num_times; ++i) {
                     for (unsigned int j = population_size_ - 1; j > 0; --j) {
-                        std::swap(data[j], data[(*random_idx_)()]);
+                        std::swap(data[j], data[random_idx_()]);
                     }
                 }
             };
 
         private:
             const unsigned int population_size_;
-            scoped_ptr<RandomNumberGenerator<unsigned int>> random_idx_;
+            RandomNumberGenerator<unsigned int> random_idx_;
 
         };
 
@@ -29,8 +29,14 @@
 // Author: sameeragarwal@google.com (Sameer Agarwal)
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "pallas/history_ring.h"
+#include "pallas/history_sink.h"
+#include "pallas/iteration_callback.h"
 #include "pallas/types.h"
 
 namespace pallas {
@@ -50,5 +56,62 @@ namespace pallas {
                     summary->termination_type == TerminationType::USER_SUCCESS);
         }
 
+        /**
+         * @brief Whether the evaluations made so far spend the `max_function_evaluations` or `max_gradient_evaluations`
+         * budget of a solver.
+         * @details A cost and gradient evaluation also evaluates the cost function, so it counts toward both budgets.
+         */
+        inline bool IsEvaluationBudgetSpent(int64_t max_function_evaluations,
+                                            int64_t max_gradient_evaluations,
+                                            int64_t num_cost_evaluations,
+                                            int64_t num_gradient_evaluations) {
+            return num_cost_evaluations + num_gradient_evaluations >= max_function_evaluations ||
+                   num_gradient_evaluations >= max_gradient_evaluations;
+        }
+
+        /**
+         * @brief Saves the history output built from `args` (the arguments of its constructor).
+         * @details The output is recorded in `ring` and handed to `sink` when they are set, and appended to `history`
+         * when neither is. Recording in the ring allocates no memory.
+         */
+        template <typename HistoryOutputType, typename... Args>
+        void SaveHistory(HistoryRing<HistoryOutputType>* ring,
+                         HistorySink* sink,
+                         HistorySeries* history,
+                         const Args&... args) {
+            if (ring != NULL)
+                ring->Record(args...);
+            if (sink != NULL)
+                sink->Append(HistoryConcept(HistoryOutputType(args...)));
+            else if (ring == NULL)
+                history->push_back(HistoryConcept(HistoryOutputType(args...)));
+        }
+
+        /**
+         * @brief Calls the callbacks in order until one of them does not return `SOLVER_CONTINUE`.
+         *
+         * @return Returns `true` and sets the message and termination type if a callback stopped the solver.
+         */
+        inline bool InvokeCallbacks(const std::vector<IterationCallback*>& callbacks,
+                                    const IterationSummary& summary,
+                                    std::string* message,
+                                    TerminationType* termination_type) {
+            for (size_t i = 0; i < callbacks.size(); ++i) {
+                switch ((*callbacks[i])(summary)) {
+                    case CallbackReturnType::SOLVER_CONTINUE:
+                        break;
+                    case CallbackReturnType::SOLVER_ABORT:
+                        *message = "User callback returned SOLVER_ABORT.";
+                        *termination_type = TerminationType::USER_FAILURE;
+                        return true;
+                    case CallbackReturnType::SOLVER_TERMINATE_SUCCESSFULLY:
+                        *message = "User callback returned SOLVER_TERMINATE_SUCCESSFULLY.";
+                        *termination_type = TerminationType::USER_SUCCESS;
+                        return true;
+                }
+            }
+            return false;
+        }
+
     }  // namespace internal
 }  // namespace pallas
\ No newline at end of file
@@ -0,0 +1,283 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#include <algorithm>
+#include "glog/logging.h"
+#include "pallas/internal/trial_generator.h"
+
+namespace pallas {
+    namespace internal {
+
+        namespace {
+
+            // Mutation kernels. Each resolves the columns it reads once per trial and
+            // returns the mutant value of a single coordinate on demand.
+
+            class Best1 {
+            public:
+                enum { kNumSamples = 2 };
+
+                Best1(const Matrix &population, unsigned int /*candidate*/, const int* samples, double scale)
+                        : best_(population.col(0).data()),
+                          r0_(population.col(samples[0]).data()),
+                          r1_(population.col(samples[1]).data()),
+                          scale_(scale) {}
+
+                inline double operator()(unsigned int j) const {
+                    return best_[j] + scale_ * (r0_[j] - r1_[j]);
+                }
+
+            private:
+                const double* best_;
+                const double* r0_;
+                const double* r1_;
+                const double scale_;
+            };
+
+            class Rand1 {
+            public:
+                enum { kNumSamples = 3 };
+
+                Rand1(const Matrix &population, unsigned int /*candidate*/, const int* samples, double scale)
+                        : r0_(population.col(samples[0]).data()),
+                          r1_(population.col(samples[1]).data()),
+                          r2_(population.col(samples[2]).data()),
+                          scale_(scale) {}
+
+                inline double operator()(unsigned int j) const {
+                    return r0_[j] + scale_ * (r1_[j] - r2_[j]);
+                }
+
+            private:
+                const double* r0_;
+                const double* r1_;
+                const double* r2_;
+                const double scale_;
+            };
+
+            class RandToBest1 {
+            public:
+                enum { kNumSamples = 2 };
+
+                RandToBest1(const Matrix &population, unsigned int candidate, const int* samples, double scale)
+                        : current_(population.col(candidate).data()),
+                          best_(population.col(0).data()),
+                          r0_(population.col(samples[0]).data()),
+                          r1_(population.col(samples[1]).data()),
+                          scale_(scale) {}
+
+                inline double operator()(unsigned int j) const {
+                    return current_[j] + scale_ * (best_[j] - current_[j] + r0_[j] - r1_[j]);
+                }
+
+            private:
+                const double* current_;
+                const double* best_;
+                const double* r0_;
+                const double* r1_;
+                const double scale_;
+            };
+
+            class Best2 {
+            public:
+                enum { kNumSamples = 4 };
+
+                Best2(const Matrix &population, unsigned int /*candidate*/, const int* samples, double scale)
+                        : best_(population.col(0).data()),
+                          r0_(population.col(samples[0]).data()),
+                          r1_(population.col(samples[1]).data()),
+                          r2_(population.col(samples[2]).data()),
+                          r3_(population.col(samples[3]).data()),
+                          scale_(scale) {}
+
+                inline double operator()(unsigned int j) const {
+                    return best_[j] + scale_ * (r0_[j] + r1_[j] - r2_[j] - r3_[j]);
+                }
+
+            private:
+                const double* best_;
+                const double* r0_;
+                const double* r1_;
+                const double* r2_;
+                const double* r3_;
+                const double scale_;
+            };
+
+            class Rand2 {
+            public:
+                enum { kNumSamples = 5 };
+
+                Rand2(const Matrix &population, unsigned int /*candidate*/, const int* samples, double scale)
+                        : r0_(population.col(samples[0]).data()),
+                          r1_(population.col(samples[1]).data()),
+                          r2_(population.col(samples[2]).data()),
+                          r3_(population.col(samples[3]).data()),
+                          r4_(population.col(samples[4]).data()),
+                          scale_(scale) {}
+
+                inline double operator()(unsigned int j) const {
+                    return r0_[j] + scale_ * (r1_[j] + r2_[j] - r3_[j] - r4_[j]);
+                }
+
+            private:
+                const double* r0_;
+                const double* r1_;
+                const double* r2_;
+                const double* r3_;
+                const double* r4_;
+                const double scale_;
+            };
+
+            // Crossover kernels. Every coordinate of the trial is written exactly once, either
+            // with the mutant value or with the target's value.
+
+            class Binomial {
+            public:
+                template<class Mutation>
+                static inline void Apply(const Mutation &mutation,
+                                         const double* target,
+                                         unsigned int num_parameters,
+                                         double crossover_probability,
+                                         RandomNumberGenerator<double> &random_double,
+                                         RandomNumberGenerator<unsigned int> &random_uint,
+                                         double* uniforms,
+                                         double* trial) {
+                    random_double.Fill(uniforms, num_parameters);
+                    // one random entry in trial will always have a crossover
+                    uniforms[random_uint()] = -1.0;
+                    for (unsigned int j = 0; j < num_parameters; ++j) {
+                        trial[j] = uniforms[j] < crossover_probability ? mutation(j) : target[j];
+                    }
+                }
+            };
+
+            class Exponential {
+            public:
+                template<class Mutation>
+                static inline void Apply(const Mutation &mutation,
+                                         const double* target,
+                                         unsigned int num_parameters,
+                                         double crossover_probability,
+                                         RandomNumberGenerator<double> &random_double,
+                                         RandomNumberGenerator<unsigned int> &random_uint,
+                                         double* /*uniforms*/,
+                                         double* trial) {
+                    std::copy(target, target + num_parameters, trial);
+
+                    unsigned int fill_point = random_uint();
+                    for (unsigned int i = 0; i < num_parameters && random_double() < crossover_probability; ++i) {
+                        trial[fill_point] = mutation(fill_point);
+                        fill_point = (fill_point + 1 == num_parameters) ? 0 : fill_point + 1;
+                    }
+                }
+            };
+
+            template<class Mutation, class Crossover>
+            class FusedTrialGenerator : public TrialGenerator {
+            public:
+                FusedTrialGenerator(double crossover_probability, unsigned int num_parameters)
+                        : TrialGenerator(crossover_probability, num_parameters, Mutation::kNumSamples) {}
+
+                void Generate(const Matrix &population,
+                              unsigned int candidate,
+                              const int* samples,
+                              double scale,
+                              double* trial) {
+                    Crossover::Apply(Mutation(population, candidate, samples, scale),
+                                     population.col(candidate).data(),
+                                     num_parameters_,
+                                     crossover_probability_,
+                                     random_double_,
+                                     random_uint_,
+                                     uniforms_.data(),
+                                     trial);
+                }
+            };
+
+            template<class Crossover>
+            TrialGenerator* CreateWithCrossover(MutationStrategyType mutation_strategy,
+                                                double crossover_probability,
+                                                unsigned int num_parameters) {
+                switch (mutation_strategy) {
+                    case BEST_1:
+                        return new FusedTrialGenerator<Best1, Crossover>(crossover_probability, num_parameters);
+                    case RAND_1:
+                        return new FusedTrialGenerator<Rand1, Crossover>(crossover_probability, num_parameters);
+                    case RAND_TO_BEST_1:
+                        return new FusedTrialGenerator<RandToBest1, Crossover>(crossover_probability, num_parameters);
+                    case BEST_2:
+                        return new FusedTrialGenerator<Best2, Crossover>(crossover_probability, num_parameters);
+                    case RAND_2:
+                        return new FusedTrialGenerator<Rand2, Crossover>(crossover_probability, num_parameters);
+                    default:
+                        LOG(ERROR) << "Unknown mutation strategy type: " << MutationStrategyTypeToString(mutation_strategy);
+                        return NULL;
+                }
+            }
+
+        } // namespace
+
+        TrialGenerator* TrialGenerator::Create(MutationStrategyType mutation_strategy,
+                                               CrossoverStrategyType crossover_strategy,
+                                               double crossover_probability,
+                                               unsigned int num_parameters) {
+            switch (crossover_strategy) {
+                case BINOMIAL:
+                    return CreateWithCrossover<Binomial>(mutation_strategy, crossover_probability, num_parameters);
+                case EXPONENTIAL:
+                    return CreateWithCrossover<Exponential>(mutation_strategy, crossover_probability, num_parameters);
+                default:
+                    LOG(ERROR) << "Unknown crossover strategy type: " << CrossoverStrategyTypeToString(crossover_strategy);
+                    return NULL;
+            }
+        };
+
+        TrialGenerator::TrialGenerator(double crossover_probability,
+                                       unsigned int num_parameters,
+                                       unsigned int num_samples)
+                : random_uint_(0, num_parameters - 1),
+                  uniforms_(num_parameters),
+                  crossover_probability_(crossover_probability),
+                  num_parameters_(num_parameters),
+                  num_samples_(num_samples) {
+
+        };
+
+        unsigned int TrialGenerator::NumSamples() const {
+            return num_samples_;
+        };
+
+        void TrialGenerator::set_crossover_probability(double crossover_probability) {
+            crossover_probability_ = crossover_probability;
+        };
+
+        void TrialGenerator::seed(uint64_t seed, unsigned int thread_id) {
+            random_double_.seed(seed, CROSSOVER_STREAM, thread_id);
+            random_uint_.seed(seed, CROSSOVER_INDEX_STREAM, thread_id);
+        };
+
+    } // namespace internal
+} // namespace pallas
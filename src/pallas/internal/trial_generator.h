@@ -0,0 +1,91 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+#ifndef PALLAS_INTERNAL_TRIAL_GENERATOR_H
+#define PALLAS_INTERNAL_TRIAL_GENERATOR_H
+
+#include "pallas/types.h"
+#include "pallas/internal/random_number_generator.h"
+
+namespace pallas {
+    namespace internal {
+
+        /**
+         * @brief Produces differential evolution trial candidates by fused mutation and crossover.
+         * @details Each (mutation, crossover) pair is a separate kernel that computes a mutant
+         * coordinate only where crossover selects it and writes straight into the caller's trial
+         * buffer, so generating a trial performs no allocations.
+         */
+        class TrialGenerator {
+        public:
+            static TrialGenerator* Create(MutationStrategyType mutation_strategy,
+                                          CrossoverStrategyType crossover_strategy,
+                                          double crossover_probability,
+                                          unsigned int num_parameters);
+
+            virtual ~TrialGenerator() {};
+
+            /**
+             * @brief Writes the trial for member `candidate` of `population` into `trial`.
+             *
+             * @param population pallas::Matrix. Current population, one member per column.
+             * @param candidate unsigned int. Column of the member the trial is generated for.
+             * @param samples const int*. Distinct population indices drawn for the mutation. At least `NumSamples()` are read.
+             * @param scale double. Mutation constant.
+             * @param trial double*. Output buffer of length `num_parameters`. Must not alias `population`.
+             */
+            virtual void Generate(const Matrix &population,
+                                  unsigned int candidate,
+                                  const int* samples,
+                                  double scale,
+                                  double* trial) = 0;
+
+            unsigned int NumSamples() const;
+
+            void set_crossover_probability(double crossover_probability);
+
+            /**
+             * @brief Restarts the crossover draws on their own random streams of `seed`.
+             */
+            void seed(uint64_t seed, unsigned int thread_id = 0);
+
+        protected:
+            TrialGenerator(double crossover_probability,
+                           unsigned int num_parameters,
+                           unsigned int num_samples);
+
+            RandomNumberGenerator<double> random_double_;
+            RandomNumberGenerator<unsigned int> random_uint_;
+            Vector uniforms_;/**<Scratch space for the uniform draws of a single trial.*/
+            double crossover_probability_;
+            const unsigned int num_parameters_;
+            const unsigned int num_samples_;
+        };
+
+    } // namespace internal
+} // namespace pallas
+
+#endif // PALLAS_INTERNAL_TRIAL_GENERATOR_H
@@ -0,0 +1,180 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+// Compares the fixed per-call cost of the local minimizer backends on the
+// functions of internal/test_functions.h. Each function is minimized from the
+// same random starting points with ceres::GradientProblemSolver (L-BFGS) and
+// with the pallas line search minimizer (L-BFGS and BFGS). The gradient is
+// computed with central differences so the cost functions stay cheap. Heap
+// allocations are counted by replacing the global operator new.
+//
+// Usage: local_minimizer_benchmark [num_starts] [max_num_iterations]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include "pallas/gradient_problem.h"
+#include "pallas/types.h"
+#include "pallas/internal/line_search_minimizer.h"
+#include "pallas/internal/test_functions.h"
+#include "pallas/internal/wall_time.h"
+
+namespace {
+    long long num_allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    ++num_allocations;
+    void* p = std::malloc(size);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+namespace pallas {
+    namespace internal {
+
+        typedef double (*TestFunction)(const Vector&);
+
+        /**
+         * @brief Cost function that differentiates a test function with central differences.
+         */
+        class NumericDiffTestFunction : public GradientCostFunction {
+        public:
+            NumericDiffTestFunction(TestFunction function, int num_parameters)
+                    : function_(function),
+                      x_(num_parameters) {}
+
+            virtual ~NumericDiffTestFunction() {}
+
+            virtual bool Evaluate(const double* parameters,
+                                  double* cost,
+                                  double* gradient) const {
+                x_ = ConstVectorRef(parameters, x_.size());
+                cost[0] = function_(x_);
+                if (gradient != NULL) {
+                    for (int i = 0; i < x_.size(); ++i) {
+                        const double h = 1e-6 * std::max(1.0, std::abs(parameters[i]));
+                        x_[i] = parameters[i] + h;
+                        const double cost_plus = function_(x_);
+                        x_[i] = parameters[i] - h;
+                        gradient[i] = (cost_plus - function_(x_)) / (2.0 * h);
+                        x_[i] = parameters[i];
+                    }
+                }
+                return true;
+            }
+
+            virtual int NumParameters() const { return static_cast<int>(x_.size()); }
+
+        private:
+            TestFunction function_;
+            mutable Vector x_;
+        };
+
+        struct BenchmarkFunction {
+            const char* name;
+            TestFunction function;
+            double bound;
+        };
+
+        void RunBenchmark(int num_starts, int max_num_iterations) {
+            const BenchmarkFunction functions[] = {{"rosenbrock", rosenbrock, 2.048},
+                                                   {"schwefel", schwefel, 500.0},
+                                                   {"easom", easom, 2.0 * PI},
+                                                   {"xsy02", xsy02, 2.0 * PI}};
+            const int dimensions[] = {2, 10};
+
+            std::printf("num_starts: %d, max_num_iterations: %d\n\n", num_starts, max_num_iterations);
+            std::printf("%-11s %4s %-14s %14s %11s %13s %13s\n",
+                        "Function", "D", "Backend", "Time (us/solve)", "Iterations", "Final cost", "Allocs/solve");
+
+            for (auto& benchmark_function : functions) {
+                for (auto num_parameters : dimensions) {
+                    GradientProblem problem(new NumericDiffTestFunction(benchmark_function.function, num_parameters));
+
+                    std::mt19937 engine(1);
+                    std::uniform_real_distribution<double> distribution(-benchmark_function.bound, benchmark_function.bound);
+                    Matrix starts(num_parameters, num_starts);
+                    for (int i = 0; i < starts.size(); ++i)
+                        starts.data()[i] = distribution(engine);
+
+                    for (int backend = 0; backend < 3; ++backend) {
+                        GradientLocalMinimizer::Options options;
+                        options.max_num_iterations = max_num_iterations;
+                        options.line_search_direction_type = backend == 2 ? ceres::BFGS : ceres::LBFGS;
+                        GradientLocalMinimizer::Summary summary;
+                        LineSearchMinimizer line_search_minimizer;
+                        Vector x(num_parameters);
+
+                        double total_iterations = 0.0;
+                        double total_cost = 0.0;
+                        const long long start_allocations = num_allocations;
+                        const double start_time = WallTimeInSeconds();
+                        for (int i = 0; i < num_starts; ++i) {
+                            x = starts.col(i);
+                            if (backend == 0) {
+                                GradientLocalMinimizer local_minimizer;
+                                local_minimizer.Solve(options, problem, x.data(), &summary);
+                            } else {
+                                line_search_minimizer.ClearHistory();
+                                line_search_minimizer.Minimize(options, problem, x.data(), &summary);
+                            }
+                            total_iterations += summary.iterations.size() - 1;
+                            total_cost += summary.final_cost;
+                        }
+                        const double time = WallTimeInSeconds() - start_time;
+
+                        std::printf("%-11s %4d %-14s %14.2f %11.1f %13.4e %13.1f\n",
+                                    benchmark_function.name,
+                                    num_parameters,
+                                    backend == 0 ? "ceres L-BFGS" : backend == 1 ? "pallas L-BFGS" : "pallas BFGS",
+                                    1e6 * time / num_starts,
+                                    total_iterations / num_starts,
+                                    total_cost / num_starts,
+                                    static_cast<double>(num_allocations - start_allocations) / num_starts);
+                    }
+                }
+            }
+        }
+
+    } // namespace internal
+} // namespace pallas
+
+int main(int argc, char** argv) {
+    const int num_starts = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int max_num_iterations = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    pallas::internal::RunBenchmark(num_starts, max_num_iterations);
+    return 0;
+}
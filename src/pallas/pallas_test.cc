@@ -24,6 +24,13 @@
 //
 // Author: ryan.latture@gmail.com (Ryan Latture)
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
@@ -31,7 +38,13 @@
 #include "pallas/basinhopping.h"
 #include "pallas/brute.h"
 #include "pallas/differential_evolution.h"
+#include "pallas/parallel_tempering.h"
 #include "pallas/simulated_annealing.h"
+#include "pallas/internal/grid_decoder.h"
+#include "pallas/internal/least_squares_minimizer.h"
+#include "pallas/internal/line_search_minimizer.h"
+#include "pallas/internal/minima_database.h"
+#include "pallas/internal/mutation_strategy.h"
 #include "pallas/internal/test_functions.h"
 
 namespace pallas {
@@ -57,6 +70,329 @@ namespace pallas {
         virtual int NumParameters() const { return 2; }
     };
 
+    class BoxRosenbrock : public pallas::GradientCostFunction {
+    public:
+        BoxRosenbrock(const double* lower_bounds, const double* upper_bounds)
+                : num_outside_calls(0),
+                  lower_bounds_(lower_bounds),
+                  upper_bounds_(upper_bounds) {}
+
+        virtual ~BoxRosenbrock() {}
+
+        virtual bool Evaluate(const double* parameters,
+                              double* cost,
+                              double* gradient) const {
+            for (int i = 0; i < 2; ++i) {
+                if (parameters[i] < lower_bounds_[i] || parameters[i] > upper_bounds_[i])
+                    ++num_outside_calls;
+            }
+            return rosenbrock_.Evaluate(parameters, cost, gradient);
+        }
+
+        virtual int NumParameters() const { return 2; }
+
+        mutable int num_outside_calls;
+
+    private:
+        Rosenbrock rosenbrock_;
+        const double* lower_bounds_;
+        const double* upper_bounds_;
+    };
+
+    class RosenbrockResiduals : public pallas::LeastSquaresCostFunction {
+    public:
+        RosenbrockResiduals() {
+            // one parameter block per coordinate
+            mutable_parameter_block_sizes()->assign(2, 1);
+            set_num_residuals(2);
+        }
+
+        virtual ~RosenbrockResiduals() {}
+
+        virtual bool Evaluate(double const* const* parameters,
+                              double* residuals,
+                              double** jacobians) const {
+            const double x = parameters[0][0];
+            const double y = parameters[1][0];
+
+            residuals[0] = 10.0 * (y - x * x);
+            residuals[1] = 1.0 - x;
+            if (jacobians != NULL) {
+                if (jacobians[0] != NULL) {
+                    jacobians[0][0] = -20.0 * x;
+                    jacobians[0][1] = -1.0;
+                }
+                if (jacobians[1] != NULL) {
+                    jacobians[1][0] = 10.0;
+                    jacobians[1][1] = 0.0;
+                }
+            }
+            return true;
+        }
+    };
+
+    class CountingRosenbrockResiduals : public pallas::LeastSquaresCostFunction {
+    public:
+        CountingRosenbrockResiduals() : num_residual_calls(0), num_jacobian_calls(0) {
+            mutable_parameter_block_sizes()->assign(2, 1);
+            set_num_residuals(2);
+        }
+
+        virtual ~CountingRosenbrockResiduals() {}
+
+        virtual bool Evaluate(double const* const* parameters,
+                              double* residuals,
+                              double** jacobians) const {
+            if (jacobians != NULL)
+                ++num_jacobian_calls;
+            else
+                ++num_residual_calls;
+            return residuals_.Evaluate(parameters, residuals, jacobians);
+        }
+
+        mutable int num_residual_calls;
+        mutable int num_jacobian_calls;
+
+    private:
+        RosenbrockResiduals residuals_;
+    };
+
+    class IllConditionedQuadratic : public pallas::GradientCostFunction {
+    public:
+        IllConditionedQuadratic(int num_parameters) : num_parameters_(num_parameters) {}
+
+        virtual ~IllConditionedQuadratic() {}
+
+        virtual bool Evaluate(const double* parameters,
+                              double* cost,
+                              double* gradient) const {
+            // curvatures spread evenly on a log scale from 1 to 100
+            cost[0] = 0.0;
+            for (int i = 0; i < num_parameters_; ++i) {
+                const double curvature = std::pow(10.0, 2.0 * i / (num_parameters_ - 1));
+                cost[0] += 0.5 * curvature * parameters[i] * parameters[i];
+                if (gradient != NULL)
+                    gradient[i] = curvature * parameters[i];
+            }
+            return true;
+        }
+
+        virtual int NumParameters() const { return num_parameters_; }
+
+    private:
+        int num_parameters_;
+    };
+
+    class BatchRosenbrock : public pallas::BatchGradientCostFunction {
+    public:
+        BatchRosenbrock() : num_batch_calls(0) {}
+
+        virtual ~BatchRosenbrock() {}
+
+        virtual bool Evaluate(const double* parameters,
+                              double* cost,
+                              double* gradient) const {
+            return rosenbrock_.Evaluate(parameters, cost, gradient);
+        }
+
+        virtual bool EvaluateBatch(int num_candidates,
+                                   const double* parameters,
+                                   double* costs) const {
+            ++num_batch_calls;
+            for (int i = 0; i < num_candidates; ++i) {
+                rosenbrock_.Evaluate(parameters + 2 * i, costs + i, NULL);
+            }
+            return true;
+        }
+
+        virtual int NumParameters() const { return 2; }
+
+        mutable int num_batch_calls;
+
+    private:
+        Rosenbrock rosenbrock_;
+    };
+
+    class CountingRosenbrock : public pallas::GradientCostFunction {
+    public:
+        CountingRosenbrock() : num_cost_calls(0), num_gradient_calls(0) {}
+
+        virtual ~CountingRosenbrock() {}
+
+        virtual bool Evaluate(const double* parameters,
+                              double* cost,
+                              double* gradient) const {
+            if (gradient != NULL)
+                ++num_gradient_calls;
+            else
+                ++num_cost_calls;
+            return rosenbrock_.Evaluate(parameters, cost, gradient);
+        }
+
+        virtual int NumParameters() const { return 2; }
+
+        mutable int num_cost_calls;
+        mutable int num_gradient_calls;
+
+    private:
+        Rosenbrock rosenbrock_;
+    };
+
+    class AtomicCountingRosenbrock : public pallas::GradientCostFunction {
+    public:
+        AtomicCountingRosenbrock() : num_calls(0) {}
+
+        virtual ~AtomicCountingRosenbrock() {}
+
+        virtual bool Evaluate(const double* parameters,
+                              double* cost,
+                              double* gradient) const {
+            ++num_calls;
+            return rosenbrock_.Evaluate(parameters, cost, gradient);
+        }
+
+        virtual int NumParameters() const { return 2; }
+
+        mutable std::atomic<int> num_calls;
+
+    private:
+        Rosenbrock rosenbrock_;
+    };
+
+    class SeriesHistorySink : public pallas::HistorySink {
+    public:
+        SeriesHistorySink(const std::atomic<int>* num_calls) : num_calls_at_first_append(-1), num_calls_(num_calls) {}
+
+        virtual void Append(HistoryConcept history) {
+            if (num_calls_at_first_append < 0)
+                num_calls_at_first_append = *num_calls_;
+            series.push_back(std::move(history));
+        }
+
+        virtual void Flush() {}
+
+        HistorySeries series;
+        int num_calls_at_first_append;
+
+    private:
+        const std::atomic<int>* num_calls_;
+    };
+
+    class SleepingCallback : public pallas::IterationCallback {
+    public:
+        SleepingCallback(double sleep_time_in_seconds) : sleep_time_in_seconds(sleep_time_in_seconds), num_calls(0) {}
+
+        virtual ~SleepingCallback() {}
+
+        virtual CallbackReturnType operator()(const IterationSummary& /*summary*/) {
+            ++num_calls;
+            std::this_thread::sleep_for(std::chrono::duration<double>(sleep_time_in_seconds));
+            return CallbackReturnType::SOLVER_CONTINUE;
+        }
+
+        double sleep_time_in_seconds;
+        int num_calls;
+    };
+
+    class StoppingCallback : public pallas::IterationCallback {
+    public:
+        StoppingCallback(uint64_t stop_iteration, CallbackReturnType stop_return_type)
+                : stop_iteration(stop_iteration),
+                  stop_return_type(stop_return_type) {}
+
+        virtual ~StoppingCallback() {}
+
+        virtual CallbackReturnType operator()(const IterationSummary& summary) {
+            iteration_numbers.push_back(summary.iteration_number);
+            temperatures.push_back(summary.temperature);
+            best_costs.push_back(summary.best_cost);
+            best_solution = summary.best_solution;
+            return iteration_numbers.size() > stop_iteration ? stop_return_type : CallbackReturnType::SOLVER_CONTINUE;
+        }
+
+        uint64_t stop_iteration;
+        CallbackReturnType stop_return_type;
+        std::vector<uint64_t> iteration_numbers;
+        std::vector<double> temperatures;
+        std::vector<double> best_costs;
+        Vector best_solution;
+    };
+
+    TEST(GradientProblem, EvaluateBatchWrapsSinglePointFunction) {
+        pallas::GradientProblem problem(new Rosenbrock());
+        EXPECT_TRUE(problem.batch_function() == NULL);
+
+        Matrix candidates(2, 3);
+        candidates << 1.0, -1.2, 0.0,
+                      1.0,  0.0, 0.0;
+        Vector costs(3);
+        EXPECT_TRUE(problem.EvaluateBatch(3, candidates.data(), costs.data()));
+
+        for (int i = 0; i < 3; ++i) {
+            double expected_cost;
+            problem.Evaluate(candidates.col(i).data(), &expected_cost, NULL);
+            EXPECT_DOUBLE_EQ(expected_cost, costs[i]);
+        }
+    }
+
+    TEST(GradientProblem, AcceptsCeresGradientProblem) {
+        const double expected_tolerance = 1e-6;
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.max_iterations = 10;
+        pallas::Basinhopping::Summary summary;
+        ceres::GradientProblem ceres_problem(new Rosenbrock());
+        pallas::GradientProblem problem(ceres_problem);
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_NE(TerminationType::FAILURE, summary.termination_type);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(GradientProblem, ConvertedCeresGradientProblemIsSafeToShareBetweenHops) {
+        const double expected_tolerance = 1e-6;
+        double serial_parameters[2] = {-1.2, 0.0};
+        double parallel_parameters[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.max_iterations = 10;
+        pallas::Basinhopping::Summary serial_summary, parallel_summary;
+        ceres::GradientProblem ceres_problem(new Rosenbrock());
+        pallas::GradientProblem problem(ceres_problem);
+        pallas::Solve(options, problem, serial_parameters, &serial_summary);
+
+        // the hops evaluate gradients of the wrapped problem concurrently
+        options.num_parallel_hops = 4;
+        pallas::Solve(options, problem, parallel_parameters, &parallel_summary);
+
+        EXPECT_NE(TerminationType::FAILURE, parallel_summary.termination_type);
+        EXPECT_EQ(serial_summary.num_iterations, parallel_summary.num_iterations);
+        EXPECT_NEAR(1.0, parallel_parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parallel_parameters[1], expected_tolerance);
+    }
+
+    TEST(GradientProblem, LeastSquaresCostIsHalfSquaredResidualNorm) {
+        pallas::GradientProblem problem(new RosenbrockResiduals());
+        pallas::GradientProblem gradient_problem(new Rosenbrock());
+        EXPECT_EQ(LEAST_SQUARES, problem.cost_function_type());
+        EXPECT_EQ(GRADIENT, gradient_problem.cost_function_type());
+        EXPECT_EQ(2, problem.NumParameters());
+
+        const double parameters[2] = {-1.2, 1.0};
+        double cost, expected_cost;
+        double gradient[2], expected_gradient[2];
+        EXPECT_TRUE(problem.Evaluate(parameters, &cost, gradient));
+        gradient_problem.Evaluate(parameters, &expected_cost, expected_gradient);
+
+        EXPECT_DOUBLE_EQ(0.5 * expected_cost, cost);
+        EXPECT_DOUBLE_EQ(0.5 * expected_gradient[0], gradient[0]);
+        EXPECT_DOUBLE_EQ(0.5 * expected_gradient[1], gradient[1]);
+    }
+
     TEST(RandomNumberGenerator, IntRespectsBounds)
     {
         int min = 0;
@@ -93,6 +429,20 @@ namespace pallas {
 
     }
 
+    TEST(RandomNumberGenerator, FillMatchesRepeatedCallsWithSameSeed)
+    {
+        internal::RandomNumberGenerator<double> r1(-1.0, 1.0, 42);
+        internal::RandomNumberGenerator<double> r2(-1.0, 1.0, 42);
+        std::vector<double> v(100);
+        r1.Fill(v.data(), v.size());
+
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            EXPECT_EQ(r2(), v[i]);
+            EXPECT_TRUE(v[i] >= -1.0 && v[i] < 1.0);
+        }
+    }
+
     TEST(Shuffler, ShufflesVector)
     {
         const unsigned int population_size = 10;
@@ -117,6 +467,50 @@ namespace pallas {
 
     }
 
+    TEST(IndexSampler, SamplesDistinctIndicesExcludingTarget)
+    {
+        const unsigned int population_size = 6;
+        const unsigned int num_samples = 5;
+        int samples[num_samples];
+
+        internal::IndexSampler index_sampler(population_size);
+
+        for (unsigned int target = 0; target < population_size; ++target) {
+            index_sampler.Sample(target, num_samples, samples);
+            for (unsigned int i = 0; i < num_samples; ++i) {
+                EXPECT_NE(static_cast<int>(target), samples[i]);
+                EXPECT_TRUE(samples[i] >= 0 && samples[i] < static_cast<int>(population_size));
+                for (unsigned int j = 0; j < i; ++j)
+                    EXPECT_NE(samples[j], samples[i]);
+            }
+        }
+    }
+
+    TEST(TrialGenerator, FullBinomialCrossoverMatchesMutation) {
+        const unsigned int num_parameters = 7;
+        const unsigned int population_size = 10;
+        const int samples[5] = {3, 5, 1, 8, 6};
+        const double scale = 0.6;
+
+        Matrix population = (Matrix::Random(num_parameters, population_size).array() + 1.0) * 0.5;
+        Vector bprime(num_parameters);
+        Vector trial(num_parameters);
+
+        const MutationStrategyType mutation_strategies[] = {BEST_1, RAND_1, RAND_TO_BEST_1, BEST_2, RAND_2};
+        for (auto mutation_strategy : mutation_strategies) {
+            scoped_ptr<internal::MutationStrategy> mutation(internal::MutationStrategy::Create(mutation_strategy));
+            scoped_ptr<internal::TrialGenerator> trial_generator(
+                    internal::TrialGenerator::Create(mutation_strategy, BINOMIAL, 1.0, num_parameters));
+            EXPECT_EQ(mutation->NumSamples(), trial_generator->NumSamples());
+
+            mutation->get_bprime(population, 2, samples, scale, bprime);
+            trial_generator->Generate(population, 2, samples, scale, trial.data());
+            for (unsigned int j = 0; j < num_parameters; ++j) {
+                EXPECT_NEAR(bprime[j], trial[j], 1e-15) << MutationStrategyTypeToString(mutation_strategy);
+            }
+        }
+    }
+
     TEST(Metropolis, TestAcceptReject) {
         internal::Metropolis m;
         double costNew = 1.0;
@@ -143,6 +537,325 @@ namespace pallas {
         EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
     }
 
+    TEST(Basinhopping, SameSeedReproducesRun) {
+        double parameters1[2] = {-1.2, 0.0};
+        double parameters2[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.max_iterations = 20;
+        pallas::Basinhopping::Summary summary1, summary2;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters1, &summary1);
+        pallas::Solve(options, problem, parameters2, &summary2);
+
+        EXPECT_EQ(7, summary1.seed);
+        EXPECT_EQ(summary1.num_iterations, summary2.num_iterations);
+        EXPECT_EQ(summary1.final_cost, summary2.final_cost);
+        EXPECT_EQ(parameters1[0], parameters2[0]);
+        EXPECT_EQ(parameters1[1], parameters2[1]);
+    }
+
+    TEST(Basinhopping, ParallelHopsReproduceRun) {
+        const double expected_tolerance = 1e-9;
+        double parameters1[2] = {-1.2, 0.0};
+        double parameters2[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.num_parallel_hops = 4;
+        pallas::Basinhopping::Summary summary1, summary2;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters1, &summary1);
+        pallas::Solve(options, problem, parameters2, &summary2);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, summary1.termination_type);
+        EXPECT_EQ(4, summary1.num_parallel_hops);
+        EXPECT_NEAR(1.0, parameters1[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters1[1], expected_tolerance);
+        EXPECT_EQ(summary1.num_iterations, summary2.num_iterations);
+        EXPECT_EQ(summary1.num_discarded_hops, summary2.num_discarded_hops);
+        EXPECT_EQ(summary1.final_cost, summary2.final_cost);
+        EXPECT_EQ(parameters1[0], parameters2[0]);
+        EXPECT_EQ(parameters1[1], parameters2[1]);
+    }
+
+    TEST(Basinhopping, MinimizesHopsOfLeastSquaresProblem) {
+        const double expected_tolerance = 1e-6;
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.max_iterations = 20;
+        options.num_parallel_hops = 2;
+        pallas::Basinhopping::Summary summary;
+        pallas::GradientProblem problem(new RosenbrockResiduals());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_NE(TerminationType::FAILURE, summary.termination_type);
+        EXPECT_GT(summary.local_minimization_summary.num_gradient_evaluations, 0);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(LeastSquaresMinimizer, CountsEvaluationsWithoutAndWithJacobians) {
+        const double expected_tolerance = 1e-6;
+        CountingRosenbrockResiduals* cost_function = new CountingRosenbrockResiduals();
+        pallas::GradientProblem problem(cost_function);
+        LeastSquaresLocalMinimizer::Options options;
+        double parameters[2] = {-1.2, 1.0};
+        GradientLocalMinimizer::Summary summary;
+        internal::MinimizeLeastSquares(options, problem, NULL, NULL, parameters, &summary);
+
+        EXPECT_NE(TerminationType::FAILURE, summary.termination_type);
+        EXPECT_EQ(cost_function->num_residual_calls, summary.num_cost_evaluations);
+        EXPECT_EQ(cost_function->num_jacobian_calls, summary.num_gradient_evaluations);
+        EXPECT_GT(summary.num_gradient_evaluations, 0);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(Basinhopping, ReusesKnownMinima) {
+        const double expected_tolerance = 1e-9;
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.use_minima_database = true;
+        options.minima_probe_radius = 0.5;
+        pallas::Basinhopping::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+        EXPECT_EQ(1, summary.num_known_minima);
+        EXPECT_GT(summary.num_minima_database_hits, 0);
+        EXPECT_EQ(summary.num_iterations - 1,
+                  summary.num_minima_database_hits + summary.num_minima_database_misses);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(Basinhopping, AbortsUnpromisingLocalMinimizations) {
+        const double expected_tolerance = 1e-9;
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.abort_unacceptable_minimizations = true;
+        options.abort_margin = 1.0;
+        options.abort_grace_iterations = 0;
+        pallas::Basinhopping::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+        EXPECT_GT(summary.num_aborted_local_minimizations, 0);
+        EXPECT_GE(summary.saved_local_minimization_time_in_seconds, 0.0);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(LineSearchMinimizer, MinimizesRosenbrockFromItsHistory) {
+        const double expected_tolerance = 1e-6;
+        GradientLocalMinimizer::Options options;
+        options.max_num_iterations = 200;
+        pallas::GradientProblem problem(new Rosenbrock());
+        internal::LineSearchMinimizer minimizer;
+
+        double parameters[2] = {-1.2, 1.0};
+        GradientLocalMinimizer::Summary summary;
+        minimizer.Minimize(options, problem, parameters, &summary);
+        EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+        EXPECT_GT(minimizer.history().size, 0);
+
+        // restarting near the minimum with its curvature converges faster than from steepest descent
+        const internal::LineSearchMinimizer::History history = minimizer.history();
+        double cold_parameters[2] = {1.1, 1.2};
+        minimizer.ClearHistory();
+        minimizer.Minimize(options, problem, cold_parameters, &summary);
+        const size_t num_cold_iterations = summary.iterations.size();
+
+        double warm_parameters[2] = {1.1, 1.2};
+        minimizer.set_history(history);
+        minimizer.Minimize(options, problem, warm_parameters, &summary);
+        EXPECT_NEAR(1.0, warm_parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, warm_parameters[1], expected_tolerance);
+        EXPECT_LT(summary.iterations.size(), num_cold_iterations);
+    }
+
+    TEST(LineSearchMinimizer, FreshMinimizerAcceptsHistory) {
+        const double expected_tolerance = 1e-6;
+        const LineSearchDirectionType direction_types[2] = {ceres::LBFGS, ceres::BFGS};
+        pallas::GradientProblem problem(new Rosenbrock());
+
+        for (int i = 0; i < 2; ++i) {
+            GradientLocalMinimizer::Options options;
+            options.max_num_iterations = 200;
+            options.line_search_direction_type = direction_types[i];
+            internal::LineSearchMinimizer minimizer;
+            double parameters[2] = {-1.2, 1.0};
+            GradientLocalMinimizer::Summary summary;
+            minimizer.Minimize(options, problem, parameters, &summary);
+
+            // a minimizer that has never run gets a history of matching size and must still size its scratch space
+            internal::LineSearchMinimizer fresh_minimizer;
+            fresh_minimizer.set_history(minimizer.history());
+            double fresh_parameters[2] = {1.1, 1.2};
+            fresh_minimizer.Minimize(options, problem, fresh_parameters, &summary);
+            EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+            EXPECT_NEAR(1.0, fresh_parameters[0], expected_tolerance);
+            EXPECT_NEAR(1.0, fresh_parameters[1], expected_tolerance);
+        }
+    }
+
+    TEST(LineSearchMinimizer, StaysWithinBounds) {
+        const double expected_tolerance = 1e-6;
+        // the unconstrained minimum (1, 1) lies outside, the constrained one is (0.5, 0.25)
+        const double lower_bounds[2] = {-2.0, -2.0};
+        const double upper_bounds[2] = {0.5, 2.0};
+        BoxRosenbrock* function = new BoxRosenbrock(lower_bounds, upper_bounds);
+        pallas::GradientProblem problem(function);
+
+        GradientLocalMinimizer::Options options;
+        options.max_num_iterations = 200;
+        internal::LineSearchMinimizer minimizer;
+        minimizer.set_bounds(lower_bounds, upper_bounds);
+
+        // starts outside of the bounds and is projected into them
+        double parameters[2] = {-3.0, 1.0};
+        GradientLocalMinimizer::Summary summary;
+        minimizer.Minimize(options, problem, parameters, &summary);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+        EXPECT_EQ(0, function->num_outside_calls);
+        EXPECT_DOUBLE_EQ(0.5, parameters[0]);
+        EXPECT_NEAR(0.25, parameters[1], expected_tolerance);
+    }
+
+    TEST(Basinhopping, BoundedStepFunctionKeepsHopsWithinBounds) {
+        const double expected_tolerance = 1e-6;
+        const double lower_bounds[2] = {-2.0, -2.0};
+        const double upper_bounds[2] = {0.5, 2.0};
+        BoxRosenbrock* function = new BoxRosenbrock(lower_bounds, upper_bounds);
+        pallas::GradientProblem problem(function);
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.seed = 7;
+        options.max_iterations = 20;
+        scoped_ptr<StepFunction> step_function(new BoundedStepFunction(0.5, upper_bounds, lower_bounds, 2));
+        options.set_step_function(step_function);
+        pallas::Basinhopping::Summary summary;
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_EQ(0, function->num_outside_calls);
+        EXPECT_NEAR(0.5, parameters[0], expected_tolerance);
+        EXPECT_NEAR(0.25, parameters[1], expected_tolerance);
+    }
+
+    TEST(Basinhopping, WarmStartCutsLocalMinimizerIterations) {
+        const double expected_tolerance = 1e-6;
+        Vector cold_parameters = Vector::Ones(8);
+        Vector warm_parameters = Vector::Ones(8);
+
+        pallas::Basinhopping::Options options;
+        options.seed = 5;
+        options.local_minimizer_options.max_num_iterations = 500;
+        options.local_minimizer_type = PALLAS_LOCAL_MINIMIZER;
+        pallas::Basinhopping::Summary cold_summary;
+        pallas::GradientProblem problem(new IllConditionedQuadratic(8));
+        pallas::Solve(options, problem, cold_parameters.data(), &cold_summary);
+
+        options.warm_start_local_minimizer = true;
+        pallas::Basinhopping::Summary warm_summary;
+        pallas::Solve(options, problem, warm_parameters.data(), &warm_summary);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, cold_summary.termination_type);
+        EXPECT_EQ(TerminationType::CONVERGENCE, warm_summary.termination_type);
+        EXPECT_EQ(cold_summary.num_iterations, warm_summary.num_iterations);
+        EXPECT_NEAR(0.0, cold_parameters.lpNorm<Eigen::Infinity>(), expected_tolerance);
+        EXPECT_NEAR(0.0, warm_parameters.lpNorm<Eigen::Infinity>(), expected_tolerance);
+        EXPECT_LT(warm_summary.num_local_minimizer_iterations, cold_summary.num_local_minimizer_iterations);
+    }
+
+    TEST(Basinhopping, WarmStartMatchesColdStartWithParallelHops) {
+        const double expected_tolerance = 1e-6;
+        Vector cold_parameters = Vector::Ones(8);
+        Vector warm_parameters = Vector::Ones(8);
+
+        pallas::Basinhopping::Options options;
+        options.seed = 5;
+        options.num_parallel_hops = 4;
+        options.local_minimizer_options.max_num_iterations = 500;
+        options.local_minimizer_type = PALLAS_LOCAL_MINIMIZER;
+        pallas::Basinhopping::Summary cold_summary;
+        pallas::GradientProblem problem(new IllConditionedQuadratic(8));
+        pallas::Solve(options, problem, cold_parameters.data(), &cold_summary);
+
+        options.warm_start_local_minimizer = true;
+        pallas::Basinhopping::Summary warm_summary;
+        pallas::Solve(options, problem, warm_parameters.data(), &warm_summary);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, cold_summary.termination_type);
+        EXPECT_EQ(TerminationType::CONVERGENCE, warm_summary.termination_type);
+        EXPECT_EQ(cold_summary.num_iterations, warm_summary.num_iterations);
+        EXPECT_NEAR(cold_summary.final_cost, warm_summary.final_cost, expected_tolerance);
+        EXPECT_NEAR(0.0, (warm_parameters - cold_parameters).lpNorm<Eigen::Infinity>(), expected_tolerance);
+        EXPECT_LT(warm_summary.num_local_minimizer_iterations, cold_summary.num_local_minimizer_iterations);
+    }
+
+    TEST(Basinhopping, WarmStartsParallelHops) {
+        const double expected_tolerance = 1e-6;
+        const LineSearchDirectionType direction_types[2] = {ceres::LBFGS, ceres::BFGS};
+        pallas::GradientProblem problem(new IllConditionedQuadratic(8));
+
+        for (int i = 0; i < 2; ++i) {
+            Vector parameters = Vector::Ones(8);
+            pallas::Basinhopping::Options options;
+            options.seed = 5;
+            options.num_parallel_hops = 4;
+            options.local_minimizer_options.max_num_iterations = 500;
+            options.local_minimizer_options.line_search_direction_type = direction_types[i];
+            options.local_minimizer_type = PALLAS_LOCAL_MINIMIZER;
+            options.warm_start_local_minimizer = true;
+            pallas::Basinhopping::Summary summary;
+            pallas::Solve(options, problem, parameters.data(), &summary);
+
+            EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+            EXPECT_NEAR(0.0, parameters.lpNorm<Eigen::Infinity>(), expected_tolerance);
+        }
+    }
+
+    TEST(Basinhopping, StopsWhenEvaluationBudgetIsSpent) {
+        const int64_t max_function_evaluations = 200;
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::Basinhopping::Options options;
+        options.max_iterations = 1000;
+        options.max_stagnant_iterations = 1000;
+        options.max_function_evaluations = max_function_evaluations;
+        pallas::Basinhopping::Summary summary;
+        CountingRosenbrock* cost_function = new CountingRosenbrock();
+        pallas::GradientProblem problem(cost_function);
+        pallas::Solve(options, problem, parameters, &summary);
+
+        // every call of the cost function is counted, including those of the local minimizations
+        const int64_t num_function_evaluations = summary.num_cost_evaluations + summary.num_gradient_evaluations +
+                                                  summary.num_local_cost_evaluations +
+                                                  summary.num_local_gradient_evaluations;
+        EXPECT_EQ(TerminationType::NO_CONVERGENCE, summary.termination_type);
+        EXPECT_EQ("Maximum number of function or gradient evaluations reached.", summary.message);
+        EXPECT_LT(summary.num_iterations, options.max_iterations);
+        EXPECT_GT(summary.num_local_gradient_evaluations, 0);
+        EXPECT_EQ(cost_function->num_cost_calls + cost_function->num_gradient_calls, num_function_evaluations);
+        EXPECT_GE(num_function_evaluations, max_function_evaluations);
+        EXPECT_DOUBLE_EQ(summary.final_cost, 100.0 * std::pow(parameters[1] - parameters[0] * parameters[0], 2) +
+                                             std::pow(1.0 - parameters[0], 2));
+    }
+
     TEST(Basinhopping, SavesHistoryOutput) {
         double parameters[2] = {-1.2, 0.0};
 
@@ -237,6 +950,62 @@ namespace pallas {
         EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
     }
 
+    TEST(SimulatedAnnealing, CallbacksObserveAndStopIterations) {
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::SimulatedAnnealing::Options options;
+        options.max_iterations = 100;
+        pallas::SimulatedAnnealing::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+
+        StoppingCallback terminating_callback(5, CallbackReturnType::SOLVER_TERMINATE_SUCCESSFULLY);
+        options.callbacks.push_back(&terminating_callback);
+        pallas::Solve(options, problem, parameters, &summary);
+
+        // the callback is called once per iteration, starting with the initial point
+        EXPECT_EQ(TerminationType::USER_SUCCESS, summary.termination_type);
+        ASSERT_EQ(6u, terminating_callback.iteration_numbers.size());
+        EXPECT_EQ(summary.num_iterations, terminating_callback.iteration_numbers.back());
+        for (unsigned int i = 0; i < terminating_callback.iteration_numbers.size(); ++i) {
+            EXPECT_GT(terminating_callback.temperatures[i], 0.0);
+            if (i > 0) {
+                EXPECT_EQ(terminating_callback.iteration_numbers[i - 1] + 1, terminating_callback.iteration_numbers[i]);
+                EXPECT_LE(terminating_callback.best_costs[i], terminating_callback.best_costs[i - 1]);
+            }
+        }
+        EXPECT_EQ(terminating_callback.best_costs.back(), summary.final_cost);
+        EXPECT_EQ(terminating_callback.best_solution[0], parameters[0]);
+        EXPECT_EQ(terminating_callback.best_solution[1], parameters[1]);
+
+        // aborting leaves the parameters untouched
+        double aborted_parameters[2] = {-1.2, 0.0};
+        StoppingCallback aborting_callback(3, CallbackReturnType::SOLVER_ABORT);
+        options.callbacks.assign(1, &aborting_callback);
+        pallas::Solve(options, problem, aborted_parameters, &summary);
+
+        EXPECT_EQ(TerminationType::USER_FAILURE, summary.termination_type);
+        EXPECT_EQ(4u, aborting_callback.iteration_numbers.size());
+        EXPECT_EQ(summary.num_iterations, aborting_callback.iteration_numbers.back());
+        EXPECT_EQ(-1.2, aborted_parameters[0]);
+        EXPECT_EQ(0.0, aborted_parameters[1]);
+    }
+
+    TEST(SimulatedAnnealing, EvaluatesCostWithoutGradient) {
+        double parameters[2] = {-1.2, 0.0};
+
+        pallas::SimulatedAnnealing::Options options;
+        options.max_iterations = 10;
+        pallas::SimulatedAnnealing::Summary summary;
+        CountingRosenbrock* cost_function = new CountingRosenbrock();
+        pallas::GradientProblem problem(cost_function);
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_EQ(0, cost_function->num_gradient_calls);
+        EXPECT_EQ(0, summary.num_gradient_evaluations);
+        EXPECT_EQ(cost_function->num_cost_calls, summary.num_cost_evaluations);
+        EXPECT_GT(summary.num_cost_evaluations, 0);
+    }
+
     TEST(SimulatedAnnealing, SavesHistoryOutput) {
         double parameters[2] = {-1.2, 0.0};
 
@@ -270,6 +1039,123 @@ namespace pallas {
         EXPECT_DOUBLE_EQ(parameters[1], history_best_y);
     }
 
+    TEST(ParallelTempering, SolvesRosenbrockWithoutPolishing) {
+        const double expected_tolerance = 0.1;
+        double parameters[2] = {-1.2, 0.0};
+
+        Vector upper_bounds(2);
+        upper_bounds.setConstant(5);
+        Vector lower_bounds = -upper_bounds;
+
+        scoped_ptr<StepFunction> step_function (new BoundedStepFunction(0.1,
+                                                                        upper_bounds.data(),
+                                                                        lower_bounds.data(),
+                                                                        upper_bounds.size()));
+
+        pallas::ParallelTempering::Options options;
+        options.set_step_function(step_function);
+        options.minimum_temperature = 0.01;
+        options.maximum_temperature = 10.0;
+        options.max_iterations = 10000;
+        options.max_stagnant_iterations = 10000;
+        options.minimum_cost = 0.001;
+        options.seed = 3;
+        pallas::ParallelTempering::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_EQ(TerminationType::USER_SUCCESS, summary.termination_type);
+        EXPECT_EQ(8, summary.num_replicas);
+        EXPECT_GT(summary.num_accepted_swaps, 0);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(ParallelTempering, SameSeedReproducesRunOnAnyNumberOfThreads) {
+        double parameters1[2] = {-1.2, 0.0};
+        double parameters2[2] = {-1.2, 0.0};
+
+        pallas::ParallelTempering::Options options;
+        options.temperatures = {0.1, 1.0, 10.0, 100.0};
+        options.max_iterations = 50;
+        options.history_save_frequency = 5;
+        options.seed = 5;
+        pallas::ParallelTempering::Summary summary1, summary2;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters1, &summary1);
+        options.num_threads = 3;
+        pallas::Solve(options, problem, parameters2, &summary2);
+
+        rapidjson::StringBuffer sb1, sb2;
+        HistoryWriter writer1(sb1), writer2(sb2);
+        dump(summary1.history, writer1);
+        dump(summary2.history, writer2);
+
+        rapidjson::Document d;
+        EXPECT_TRUE(!d.Parse(sb1.GetString()).HasParseError()) << "Error parsing dumped history data: " << rapidjson::GetParseError_En(d.GetParseError());
+        std::vector<std::string> expected_members = {"iteration_number", "stagnant_iterations", "replica_costs", "current_solution", "best_cost", "best_solution"};
+        for (auto i = 0; i < d.Size(); ++i) {
+            for (auto& member: expected_members)
+                EXPECT_TRUE(d[i].HasMember(member.c_str())) << "History output missing member: " << member;
+        }
+
+        EXPECT_EQ(4, summary2.num_replicas);
+        EXPECT_EQ(3, summary2.num_threads);
+        EXPECT_EQ(summary1.num_accepted_swaps, summary2.num_accepted_swaps);
+        EXPECT_EQ(summary1.final_cost, summary2.final_cost);
+        EXPECT_EQ(std::string(sb1.GetString()), std::string(sb2.GetString()));
+        EXPECT_EQ(parameters1[0], parameters2[0]);
+        EXPECT_EQ(parameters1[1], parameters2[1]);
+    }
+
+    TEST(GridDecoder, DecodesIndicesBeyond32Bits) {
+        std::vector<Vector> sample_points(3);
+        sample_points[0].setLinSpaced(100000, 0.0, 1.0);
+        sample_points[1].setLinSpaced(100000, -1.0, 0.0);
+        sample_points[2].setLinSpaced(3, 10.0, 12.0);
+
+        internal::GridDecoder grid(sample_points);
+        EXPECT_EQ(30000000000ULL, grid.NumPoints());
+
+        Vector point(3);
+        grid.Decode(grid.NumPoints() - 1, point.data());
+        EXPECT_EQ(sample_points[0][99999], point[0]);
+        EXPECT_EQ(sample_points[1][99999], point[1]);
+        EXPECT_EQ(sample_points[2][2], point[2]);
+
+        // consecutive points must match decoding each index on its own, including carries
+        const uint64_t start = 299999ULL * 3 - 2;
+        Matrix points(3, 8);
+        Eigen::VectorXi counters(3);
+        grid.DecodeRange(start, 8, points.data(), counters.data());
+        for (int i = 0; i < 8; ++i) {
+            grid.Decode(start + i, point.data());
+            for (int j = 0; j < 3; ++j)
+                EXPECT_EQ(point[j], points(j, i));
+        }
+    }
+
+    TEST(MinimaDatabase, FindsNearestMinimumWithinRadius) {
+        internal::MinimaDatabase database(2, 0.1);
+        double minima[4][2] = {{0.0, 0.0}, {1.0, 1.0}, {0.15, 0.0}, {-1.0, 2.0}};
+        for (int i = 0; i < 4; ++i)
+            EXPECT_TRUE(database.Insert(minima[i], i));
+
+        double duplicate[2] = {1.05, 0.95};
+        EXPECT_FALSE(database.Insert(duplicate, 10.0));
+        EXPECT_EQ(4, database.size());
+
+        double near_first[2] = {0.05, 0.0};
+        double near_third[2] = {0.1, 0.05};
+        double far[2] = {0.5, 0.5};
+        EXPECT_EQ(0, database.Find(near_first));
+        EXPECT_EQ(2, database.Find(near_third));
+        EXPECT_EQ(3, database.Find(minima[3]));
+        EXPECT_EQ(-1, database.Find(far));
+        EXPECT_EQ(2.0, database.cost(2));
+        EXPECT_EQ(0.15, database.minimum(2)[0]);
+    }
+
     TEST(Brute, SolvesRosenbrockWithDefaults) {
         const double expected_tolerance = 1e-8;
 
@@ -289,6 +1175,89 @@ namespace pallas {
         EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
     }
 
+    TEST(Brute, SolvesRosenbrockWithBatchCostFunction) {
+        const double expected_tolerance = 1e-8;
+
+        BatchRosenbrock* cost_function = new BatchRosenbrock();
+        pallas::GradientProblem problem(cost_function);
+        EXPECT_TRUE(problem.batch_function() == cost_function);
+
+        pallas::Brute::Options options;
+        options.batch_size = 10;
+        pallas::Brute::Summary summary;
+
+        std::vector<Brute::ParameterRange> ranges = {Brute::ParameterRange(-3.0, 3.0, 7),
+                                                     Brute::ParameterRange(-3.0, 3.0, 7)};
+
+        Vector parameters(2);
+        pallas::Solve(options, problem, ranges, parameters.data(), &summary);
+        EXPECT_EQ(TerminationType::USER_SUCCESS, summary.termination_type);
+        EXPECT_EQ(5, cost_function->num_batch_calls);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(Brute, MultipleThreadsMatchSerialSearch) {
+        pallas::GradientProblem problem(new Rosenbrock());
+
+        pallas::Brute::Options options;
+        options.batch_size = 16;
+        options.history_save_frequency = 7;
+        pallas::Brute::Summary serial_summary, threaded_summary;
+
+        std::vector<Brute::ParameterRange> ranges = {Brute::ParameterRange(-3.0, 3.0, 31),
+                                                     Brute::ParameterRange(-3.0, 3.0, 31)};
+
+        Vector serial_parameters(2);
+        pallas::Solve(options, problem, ranges, serial_parameters.data(), &serial_summary);
+
+        options.num_threads = 3;
+        Vector threaded_parameters(2);
+        pallas::Solve(options, problem, ranges, threaded_parameters.data(), &threaded_summary);
+
+        EXPECT_EQ(3, threaded_summary.num_threads);
+        EXPECT_EQ(serial_summary.final_cost, threaded_summary.final_cost);
+        EXPECT_EQ(serial_parameters[0], threaded_parameters[0]);
+        EXPECT_EQ(serial_parameters[1], threaded_parameters[1]);
+
+        rapidjson::StringBuffer serial_sb, threaded_sb;
+        HistoryWriter serial_writer(serial_sb), threaded_writer(threaded_sb);
+        dump(serial_summary.history, serial_writer);
+        dump(threaded_summary.history, threaded_writer);
+        EXPECT_STREQ(serial_sb.GetString(), threaded_sb.GetString());
+    }
+
+    TEST(Brute, SearchesFirstGridPointsWithinEvaluationBudget) {
+        std::vector<Brute::ParameterRange> ranges = {Brute::ParameterRange(-3.0, 3.0, 31),
+                                                     Brute::ParameterRange(-3.0, 3.0, 31)};
+
+        pallas::Brute::Options options;
+        options.batch_size = 16;
+        options.max_function_evaluations = 100;
+        options.polish_output = true;
+        pallas::Brute::Summary serial_summary, threaded_summary;
+        CountingRosenbrock* cost_function = new CountingRosenbrock();
+        pallas::GradientProblem problem(cost_function);
+
+        Vector serial_parameters(2);
+        pallas::Solve(options, problem, ranges, serial_parameters.data(), &serial_summary);
+
+        options.num_threads = 3;
+        Vector threaded_parameters(2);
+        pallas::Solve(options, problem, ranges, threaded_parameters.data(), &threaded_summary);
+
+        // the polishing step is skipped because the grid spends the whole budget
+        EXPECT_EQ(TerminationType::NO_CONVERGENCE, serial_summary.termination_type);
+        EXPECT_EQ(100u, serial_summary.num_iterations);
+        EXPECT_EQ(100, serial_summary.num_cost_evaluations);
+        EXPECT_FALSE(serial_summary.was_polished);
+        EXPECT_EQ(200, cost_function->num_cost_calls);
+        EXPECT_EQ(0, cost_function->num_gradient_calls);
+        EXPECT_EQ(serial_summary.final_cost, threaded_summary.final_cost);
+        EXPECT_EQ(serial_parameters[0], threaded_parameters[0]);
+        EXPECT_EQ(serial_parameters[1], threaded_parameters[1]);
+    }
+
     TEST(Brute, SavesHistoryOutput) {
         const double expected_tolerance = 1e-8;
 
@@ -339,6 +1308,7 @@ namespace pallas {
         pallas::DifferentialEvolution::Options options;
         options.upper_bounds = upper;
         options.lower_bounds = lower;
+        options.seed = 2;
         pallas::DifferentialEvolution::Summary summary;
         pallas::GradientProblem problem(new Rosenbrock());
         pallas::Solve(options, problem, parameters, &summary);
@@ -371,6 +1341,221 @@ namespace pallas {
         EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
     }
 
+    TEST(DifferentialEvolution, PolishesWithPallasBfgsLocalMinimizer) {
+        const double expected_tolerance = 1e-7;
+        double parameters[2] = {-1.2, 0.0};
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.polish_output = true;
+        options.local_minimizer_type = PALLAS_LOCAL_MINIMIZER;
+        options.local_minimizer_options.line_search_direction_type = ceres::BFGS;
+        options.local_minimizer_options.max_num_iterations = 200;
+        options.local_minimizer_options.function_tolerance = 1e-12;
+        pallas::DifferentialEvolution::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+        EXPECT_TRUE(summary.was_polished);
+        EXPECT_EQ(ceres::BFGS, summary.local_minimization_summary.line_search_direction_type);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(DifferentialEvolution, PolishesLeastSquaresProblem) {
+        const double expected_tolerance = 1e-7;
+        double parameters[2] = {-1.2, 0.0};
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.polish_output = true;
+        options.max_iterations = 50;
+        pallas::DifferentialEvolution::Summary summary;
+        pallas::GradientProblem problem(new RosenbrockResiduals());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_TRUE(summary.was_polished);
+        EXPECT_TRUE(summary.local_minimization_summary.IsSolutionUsable());
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(DifferentialEvolution, SolvesRosenbrockDeferredUpdateMultipleThreads) {
+        const double expected_tolerance = 1e-9;
+        double parameters[2] = {-1.2, 0.0};
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.polish_output = true;
+        options.population_update = DEFERRED;
+        options.num_threads = 4;
+        options.seed = 7;
+        pallas::DifferentialEvolution::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_EQ(TerminationType::CONVERGENCE, summary.termination_type);
+        EXPECT_EQ(DEFERRED, summary.population_update);
+        EXPECT_EQ(4, summary.num_threads);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(DifferentialEvolution, SolvesRosenbrockAsynchronousUpdateMultipleThreads) {
+        const double expected_tolerance = 1e-7;
+        double parameters[2] = {-1.2, 0.0};
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.polish_output = true;
+        options.population_update = ASYNCHRONOUS;
+        options.num_threads = 4;
+        pallas::DifferentialEvolution::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        EXPECT_NE(TerminationType::FAILURE, summary.termination_type);
+        EXPECT_EQ(ASYNCHRONOUS, summary.population_update);
+        EXPECT_EQ(4, summary.num_threads);
+        EXPECT_GT(summary.worker_utilization, 0.0);
+        EXPECT_LE(summary.worker_utilization, 1.0);
+        EXPECT_NEAR(1.0, parameters[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters[1], expected_tolerance);
+    }
+
+    TEST(DifferentialEvolution, AsynchronousCostEvaluationTimeExcludesGenerationWork) {
+        double parameters[2] = {-1.2, 0.0};
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.max_iterations = 10;
+        options.population_update = ASYNCHRONOUS;
+        options.num_threads = 4;
+        // the callbacks run under the lock of the workers once per generation
+        SleepingCallback callback(0.005);
+        options.callbacks.push_back(&callback);
+        pallas::DifferentialEvolution::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters, &summary);
+
+        const double callback_time_in_seconds = callback.num_calls * callback.sleep_time_in_seconds;
+        EXPECT_GT(callback.num_calls, 5);
+        EXPECT_GE(summary.total_time_in_seconds, callback_time_in_seconds);
+        EXPECT_LT(summary.cost_evaluation_time_in_seconds, 0.5 * callback_time_in_seconds);
+    }
+
+    TEST(DifferentialEvolution, SolvesRosenbrockWithIslandsMultipleThreads) {
+        const double expected_tolerance = 1e-7;
+        double parameters1[2] = {-1.2, 0.0};
+        double parameters2[2] = {-1.2, 0.0};
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.polish_output = true;
+        options.seed = 11;
+        options.num_islands = 4;
+        options.migration_interval = 5;
+        options.migration_topology = RANDOM_TOPOLOGY;
+        options.island_strategies.push_back(DifferentialEvolution::IslandStrategy());
+        options.island_strategies.push_back(DifferentialEvolution::IslandStrategy(RAND_1, EXPONENTIAL, 0.9, Vector2d(0.4, 0.9)));
+        pallas::GradientProblem problem(new Rosenbrock());
+
+        pallas::DifferentialEvolution::Summary summary1;
+        options.num_threads = 1;
+        pallas::Solve(options, problem, parameters1, &summary1);
+
+        pallas::DifferentialEvolution::Summary summary2;
+        options.num_threads = 4;
+        pallas::Solve(options, problem, parameters2, &summary2);
+
+        EXPECT_NE(TerminationType::FAILURE, summary2.termination_type);
+        EXPECT_EQ(4u, summary2.num_islands);
+        EXPECT_EQ(4, summary2.num_threads);
+        EXPECT_GT(summary2.num_migrations, 0u);
+        EXPECT_NEAR(1.0, parameters2[0], expected_tolerance);
+        EXPECT_NEAR(1.0, parameters2[1], expected_tolerance);
+
+        // each island draws from its own random streams, so the thread count does not change the result
+        EXPECT_EQ(summary1.num_iterations, summary2.num_iterations);
+        EXPECT_EQ(summary1.num_migrations, summary2.num_migrations);
+        EXPECT_EQ(summary1.num_cost_evaluations, summary2.num_cost_evaluations);
+        EXPECT_EQ(parameters1[0], parameters2[0]);
+        EXPECT_EQ(parameters1[1], parameters2[1]);
+        EXPECT_GT(summary2.cost_evaluation_time_in_seconds, 0.0);
+        EXPECT_LE(summary2.cost_evaluation_time_in_seconds, summary2.total_time_in_seconds);
+    }
+
+    TEST(DifferentialEvolution, SameSeedReproducesRunOnAnyNumberOfThreads) {
+        double parameters1[2] = {-1.2, 0.0};
+        double parameters2[2] = {-1.2, 0.0};
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.population_update = DEFERRED;
+        options.seed = 11;
+        pallas::DifferentialEvolution::Summary summary1, summary2;
+        pallas::GradientProblem problem(new Rosenbrock());
+        pallas::Solve(options, problem, parameters1, &summary1);
+        options.num_threads = 4;
+        pallas::Solve(options, problem, parameters2, &summary2);
+
+        EXPECT_EQ(11, summary2.seed);
+        EXPECT_EQ(summary1.num_iterations, summary2.num_iterations);
+        EXPECT_EQ(summary1.final_cost, summary2.final_cost);
+        EXPECT_EQ(parameters1[0], parameters2[0]);
+        EXPECT_EQ(parameters1[1], parameters2[1]);
+    }
+
     TEST(DifferentialEvolution, SavesHistoryOutput) {
         double parameters[2] = {-1.2, 0.0};
 
@@ -409,6 +1594,177 @@ namespace pallas {
         EXPECT_DOUBLE_EQ(parameters[0], history_best_x);
         EXPECT_DOUBLE_EQ(parameters[1], history_best_y);
     }
+
+    TEST(Brute, StreamsThreadedHistoryOutputInGridOrder) {
+        AtomicCountingRosenbrock* cost_function = new AtomicCountingRosenbrock();
+        pallas::GradientProblem problem(cost_function);
+
+        pallas::Brute::Options options;
+        options.batch_size = 16;
+        options.history_save_frequency = 1;
+        pallas::Brute::Summary serial_summary, threaded_summary;
+
+        std::vector<Brute::ParameterRange> ranges = {Brute::ParameterRange(-3.0, 3.0, 101),
+                                                     Brute::ParameterRange(-3.0, 3.0, 101)};
+
+        Vector serial_parameters(2), threaded_parameters(2);
+        pallas::Solve(options, problem, ranges, serial_parameters.data(), &serial_summary);
+
+        // the outputs are handed over round by round instead of once the whole grid has been searched
+        cost_function->num_calls = 0;
+        SeriesHistorySink sink(&cost_function->num_calls);
+        options.num_threads = 3;
+        options.history_sink = &sink;
+        pallas::Solve(options, problem, ranges, threaded_parameters.data(), &threaded_summary);
+        EXPECT_TRUE(threaded_summary.history.empty());
+        EXPECT_GT(sink.num_calls_at_first_append, 0);
+        EXPECT_LT(sink.num_calls_at_first_append, cost_function->num_calls);
+
+        ASSERT_EQ(serial_summary.history.size(), sink.series.size());
+        rapidjson::StringBuffer serial_sb, sink_sb;
+        HistoryWriter serial_writer(serial_sb), sink_writer(sink_sb);
+        dump(serial_summary.history, serial_writer);
+        dump(sink.series, sink_writer);
+        EXPECT_STREQ(serial_sb.GetString(), sink_sb.GetString());
+        EXPECT_EQ(serial_parameters[0], threaded_parameters[0]);
+        EXPECT_EQ(serial_parameters[1], threaded_parameters[1]);
+    }
+
+    TEST(Brute, KeepsLastHistoryOutputsInRing) {
+        pallas::GradientProblem problem(new Rosenbrock());
+
+        pallas::Brute::Options options;
+        options.batch_size = 16;
+        options.history_save_frequency = 3;
+        pallas::Brute::Summary serial_summary, threaded_summary;
+
+        std::vector<Brute::ParameterRange> ranges = {Brute::ParameterRange(-3.0, 3.0, 31),
+                                                     Brute::ParameterRange(-3.0, 3.0, 31)};
+
+        Vector serial_parameters(2), threaded_parameters(2);
+        pallas::Solve(options, problem, ranges, serial_parameters.data(), &serial_summary);
+
+        // the records of each thread are reduced into the ring, which is cleared by every solve
+        HistoryRing<Brute::HistoryOutput> ring(5);
+        options.num_threads = 4;
+        options.history_ring = &ring;
+        for (int run = 0; run < 2; ++run) {
+            pallas::Solve(options, problem, ranges, threaded_parameters.data(), &threaded_summary);
+            EXPECT_TRUE(threaded_summary.history.empty());
+            ASSERT_EQ(5u, ring.Size());
+
+            HistorySeries last_outputs(serial_summary.history.end() - ring.Size(), serial_summary.history.end());
+            rapidjson::StringBuffer serial_sb, ring_sb;
+            HistoryWriter serial_writer(serial_sb), ring_writer(ring_sb);
+            dump(last_outputs, serial_writer);
+            dump(ring, ring_writer);
+            EXPECT_STREQ(serial_sb.GetString(), ring_sb.GetString());
+        }
+        EXPECT_EQ(serial_parameters[0], threaded_parameters[0]);
+        EXPECT_EQ(serial_parameters[1], threaded_parameters[1]);
+    }
+
+    TEST(DifferentialEvolution, StreamsHistoryOutputToJsonLinesFile) {
+        double parameters[2] = {-1.2, 0.0};
+        const std::string filename = "pallas_history_sink_test.jsonl";
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.max_iterations = 20;
+        options.history_save_frequency = 1;
+        pallas::DifferentialEvolution::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        {
+            // a queue of two outputs forces the solver to wait for the writer
+            JsonLinesHistorySink sink(filename, 2);
+            options.history_sink = &sink;
+            pallas::Solve(options, problem, parameters, &summary);
+            sink.Flush();
+            EXPECT_TRUE(sink.IsGood());
+            EXPECT_EQ(summary.num_iterations + 1, sink.NumOutputsWritten());
+        }
+        EXPECT_TRUE(summary.history.empty());
+
+        std::ifstream file(filename);
+        std::string line;
+        unsigned int num_lines = 0;
+        rapidjson::Document d;
+        while (std::getline(file, line)) {
+            EXPECT_FALSE(d.Parse(line.c_str()).HasParseError()) << "Error parsing streamed history data: " << rapidjson::GetParseError_En(d.GetParseError());
+            EXPECT_EQ(num_lines, d["iteration_number"].GetUint());
+            EXPECT_EQ(options.population_size, d["population"].Size());
+            ++num_lines;
+        }
+        file.close();
+        std::remove(filename.c_str());
+
+        EXPECT_EQ(summary.num_iterations + 1, num_lines);
+        EXPECT_DOUBLE_EQ(parameters[0], d["best_solution"].GetArray()[0].GetDouble());
+        EXPECT_DOUBLE_EQ(parameters[1], d["best_solution"].GetArray()[1].GetDouble());
+    }
+
+    TEST(DifferentialEvolution, StreamsHistoryOutputToBinaryFile) {
+        double parameters[2] = {-1.2, 0.0};
+        const std::string filename = "pallas_binary_history_test.bin";
+
+        Vector upper(2);
+        upper << 10.0, 10.0;
+
+        Vector lower(2);
+        lower << -10.0, -10.0;
+
+        pallas::DifferentialEvolution::Options options;
+        options.upper_bounds = upper;
+        options.lower_bounds = lower;
+        options.max_iterations = 20;
+        options.history_save_frequency = 1;
+        pallas::DifferentialEvolution::Summary summary;
+        pallas::GradientProblem problem(new Rosenbrock());
+        {
+            BinaryHistorySink sink(filename);
+            options.history_sink = &sink;
+            pallas::Solve(options, problem, parameters, &summary);
+            sink.Flush();
+            EXPECT_TRUE(sink.IsGood());
+        }
+
+        BinaryHistoryReader reader;
+        std::string message;
+        ASSERT_TRUE(reader.Open(filename, &message)) << message;
+        EXPECT_EQ(DIFFERENTIAL_EVOLUTION, reader.GetSolverType());
+        EXPECT_EQ(2u, reader.NumParameters());
+        EXPECT_EQ(options.population_size, reader.NumCandidates());
+        EXPECT_EQ(summary.num_iterations + 1, reader.NumRecords());
+
+        const int iteration_number = reader.FindColumn("iteration_number");
+        const int population = reader.FindColumn("population");
+        const int best_solution = reader.FindColumn("best_solution");
+        ASSERT_NE(-1, iteration_number);
+        ASSERT_NE(-1, population);
+        ASSERT_NE(-1, best_solution);
+        EXPECT_EQ(-1, reader.FindColumn("replica_costs"));
+        EXPECT_EQ(2u * options.population_size, reader.ColumnNumValues(population));
+
+        // records can be read in any order
+        const uint64_t last_record = reader.NumRecords() - 1;
+        EXPECT_EQ(last_record, reader.Uint(last_record, iteration_number));
+        EXPECT_EQ(0u, reader.Uint(0, iteration_number));
+        EXPECT_DOUBLE_EQ(parameters[0], reader.Doubles(last_record, best_solution)[0]);
+        EXPECT_DOUBLE_EQ(parameters[1], reader.Doubles(last_record, best_solution)[1]);
+        for (unsigned int i = 0; i < 2 * options.population_size; ++i) {
+            EXPECT_LE(lower[i % 2], reader.Doubles(last_record, population)[i]);
+            EXPECT_GE(upper[i % 2], reader.Doubles(last_record, population)[i]);
+        }
+        reader.Close();
+        std::remove(filename.c_str());
+    }
 } // namespace pallas
 
 int main(int argc, char **argv) {
@@ -0,0 +1,478 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+
+#include <algorithm>
+#include <cmath>
+
+#include "glog/logging.h"
+
+#include "pallas/parallel_tempering.h"
+#include "pallas/binary_history.h"
+#include "pallas/internal/line_search_minimizer.h"
+#include "pallas/internal/solver_utils.h"
+#include "pallas/internal/stringprintf.h"
+#include "pallas/internal/wall_time.h"
+
+namespace pallas {
+
+    using std::string;
+
+    using ceres::TerminationTypeToString;
+
+    using pallas::internal::StringAppendF;
+    using pallas::internal::StringPrintf;
+    using pallas::internal::WallTimeInSeconds;
+
+    ParallelTempering::Summary::Summary()
+            : termination_type(TerminationType::FAILURE),
+              message("pallas::ParallelTempering was not called."),
+              initial_cost(-1.0),
+              final_cost(-1.0),
+              num_parameters(0),
+              num_replicas(0),
+              num_threads(1),
+              seed(-1),
+              num_iterations(0),
+              num_cost_evaluations(0),
+              num_gradient_evaluations(0),
+              num_local_cost_evaluations(0),
+              num_local_gradient_evaluations(0),
+              num_swap_attempts(0),
+              num_accepted_swaps(0),
+              total_time_in_seconds(0.0),
+              local_minimization_time_in_seconds(0.0),
+              step_time_in_seconds(0.0),
+              cost_evaluation_time_in_seconds(0.0),
+              was_polished(false){
+
+    };
+
+    std::string ParallelTempering::Summary::BriefReport() const {
+        return StringPrintf(
+                "Pallas parallel tempering report: "
+                        "iterations: %d, "
+                        "initial cost: %e, "
+                        "final cost: %e, "
+                        "termination: %s\n",
+                num_iterations,
+                initial_cost,
+                final_cost,
+                TerminationTypeToString(termination_type));
+    };
+
+    string ParallelTempering::Summary::FullReport() const {
+
+        string report = string("\nSolver Summary\n\n");
+
+        StringAppendF(&report, "Parameters          %25d\n", num_parameters);
+        StringAppendF(&report, "Replicas            %25d\n", num_replicas);
+        StringAppendF(&report, "Threads             %25d\n", num_threads);
+        StringAppendF(&report, "Seed                %25d\n", seed);
+
+        StringAppendF(&report, "\nCost:\n");
+        StringAppendF(&report, "  Initial        %28e\n", initial_cost);
+        if (termination_type != TerminationType::FAILURE &&
+            termination_type != TerminationType::USER_FAILURE) {
+            StringAppendF(&report, "  Final          %28e\n", final_cost);
+            StringAppendF(&report, "  Change         %28e\n",
+                          initial_cost - final_cost);
+        }
+
+        StringAppendF(&report, "\nMinimizer iterations         %16d\n",
+                      num_iterations);
+
+        StringAppendF(&report, "\nReplica swaps:\n");
+        StringAppendF(&report, "  Attempted      %28lld\n",
+                      static_cast<long long>(num_swap_attempts));
+        StringAppendF(&report, "  Accepted       %28lld\n",
+                      static_cast<long long>(num_accepted_swaps));
+
+        StringAppendF(&report, "\nEvaluations (outside local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_gradient_evaluations));
+
+        StringAppendF(&report, "\nEvaluations (in local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_local_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_local_gradient_evaluations));
+
+        StringAppendF(&report, "\nTime (in seconds):\n");
+
+        StringAppendF(&report, "  Cost evaluation     %23.4f\n",
+                      cost_evaluation_time_in_seconds);
+
+        if (was_polished) {
+            StringAppendF(&report, "  Local minimization   %22.4f\n",
+                          local_minimization_time_in_seconds);
+        }
+
+        StringAppendF(&report, "  Step function   %27.4f\n",
+                      step_time_in_seconds);
+
+        StringAppendF(&report, "  Total               %23.4f\n\n",
+                      total_time_in_seconds);
+
+        StringAppendF(&report, "Termination: %2s (%s)\n",
+                      TerminationTypeToString(termination_type), message.c_str());
+        return report;
+    };
+
+    void ParallelTempering::Solve(const ParallelTempering::Options& options,
+                                  const GradientProblem& problem,
+                                  double* parameters,
+                                  ParallelTempering::Summary* global_summary) {
+
+        double start_time = WallTimeInSeconds();
+        double t1;
+
+        if (options.history_ring != NULL)
+            options.history_ring->Clear();
+        unsigned int step_iter;
+        num_iterations_ = 0;
+        num_stagnant_iterations_ = 0;
+        num_swap_attempts_ = 0;
+        num_accepted_swaps_ = 0;
+
+        bool is_not_silent = !options.is_silent;
+
+        const unsigned int num_parameters = static_cast<unsigned int>(problem.NumParameters());
+        const int num_threads = std::max(1, options.num_threads);
+
+        global_summary->num_parameters = num_parameters;
+        global_summary->num_threads = num_threads;
+
+        const int seed = internal::ResolveSeed(options.seed);
+        global_summary->seed = seed;
+        options.step_function->Seed(seed, 0);
+        init_replicas_(options, seed);
+        global_summary->num_replicas = num_replicas_;
+
+        VectorRef x(parameters, num_parameters);
+
+        scoped_ptr<internal::Evaluator> tmp_evaluator(new internal::Evaluator(problem));
+        swap(evaluator_, tmp_evaluator);
+
+        GradientLocalMinimizer::Summary local_summary;
+
+        global_minimum_state_ = internal::State(num_parameters);
+        global_minimum_state_.x = x;
+
+        t1 = WallTimeInSeconds();
+        if (!evaluator_->Evaluate(global_minimum_state_.x.data(), &global_minimum_state_.cost)) {
+            global_summary->termination_type = TerminationType::FAILURE;
+            global_summary->message = "Initial cost evaluation failed. "
+                                              "More details: Problem evaluation failed";
+            LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+            prepare_final_summary_(global_summary, local_summary);
+            return;
+        }
+        global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+
+        global_summary->initial_cost = global_minimum_state_.cost;
+
+        // every replica starts from the initial point
+        replicas_ = global_minimum_state_.x.replicate(1, num_replicas_);
+        replica_costs_ = Vector::Constant(num_replicas_, global_minimum_state_.cost);
+        candidates_.resize(num_parameters, num_replicas_);
+        candidate_costs_.resize(num_replicas_);
+
+        if (options.history_save_frequency > 0)
+            save_history_(options, global_summary);
+
+        if(check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
+            prepare_final_summary_(global_summary, local_summary);
+            if (internal::IsSolutionUsable(global_summary))
+                x = global_minimum_state_.x;
+            return;
+        }
+
+        // main loop
+        while (true) {
+            bool found_new_minimum = false;
+            for (step_iter = 0; step_iter < options.swap_interval; ++step_iter) {
+                // steps are drawn in replica order on this thread so the candidates do not depend on num_threads
+                t1 = WallTimeInSeconds();
+                candidates_ = replicas_;
+                for (unsigned int i = 0; i < num_replicas_; ++i)
+                    options.step_function->Step(candidates_.col(i).data(), num_parameters);
+                global_summary->step_time_in_seconds += WallTimeInSeconds() - t1;
+
+                t1 = WallTimeInSeconds();
+                if (!evaluator_->EvaluateBatch(static_cast<int>(num_replicas_),
+                                               candidates_.data(),
+                                               num_threads,
+                                               candidate_costs_.data())) {
+                    global_summary->termination_type = TerminationType::FAILURE;
+                    global_summary->message = "Cost evaluation failed. "
+                                                      "More details: Problem evaluation failed";
+                    LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+                    prepare_final_summary_(global_summary, local_summary);
+                    return;
+                }
+                global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+
+                for (unsigned int i = 0; i < num_replicas_; ++i) {
+                    if (metropolis_[i](candidate_costs_[i], replica_costs_[i])) {
+                        replicas_.col(i) = candidates_.col(i);
+                        replica_costs_[i] = candidate_costs_[i];
+                        if (replica_costs_[i] + global_minimum_state_.tolerance < global_minimum_state_.cost) {
+                            global_minimum_state_.cost = replica_costs_[i];
+                            global_minimum_state_.x = replicas_.col(i);
+                            found_new_minimum = true;
+                        }
+                    }
+                }
+            }
+
+            swap_replicas_();
+
+            ++num_iterations_;
+            if (found_new_minimum)
+                num_stagnant_iterations_ = 0;
+            else
+                ++num_stagnant_iterations_;
+
+            if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency == 0)
+                save_history_(options, global_summary);
+
+            if(check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
+                t1 = WallTimeInSeconds();
+
+                if (options.polish_output && !is_evaluation_budget_spent_(options) &&
+                    global_summary->termination_type != TerminationType::USER_FAILURE) {
+                    internal::MinimizeLocally(options.local_minimizer_type,
+                                              options.local_minimizer_options,
+                                              options.least_squares_minimizer_options,
+                                              problem,
+                                              options.step_function->lower_bounds(),
+                                              options.step_function->upper_bounds(),
+                                              global_minimum_state_.x.data(),
+                                              &local_summary);
+                    global_summary->was_polished = true;
+                }
+                global_summary->local_minimization_time_in_seconds = WallTimeInSeconds() - t1;
+
+                t1 = WallTimeInSeconds();
+                if (!evaluator_->Evaluate(global_minimum_state_.x.data(), &global_minimum_state_.cost)) {
+                    global_summary->termination_type = TerminationType::FAILURE;
+                    global_summary->message = "Cost evaluation of global mininum state failed after polishing step "
+                                                      "More details: Problem evaluation failed";
+                    LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
+                }
+                global_summary->cost_evaluation_time_in_seconds += WallTimeInSeconds() - t1;
+                prepare_final_summary_(global_summary, local_summary);
+                if (internal::IsSolutionUsable(global_summary) || internal::IsSolutionUsable(local_summary))
+                    x = global_minimum_state_.x;
+
+                if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency != 0)
+                    save_history_(options, global_summary);
+                global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
+                return;
+            }
+        }
+    };
+
+    void ParallelTempering::init_replicas_(const ParallelTempering::Options& options, uint64_t seed) {
+        if (options.temperatures.empty()) {
+            CHECK_GT(options.num_replicas, 0) << "Parallel tempering requires at least one replica.";
+            CHECK_GT(options.minimum_temperature, 0.0) << "Temperatures must be positive.";
+            CHECK_GE(options.maximum_temperature, options.minimum_temperature)
+                << "The maximum temperature must not be less than the minimum temperature.";
+
+            num_replicas_ = options.num_replicas;
+            temperatures_.resize(num_replicas_);
+            temperatures_[0] = options.minimum_temperature;
+            if (num_replicas_ > 1) {
+                const double ratio = std::pow(options.maximum_temperature / options.minimum_temperature,
+                                              1.0 / (num_replicas_ - 1));
+                for (unsigned int i = 1; i < num_replicas_; ++i)
+                    temperatures_[i] = temperatures_[i - 1] * ratio;
+                temperatures_[num_replicas_ - 1] = options.maximum_temperature;
+            }
+        } else {
+            num_replicas_ = static_cast<unsigned int>(options.temperatures.size());
+            temperatures_ = ConstVectorRef(options.temperatures.data(), num_replicas_);
+            CHECK_GT(temperatures_[0], 0.0) << "Temperatures must be positive.";
+            for (unsigned int i = 1; i < num_replicas_; ++i)
+                CHECK_GT(temperatures_[i], temperatures_[i - 1]) << "Temperatures must be strictly increasing.";
+        }
+
+        metropolis_.clear();
+        for (unsigned int i = 0; i < num_replicas_; ++i) {
+            metropolis_.push_back(internal::Metropolis(temperatures_[i]));
+            metropolis_.back().seed(seed, i);
+        }
+        swap_random_number_.seed(seed, internal::REPLICA_EXCHANGE_STREAM);
+    };
+
+    void ParallelTempering::swap_replicas_() {
+        for (unsigned int i = num_iterations_ % 2; i + 1 < num_replicas_; i += 2) {
+            const unsigned int j = i + 1;
+            const double delta = (1.0 / temperatures_[i] - 1.0 / temperatures_[j]) *
+                                 (replica_costs_[i] - replica_costs_[j]);
+            ++num_swap_attempts_;
+            if (std::min(1.0, std::exp(delta)) >= swap_random_number_()) {
+                replicas_.col(i).swap(replicas_.col(j));
+                std::swap(replica_costs_[i], replica_costs_[j]);
+                ++num_accepted_swaps_;
+            }
+        }
+    };
+
+    bool ParallelTempering::check_for_termination_(const ParallelTempering::Options& options,
+                                                   std::string *message,
+                                                   TerminationType * termination_type) {
+        if (!options.callbacks.empty() &&
+            internal::InvokeCallbacks(options.callbacks, iteration_summary_(), message, termination_type))
+            return true;
+
+        if (global_minimum_state_.cost < options.minimum_cost) {
+            *message = "Prescribed minimum cost reached.";
+            *termination_type = TerminationType::USER_SUCCESS;
+            return true;
+        } else if (num_iterations_ >= options.max_iterations) {
+            *message = "Maximum number of iterations reached.";
+            *termination_type = TerminationType::NO_CONVERGENCE;
+            return true;
+        } else if (is_evaluation_budget_spent_(options)) {
+            *message = "Maximum number of function or gradient evaluations reached.";
+            *termination_type = TerminationType::NO_CONVERGENCE;
+            return true;
+        } else if (num_stagnant_iterations_ >= options.max_stagnant_iterations) {
+            *message = "Maximum number of stagnant iterations reached.";
+            *termination_type = TerminationType::CONVERGENCE;
+            return true;
+        }
+        return false;
+    };
+
+    bool ParallelTempering::is_evaluation_budget_spent_(const ParallelTempering::Options& options) const {
+        return internal::IsEvaluationBudgetSpent(options.max_function_evaluations,
+                                                 options.max_gradient_evaluations,
+                                                 evaluator_->num_cost_evaluations(),
+                                                 evaluator_->num_gradient_evaluations());
+    };
+
+    IterationSummary ParallelTempering::iteration_summary_() const {
+        IterationSummary summary(PARALLEL_TEMPERING,
+                                 num_iterations_,
+                                 static_cast<int>(replicas_.rows()),
+                                 replica_costs_[0],
+                                 replicas_.col(0).data(),
+                                 global_minimum_state_.cost,
+                                 global_minimum_state_.x.data());
+        summary.num_stagnant_iterations = num_stagnant_iterations_;
+        summary.temperature = temperatures_[0];
+        summary.population_costs = &replica_costs_;
+        return summary;
+    };
+
+    void ParallelTempering::save_history_(const ParallelTempering::Options& options,
+                                          ParallelTempering::Summary* global_summary) const {
+        internal::SaveHistory(options.history_ring,
+                              options.history_sink,
+                              &global_summary->history,
+                              num_iterations_,
+                              num_stagnant_iterations_,
+                              replica_costs_,
+                              replicas_.col(0),
+                              global_minimum_state_.cost,
+                              global_minimum_state_.x);
+    };
+
+    void ParallelTempering::prepare_final_summary_(ParallelTempering::Summary *global_summary,
+                                                   const GradientLocalMinimizer::Summary &local_summary) {
+        global_summary->final_cost = global_minimum_state_.cost;
+        global_summary->num_iterations = num_iterations_;
+        global_summary->num_cost_evaluations = evaluator_->num_cost_evaluations();
+        global_summary->num_gradient_evaluations = evaluator_->num_gradient_evaluations();
+        global_summary->num_swap_attempts = num_swap_attempts_;
+        global_summary->num_accepted_swaps = num_accepted_swaps_;
+        // a local minimization that did not run reports negative counts
+        global_summary->num_local_cost_evaluations = std::max(0, local_summary.num_cost_evaluations);
+        global_summary->num_local_gradient_evaluations = std::max(0, local_summary.num_gradient_evaluations);
+        global_summary->local_minimization_summary = local_summary;
+    };
+
+    void Solve(const ParallelTempering::Options& options,
+               const GradientProblem& problem,
+               double* parameters,
+               ParallelTempering::Summary* summary) {
+        ParallelTempering solver;
+        solver.Solve(options, problem, parameters, summary);
+    }
+
+    void dump(const ParallelTempering::HistoryOutput &h, HistoryWriter& writer) {
+        writer.StartObject();
+        writer.String("iteration_number");
+        writer.Uint(h.iteration_number);
+
+        writer.String("stagnant_iterations");
+        writer.Uint(h.stagnant_iterations);
+
+        writer.String("replica_costs");
+        writer.StartArray();
+        for (auto i = 0; i < h.replica_costs.size(); ++i)  {
+            writer.Double(h.replica_costs[i]);
+        }
+        writer.EndArray();
+
+        writer.String("current_solution");
+        writer.StartArray();
+        for (auto i = 0; i < h.current_solution.size(); ++i)  {
+            writer.Double(h.current_solution[i]);
+        }
+        writer.EndArray();
+
+        writer.String("best_cost");
+        writer.Double(h.best_cost);
+
+        writer.String("best_solution");
+        writer.StartArray();
+        for (auto i = 0; i < h.best_solution.size(); ++i)  {
+            writer.Double(h.best_solution[i]);
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    void dump(const ParallelTempering::HistoryOutput &h, BinaryHistoryWriter& writer) {
+        writer.StartRecord(PARALLEL_TEMPERING,
+                           static_cast<unsigned int>(h.best_solution.size()),
+                           static_cast<unsigned int>(h.replica_costs.size()));
+        writer.Uint("iteration_number", h.iteration_number);
+        writer.Uint("stagnant_iterations", h.stagnant_iterations);
+        writer.Doubles("replica_costs", h.replica_costs.data(), h.replica_costs.size());
+        writer.Doubles("current_solution", h.current_solution.data(), h.current_solution.size());
+        writer.Double("best_cost", h.best_cost);
+        writer.Doubles("best_solution", h.best_solution.data(), h.best_solution.size());
+        writer.EndRecord();
+    }
+} // namespace pallas
@@ -24,7 +24,11 @@
 //
 // Author: ryan.latture@gmail.com (Ryan Latture)s
 
+#include <algorithm>
+
 #include "pallas/simulated_annealing.h"
+#include "pallas/binary_history.h"
+#include "pallas/internal/line_search_minimizer.h"
 #include "pallas/internal/solver_utils.h"
 #include "pallas/internal/stringprintf.h"
 #include "pallas/internal/wall_time.h"
@@ -41,13 +45,11 @@ namespace pallas {
 
     namespace {
 
-        bool Evaluate(const GradientProblem &problem,
-                      Vector &x,
+        bool Evaluate(internal::Evaluator* evaluator,
+                      const Vector &x,
                       internal::State *state,
                       std::string *message) {
-            if (!problem.Evaluate(x.data(),
-                                  &(state->cost),
-                                  state->gradient.data())) {
+            if (!evaluator->Evaluate(x.data(), &(state->cost))) {
                 *message = "Problem evaluation failed";
                 return false;
             }
@@ -62,7 +64,12 @@ namespace pallas {
               initial_cost(-1.0),
               final_cost(-1.0),
               num_parameters(0),
+              seed(-1),
               num_iterations(0),
+              num_cost_evaluations(0),
+              num_gradient_evaluations(0),
+              num_local_cost_evaluations(0),
+              num_local_gradient_evaluations(0),
               total_time_in_seconds(0.0),
               local_minimization_time_in_seconds(0.0),
               step_time_in_seconds(0.0),
@@ -95,6 +102,8 @@ namespace pallas {
         StringAppendF(&report, "Cooling schedule     %24s\n",
                       cooling_schedule_string.c_str());
 
+        StringAppendF(&report, "Seed                %25d\n", seed);
+
         StringAppendF(&report, "\nCost:\n");
         StringAppendF(&report, "  Initial        %28e\n", initial_cost);
         if (termination_type != TerminationType::FAILURE &&
@@ -107,6 +116,18 @@ namespace pallas {
         StringAppendF(&report, "\nMinimizer iterations         %16d\n",
                       num_iterations);
 
+        StringAppendF(&report, "\nEvaluations (outside local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_gradient_evaluations));
+
+        StringAppendF(&report, "\nEvaluations (in local minimization):\n");
+        StringAppendF(&report, "  Cost only      %28lld\n",
+                      static_cast<long long>(num_local_cost_evaluations));
+        StringAppendF(&report, "  Cost and gradient %25lld\n",
+                      static_cast<long long>(num_local_gradient_evaluations));
+
         StringAppendF(&report, "\nTime (in seconds):\n");
 
         StringAppendF(&report, "  Cost evaluation     %23.4f\n",
@@ -135,6 +156,9 @@ namespace pallas {
 
         double start_time = WallTimeInSeconds();
         double t1;
+
+        if (options.history_ring != NULL)
+            options.history_ring->Clear();
         unsigned int dwell_iter;
         num_iterations_ = 0;
         num_stagnant_iterations_ = 0;
@@ -146,17 +170,25 @@ namespace pallas {
         global_summary->cooling_schedule = options.cooling_schedule_options.type;
         global_summary->num_parameters = num_parameters;
 
+        const int seed = internal::ResolveSeed(options.seed);
+        global_summary->seed = seed;
+        options.step_function->Seed(seed, 0);
+        metropolis_.seed(seed);
+
         VectorRef x(parameters, num_parameters);
 
         current_state_ = internal::State(num_parameters);
         current_state_.x = x;
 
+        scoped_ptr<internal::Evaluator> tmp_evaluator(new internal::Evaluator(problem));
+        swap(evaluator_, tmp_evaluator);
+
         GradientLocalMinimizer::Summary local_summary;
 
         t1 = WallTimeInSeconds();
-        if (!Evaluate(problem, current_state_.x, &current_state_, &global_summary->message)) {
+        if (!Evaluate(evaluator_.get(), current_state_.x, &current_state_, &global_summary->message)) {
             global_summary->termination_type = TerminationType::FAILURE;
-            global_summary->message = "Initial cost and jacobian evaluation failed. "
+            global_summary->message = "Initial cost evaluation failed. "
                                               "More details: " + global_summary->message;
             LOG_IF(WARNING, is_not_silent) << "Terminating: " << global_summary->message;
             prepare_final_summary_(global_summary, local_summary);
@@ -173,14 +205,14 @@ namespace pallas {
         swap(cooling_schedule_, __cooling_schedule);
 
         if(cooling_schedule_->get_initial_temperature() < 0.0) {
-            cooling_schedule_->calc_start_temperature(problem, current_state_, options.step_function.get());
+            cooling_schedule_->calc_start_temperature(evaluator_.get(), current_state_, options.step_function.get());
         }
 
         candidate_state_ = current_state_;
         global_minimum_state_ = current_state_;
 
         if (options.history_save_frequency > 0)
-            global_summary->history.push_back(HistoryOutput(num_iterations_, num_stagnant_iterations_, cooling_schedule_->get_temperature(), current_state_.x, current_state_.cost, current_state_.x));
+            internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, num_stagnant_iterations_, cooling_schedule_->get_temperature(), current_state_.x, global_minimum_state_.cost, global_minimum_state_.x);
 
         if(check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
             prepare_final_summary_(global_summary, local_summary);
@@ -197,7 +229,7 @@ namespace pallas {
                 global_summary->step_time_in_seconds += WallTimeInSeconds() - t1;
 
                 t1 = WallTimeInSeconds();
-                if (!Evaluate(problem, candidate_state_.x, &candidate_state_, &global_summary->message)) {
+                if (!Evaluate(evaluator_.get(), candidate_state_.x, &candidate_state_, &global_summary->message)) {
                     global_summary->termination_type = TerminationType::FAILURE;
                     global_summary->message = "Cost evaluation of candidate state failed "
                                                       "More details: " + global_summary->message;
@@ -221,23 +253,27 @@ namespace pallas {
             cooling_schedule_->update_temperature();
 
             if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency == 0)
-                global_summary->history.push_back(HistoryOutput(num_iterations_, num_stagnant_iterations_, cooling_schedule_->get_temperature(), current_state_.x, current_state_.cost, current_state_.x));
+                internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, num_stagnant_iterations_, cooling_schedule_->get_temperature(), current_state_.x, global_minimum_state_.cost, global_minimum_state_.x);
 
             if(check_for_termination_(options, &global_summary->message, &global_summary->termination_type)) {
                 t1 = WallTimeInSeconds();
 
-                if (options.polish_output) {
-                    GradientLocalMinimizer local_minimizer;
-                    local_minimizer.Solve(options.local_minimizer_options,
-                                          problem,
-                                          global_minimum_state_.x.data(),
-                                          &local_summary);
+                if (options.polish_output && !is_evaluation_budget_spent_(options) &&
+                    global_summary->termination_type != TerminationType::USER_FAILURE) {
+                    internal::MinimizeLocally(options.local_minimizer_type,
+                                              options.local_minimizer_options,
+                                              options.least_squares_minimizer_options,
+                                              problem,
+                                              options.step_function->lower_bounds(),
+                                              options.step_function->upper_bounds(),
+                                              global_minimum_state_.x.data(),
+                                              &local_summary);
                     global_summary->was_polished = true;
                 }
                 global_summary->local_minimization_time_in_seconds = WallTimeInSeconds() - t1;
 
                 t1 = WallTimeInSeconds();
-                if (!Evaluate(problem, global_minimum_state_.x, &global_minimum_state_, &global_summary->message)) {
+                if (!Evaluate(evaluator_.get(), global_minimum_state_.x, &global_minimum_state_, &global_summary->message)) {
                     global_summary->termination_type = TerminationType::FAILURE;
                     global_summary->message = "Cost evaluation of global mininum state failed after polishing step "
                                                       "More details: " + global_summary->message;
@@ -249,7 +285,7 @@ namespace pallas {
                     x = global_minimum_state_.x;
 
                 if (options.history_save_frequency > 0 && num_iterations_ % options.history_save_frequency != 0)
-                    global_summary->history.push_back(HistoryOutput(num_iterations_, num_stagnant_iterations_, cooling_schedule_->get_temperature(), current_state_.x, current_state_.cost, current_state_.x));
+                    internal::SaveHistory(options.history_ring, options.history_sink, &global_summary->history, num_iterations_, num_stagnant_iterations_, cooling_schedule_->get_temperature(), current_state_.x, global_minimum_state_.cost, global_minimum_state_.x);
                 global_summary->total_time_in_seconds = WallTimeInSeconds() - start_time;
                 return;
             }
@@ -259,6 +295,9 @@ namespace pallas {
     bool SimulatedAnnealing::check_for_termination_(const SimulatedAnnealing::Options& options,
                                 std::string *message,
                                 TerminationType * termination_type) {
+        if (!options.callbacks.empty() &&
+            internal::InvokeCallbacks(options.callbacks, iteration_summary_(), message, termination_type))
+            return true;
 
         if (global_minimum_state_.cost < options.minimum_cost) {
             *message = "Prescribed minimum cost reached.";
@@ -268,6 +307,10 @@ namespace pallas {
             *message = "Maximum number of iterations reached.";
             *termination_type = TerminationType::NO_CONVERGENCE;
             return true;
+        } else if (is_evaluation_budget_spent_(options)) {
+            *message = "Maximum number of function or gradient evaluations reached.";
+            *termination_type = TerminationType::NO_CONVERGENCE;
+            return true;
         } else if (num_stagnant_iterations_ >= options.max_stagnant_iterations) {
             *message = "Maximum number of stagnant iterations reached.";
             *termination_type = TerminationType::CONVERGENCE;
@@ -285,10 +328,35 @@ namespace pallas {
         return false;
     };
 
+    bool SimulatedAnnealing::is_evaluation_budget_spent_(const SimulatedAnnealing::Options& options) const {
+        return internal::IsEvaluationBudgetSpent(options.max_function_evaluations,
+                                                 options.max_gradient_evaluations,
+                                                 evaluator_->num_cost_evaluations(),
+                                                 evaluator_->num_gradient_evaluations());
+    };
+
+    IterationSummary SimulatedAnnealing::iteration_summary_() const {
+        IterationSummary summary(SIMULATED_ANNEALING,
+                                 num_iterations_,
+                                 static_cast<int>(current_state_.x.size()),
+                                 current_state_.cost,
+                                 current_state_.x.data(),
+                                 global_minimum_state_.cost,
+                                 global_minimum_state_.x.data());
+        summary.num_stagnant_iterations = num_stagnant_iterations_;
+        summary.temperature = cooling_schedule_->get_temperature();
+        return summary;
+    };
+
     void SimulatedAnnealing::prepare_final_summary_(SimulatedAnnealing::Summary *global_summary,
                                 const GradientLocalMinimizer::Summary &local_summary) {
         global_summary->final_cost = global_minimum_state_.cost;
         global_summary->num_iterations = num_iterations_;
+        global_summary->num_cost_evaluations = evaluator_->num_cost_evaluations();
+        global_summary->num_gradient_evaluations = evaluator_->num_gradient_evaluations();
+        // a local minimization that did not run reports negative counts
+        global_summary->num_local_cost_evaluations = std::max(0, local_summary.num_cost_evaluations);
+        global_summary->num_local_gradient_evaluations = std::max(0, local_summary.num_gradient_evaluations);
         global_summary->local_minimization_summary = local_summary;
     };
 
@@ -329,4 +397,17 @@ namespace pallas {
         writer.EndArray();
         writer.EndObject();
     }
+
+    void dump(const SimulatedAnnealing::HistoryOutput &h, BinaryHistoryWriter& writer) {
+        writer.StartRecord(SIMULATED_ANNEALING,
+                           static_cast<unsigned int>(h.best_solution.size()),
+                           1);
+        writer.Uint("iteration_number", h.iteration_number);
+        writer.Uint("stagnant_iterations", h.stagnant_iterations);
+        writer.Double("temperature", h.temperature);
+        writer.Doubles("current_solution", h.current_solution.data(), h.current_solution.size());
+        writer.Double("best_cost", h.best_cost);
+        writer.Doubles("best_solution", h.best_solution.data(), h.best_solution.size());
+        writer.EndRecord();
+    }
 } // namespace pallas
@@ -29,21 +29,28 @@
 namespace pallas {
 
     DefaultStepFunction::DefaultStepFunction(double step_size) :
-            random_number_(new internal::RandomNumberGenerator<double>(-step_size, step_size)) {
+            random_number_(-step_size, step_size) {
 
     };
 
     void DefaultStepFunction::Step(double* x, unsigned int num_parameters) {
-        for(unsigned int i =0; i < num_parameters; ++i) {
-            x[i] += (*random_number_)();
-        }
+        if (steps_.size() != num_parameters)
+            steps_.resize(num_parameters);
+
+        random_number_.Fill(steps_.data(), num_parameters);
+        VectorRef(x, num_parameters) += steps_;
+    };
+
+    void DefaultStepFunction::Seed(uint64_t seed, unsigned int thread_id) {
+        random_number_.seed(seed, internal::STEP_FUNCTION_STREAM, thread_id);
     };
 
     BoundedStepFunction::BoundedStepFunction(double step_size,
                                              const double *upper_bounds,
                                              const double *lower_bounds,
                                              unsigned int num_parameters)
-            : random_number_(new internal::RandomNumberGenerator<double>(-step_size, step_size)) {
+            : random_number_(-step_size, step_size),
+              steps_(num_parameters) {
         ConstVectorRef upper_ref(upper_bounds, num_parameters);
         ConstVectorRef lower_ref(lower_bounds, num_parameters);
 
@@ -52,10 +59,14 @@ namespace pallas {
     };
 
     void BoundedStepFunction::Step(double *x, unsigned int num_parameters) {
+        if (steps_.size() != num_parameters)
+            steps_.resize(num_parameters);
+
+        random_number_.Fill(steps_.data(), num_parameters);
 
         double candidate_x;
         for(unsigned int i =0; i < num_parameters; ++i) {
-            candidate_x = x[i] + (*random_number_)();
+            candidate_x = x[i] + steps_[i];
 
             if (candidate_x > upper_bounds_(i))
                 x[i] = 2.0 * upper_bounds_(i) - candidate_x;
@@ -66,4 +77,16 @@ namespace pallas {
         }
     };
 
+    void BoundedStepFunction::Seed(uint64_t seed, unsigned int thread_id) {
+        random_number_.seed(seed, internal::STEP_FUNCTION_STREAM, thread_id);
+    };
+
+    const double* BoundedStepFunction::upper_bounds() const {
+        return upper_bounds_.data();
+    };
+
+    const double* BoundedStepFunction::lower_bounds() const {
+        return lower_bounds_.data();
+    };
+
 } // namespace pallas
@@ -0,0 +1,122 @@
+// Pallas Solver
+// Copyright 2015. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: ryan.latture@gmail.com (Ryan Latture)
+
+// Measures the time spent producing differential evolution trial candidates
+// (everything except the cost evaluation) for every mutation and crossover
+// pair, comparing the separate MutationStrategy + CrossoverStrategy path
+// against the fused kernels of TrialGenerator.
+//
+// Usage: trial_generator_benchmark [num_parameters] [population_size] [num_generations]
+
+#include <cstdio>
+#include <cstdlib>
+#include "pallas/types.h"
+#include "pallas/scoped_ptr.h"
+#include "pallas/internal/crossover_strategy.h"
+#include "pallas/internal/mutation_strategy.h"
+#include "pallas/internal/index_sampler.h"
+#include "pallas/internal/trial_generator.h"
+#include "pallas/internal/wall_time.h"
+
+namespace pallas {
+    namespace internal {
+
+        void RunBenchmark(unsigned int num_parameters,
+                          unsigned int population_size,
+                          unsigned int num_generations) {
+            const double scale = 0.7;
+            const double crossover_probability = 0.7;
+            const unsigned int max_num_samples = 5;
+
+            Matrix population = (Matrix::Random(num_parameters, population_size).array() + 1.0) * 0.5;
+            Matrix trials(num_parameters, population_size);
+            Vector bprime(num_parameters);
+
+            // the samples are drawn once up front so only trial generation is timed
+            Eigen::MatrixXi samples(max_num_samples, population_size);
+            IndexSampler index_sampler(population_size);
+            for (unsigned int i = 0; i < population_size; ++i) {
+                index_sampler.Sample(i, max_num_samples, samples.col(i).data());
+            }
+
+            const MutationStrategyType mutation_strategies[] = {BEST_1, RAND_1, RAND_TO_BEST_1, BEST_2, RAND_2};
+            const CrossoverStrategyType crossover_strategies[] = {BINOMIAL, EXPONENTIAL};
+            const double num_trials = static_cast<double>(population_size) * num_generations;
+
+            std::printf("num_parameters: %u, population_size: %u, num_generations: %u\n\n",
+                        num_parameters, population_size, num_generations);
+            std::printf("%-16s %-12s %18s %18s %9s\n",
+                        "Mutation", "Crossover", "Separate (ns/trial)", "Fused (ns/trial)", "Speedup");
+
+            for (auto mutation_strategy : mutation_strategies) {
+                for (auto crossover_strategy : crossover_strategies) {
+                    scoped_ptr<MutationStrategy> mutation(MutationStrategy::Create(mutation_strategy));
+                    scoped_ptr<CrossoverStrategy> crossover(CrossoverStrategy::Create(crossover_strategy,
+                                                                                      crossover_probability,
+                                                                                      num_parameters));
+                    double t1 = WallTimeInSeconds();
+                    for (unsigned int g = 0; g < num_generations; ++g) {
+                        for (unsigned int i = 0; i < population_size; ++i) {
+                            trials.col(i) = population.col(i);
+                            mutation->get_bprime(population, i, samples.col(i).data(), scale, bprime);
+                            crossover->Crossover(trials.col(i), bprime);
+                        }
+                    }
+                    const double separate_time = WallTimeInSeconds() - t1;
+
+                    scoped_ptr<TrialGenerator> trial_generator(TrialGenerator::Create(mutation_strategy,
+                                                                                      crossover_strategy,
+                                                                                      crossover_probability,
+                                                                                      num_parameters));
+                    t1 = WallTimeInSeconds();
+                    for (unsigned int g = 0; g < num_generations; ++g) {
+                        for (unsigned int i = 0; i < population_size; ++i) {
+                            trial_generator->Generate(population, i, samples.col(i).data(), scale, trials.col(i).data());
+                        }
+                    }
+                    const double fused_time = WallTimeInSeconds() - t1;
+
+                    std::printf("%-16s %-12s %18.1f %18.1f %8.2fx\n",
+                                MutationStrategyTypeToString(mutation_strategy),
+                                CrossoverStrategyTypeToString(crossover_strategy),
+                                1e9 * separate_time / num_trials,
+                                1e9 * fused_time / num_trials,
+                                separate_time / fused_time);
+                }
+            }
+        }
+
+    } // namespace internal
+} // namespace pallas
+
+int main(int argc, char** argv) {
+    const unsigned int num_parameters = argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : 500;
+    const unsigned int population_size = argc > 2 ? static_cast<unsigned int>(std::atoi(argv[2])) : 200;
+    const unsigned int num_generations = argc > 3 ? static_cast<unsigned int>(std::atoi(argv[3])) : 100;
+
+    pallas::internal::RunBenchmark(num_parameters, population_size, num_generations);
+    return 0;
+}
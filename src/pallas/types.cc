@@ -39,6 +39,28 @@ namespace pallas {
         std::transform(input->begin(), input->end(), input->begin(), ::toupper);
     }
 
+    const char* SolverTypeToString(SolverType type) {
+        switch (type) {
+            CASESTR(BASINHOPPING);
+            CASESTR(BRUTE);
+            CASESTR(DIFFERENTIAL_EVOLUTION);
+            CASESTR(PARALLEL_TEMPERING);
+            CASESTR(SIMULATED_ANNEALING);
+            default:
+                return "UNKNOWN";
+        }
+    }
+
+    bool StringToSolverType(std::string value, SolverType* type) {
+        UpperCase(&value);
+        STRENUM(BASINHOPPING);
+        STRENUM(BRUTE);
+        STRENUM(DIFFERENTIAL_EVOLUTION);
+        STRENUM(PARALLEL_TEMPERING);
+        STRENUM(SIMULATED_ANNEALING);
+        return false;
+    }
+
     const char* CoolingScheduleTypeToString(CoolingScheduleType type) {
         switch (type) {
             CASESTR(BOLTZMANN);
@@ -111,4 +133,54 @@ namespace pallas {
         return false;
     }
 
+    const char* PopulationUpdateTypeToString(PopulationUpdateType type) {
+        switch (type) {
+            CASESTR(IMMEDIATE);
+            CASESTR(DEFERRED);
+            CASESTR(ASYNCHRONOUS);
+            default:
+                return "UNKNOWN";
+        }
+    }
+
+    bool StringToPopulationUpdateType(std::string value, PopulationUpdateType* type) {
+        UpperCase(&value);
+        STRENUM(IMMEDIATE);
+        STRENUM(DEFERRED);
+        STRENUM(ASYNCHRONOUS);
+        return false;
+    }
+
+    const char* MigrationTopologyTypeToString(MigrationTopologyType type) {
+        switch (type) {
+            CASESTR(RING_TOPOLOGY);
+            CASESTR(RANDOM_TOPOLOGY);
+            default:
+                return "UNKNOWN";
+        }
+    }
+
+    bool StringToMigrationTopologyType(std::string value, MigrationTopologyType* type) {
+        UpperCase(&value);
+        STRENUM(RING_TOPOLOGY);
+        STRENUM(RANDOM_TOPOLOGY);
+        return false;
+    }
+
+    const char* LocalMinimizerTypeToString(LocalMinimizerType type) {
+        switch (type) {
+            CASESTR(CERES_LOCAL_MINIMIZER);
+            CASESTR(PALLAS_LOCAL_MINIMIZER);
+            default:
+                return "UNKNOWN";
+        }
+    }
+
+    bool StringToLocalMinimizerType(std::string value, LocalMinimizerType* type) {
+        UpperCase(&value);
+        STRENUM(CERES_LOCAL_MINIMIZER);
+        STRENUM(PALLAS_LOCAL_MINIMIZER);
+        return false;
+    }
+
 } // namespace pallas